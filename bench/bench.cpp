@@ -0,0 +1,89 @@
+#include "bench.hpp"
+
+#include <fmt/core.h>
+#include <fmt/ostream.h>
+
+#include <chrono>
+#include <ostream>
+
+namespace Bench {
+
+namespace {
+
+/// Quote @p s as a JSON string. Benchmark names and context values are
+/// plain ASCII, so only quotes, backslashes and control characters need
+/// escaping.
+std::string json_string(std::string const& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out += fmt::format("\\u{:04x}", static_cast<int>(c));
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+    return out;
+}
+
+} // namespace
+
+void Suite::run(std::string const& name,
+                std::string const& unit,
+                std::function<double()> const& body,
+                size_t max_iterations) {
+    if (!selected(name)) {
+        return;
+    }
+
+    using clock = std::chrono::steady_clock;
+    Result result{name, unit, 0, 0.0, 0.0};
+    clock::duration elapsed{};
+    auto const budget = std::chrono::duration<double>(min_seconds_);
+
+    while (elapsed < budget &&
+           (max_iterations == 0 || result.iterations < max_iterations)) {
+        auto const start = clock::now();
+        result.items += body();
+        elapsed += clock::now() - start;
+        ++result.iterations;
+    }
+    result.seconds = std::chrono::duration<double>(elapsed).count();
+
+    fmt::print("{:<28} {:>12.1f} ns/{:<10} {:>14.1f} {}/s {:>8} iterations\n",
+               name, result.ns_per_item(), unit, result.items_per_second(),
+               unit, result.iterations);
+    results_.push_back(std::move(result));
+}
+
+bool Suite::selected(std::string const& name) const {
+    return filter_.empty() || name.find(filter_) != std::string::npos;
+}
+
+void Suite::write_json(std::ostream& os) const {
+    os << "{\n  \"context\": {";
+    auto sep = "";
+    for (auto const& [key, value] : context_) {
+        fmt::print(os, "{}\n    {}: {}", sep, json_string(key),
+                   json_string(value));
+        sep = ",";
+    }
+    os << "\n  },\n  \"benchmarks\": [";
+    sep = "";
+    for (auto const& r : results_) {
+        fmt::print(os,
+                   "{}\n    {{\"name\": {}, \"unit\": {}, \"iterations\": {}, "
+                   "\"seconds\": {}, \"items\": {}, \"ns_per_item\": {}, "
+                   "\"items_per_second\": {}}}",
+                   sep, json_string(r.name), json_string(r.unit),
+                   r.iterations, r.seconds, r.items, r.ns_per_item(),
+                   r.items_per_second());
+        sep = ",";
+    }
+    os << "\n  ]\n}\n";
+}
+
+} // namespace Bench
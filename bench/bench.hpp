@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/// Minimal benchmark harness for `bench_md2v`.
+///
+/// Each benchmark is a callable that does one unit of work and returns how
+/// many items (vertices, megapixels, entries...) it processed. The harness
+/// calls it until a minimum time has passed and reports time per item, so
+/// results stay comparable when the synthetic inputs change size.
+namespace Bench {
+
+/// Timing of one benchmark.
+struct Result {
+    std::string name;  ///< e.g. "md2/update".
+    std::string unit;  ///< What one item is, e.g. "vertex".
+    size_t iterations; ///< Calls to the benchmark body.
+    double seconds;    ///< Total time spent in those calls.
+    double items;      ///< Items processed by all calls.
+
+    [[nodiscard]] double ns_per_item() const {
+        return seconds * 1e9 / items;
+    }
+    [[nodiscard]] double items_per_second() const { return items / seconds; }
+};
+
+/// Keep @p value alive so the compiler cannot drop the work producing it.
+template <typename T> void keep(T const& value) {
+#if defined(_MSC_VER)
+    // no inline asm on x64 MSVC: publishing the address through a volatile
+    // keeps the value, and the barrier keeps the work from moving past it
+    static void const* volatile sink{};
+    sink = &value;
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "g"(&value) : "memory");
+#endif
+}
+
+/// Runs benchmarks and collects their results.
+class Suite {
+public:
+    /// @param min_seconds Minimum time to spend in each benchmark.
+    /// @param filter      Only run benchmarks whose name contains this.
+    Suite(double min_seconds, std::string filter)
+        : min_seconds_(min_seconds)
+        , filter_(std::move(filter)) {}
+
+    /// Time @p body, which returns the number of items it processed.
+    ///
+    /// @p max_iterations caps the number of calls, for bodies that consume
+    /// a finite input such as a list of not yet cached models. A result
+    /// line is printed as soon as the benchmark finishes.
+    void run(std::string const& name,
+             std::string const& unit,
+             std::function<double()> const& body,
+             size_t max_iterations = 0);
+
+    /// True if `run()` would run a benchmark called @p name; lets callers
+    /// skip setup that only one benchmark needs.
+    [[nodiscard]] bool selected(std::string const& name) const;
+
+    /// Record a fact about the run (CPU, kernel...) in the JSON output.
+    void add_context(std::string key, std::string value) {
+        context_.emplace_back(std::move(key), std::move(value));
+    }
+
+    [[nodiscard]] std::vector<Result> const& results() const {
+        return results_;
+    }
+
+    /// Write every result as a JSON document for comparing runs.
+    void write_json(std::ostream& os) const;
+
+private:
+    double min_seconds_;
+    std::string filter_;
+    std::vector<std::pair<std::string, std::string>> context_;
+    std::vector<Result> results_;
+};
+
+} // namespace Bench
@@ -0,0 +1,355 @@
+// Micro and macro benchmarks for the load and animation paths.
+//
+// Usage: bench_md2v [--json out.json] [--filter name] [--seconds s]
+//
+// Results are printed as they finish and optionally written as JSON; see
+// scripts/bench_compare.py for comparing two JSON runs.
+#include "bench.hpp"
+#include "synthetic.hpp"
+#include "tmpdir.hpp"
+
+#include "md2view/mapped_file.hpp"
+#include "md2view/md2_instance.hpp"
+#include "md2view/md2_model.hpp"
+#include "md2view/model_cache.hpp"
+#include "md2view/pak.hpp"
+#include "md2view/pcx.hpp"
+#include "md2view/resource_manager.hpp"
+#include "md2view/simd_lerp.hpp"
+#include "md2view/span_stream.hpp"
+#include "md2view/vertex_cache.hpp"
+#include "md2view/vfs.hpp"
+
+#include <boost/program_options.hpp>
+#include <fmt/core.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr float frame_time = 1.0f / 60.0f;
+constexpr size_t pak_entries = 16384;
+constexpr size_t tree_dirs = 512;
+constexpr size_t tree_files_per_dir = 16;
+constexpr int pcx_size = 1024;
+
+void bench_pak(Bench::Suite& suite,
+               std::filesystem::path const& pak_path,
+               size_t entries) {
+    suite.run("pak/construct", "entry", [&] {
+        PAK const pak{pak_path};
+        Bench::keep(pak);
+        return static_cast<double>(entries);
+    });
+
+    PAK const pak{pak_path};
+    size_t next = 0;
+    suite.run("pak/view", "entry", [&] {
+        auto const bytes = pak.view(Synthetic::pak_entry_name(next));
+        Bench::keep(bytes);
+        next = (next + 1) % entries;
+        return 1.0;
+    });
+    suite.run("pak/find", "entry", [&] {
+        auto const node = pak.find(Synthetic::pak_entry_name(next));
+        Bench::keep(node);
+        next = (next + 1) % entries;
+        return 1.0;
+    });
+    suite.run("pak/models", "entry", [&] {
+        size_t models = 0;
+        for (auto const& node : pak.models()) {
+            Bench::keep(node);
+            ++models;
+        }
+        return static_cast<double>(models);
+    });
+}
+
+void bench_pak_directory(Bench::Suite& suite,
+                         std::filesystem::path const& tmp) {
+    if (!suite.selected("pak/index_directory") &&
+        !suite.selected("pak/index_cached")) {
+        return;
+    }
+    auto const root = tmp / "tree";
+    auto const cache = tmp / "pak_index";
+    Synthetic::directory(root, tree_dirs, tree_files_per_dir);
+    auto const entries = static_cast<double>(tree_dirs * tree_files_per_dir);
+
+    suite.run("pak/index_directory", "entry", [&] {
+        PAK const pak{root};
+        Bench::keep(pak);
+        return entries;
+    });
+
+    // the same tree with its index saved by the first construction
+    PAK const saved{root, cache};
+    Bench::keep(saved);
+    suite.run("pak/index_cached", "entry", [&] {
+        PAK const pak{root, cache};
+        Bench::keep(pak);
+        return entries;
+    });
+}
+
+void bench_md2(Bench::Suite& suite, std::span<std::byte const> bytes) {
+    suite.run("md2/construct", "model", [&] {
+        MD2Model const model{bytes};
+        Bench::keep(model);
+        return 1.0;
+    });
+    suite.run("md2/construct_indexed", "model", [&] {
+        MD2Model const model{bytes, MD2Model::Layout::indexed};
+        Bench::keep(model);
+        return 1.0;
+    });
+
+    // the same model as md2/construct_indexed, loaded back from its .md2c
+    // image rather than parsed
+    std::ostringstream baked_stream;
+    MD2Model{bytes, MD2Model::Layout::indexed}.write_baked(baked_stream, 0);
+    auto const baked = baked_stream.str();
+    auto const baked_bytes = std::as_bytes(std::span{baked});
+    suite.run("md2/load_baked", "model", [&] {
+        MD2Model const model{MD2Model::Baked{}, baked_bytes};
+        Bench::keep(model);
+        return 1.0;
+    });
+
+    for (auto const storage :
+         {MD2Model::Storage::unpacked, MD2Model::Storage::compact}) {
+        auto const name = storage == MD2Model::Storage::unpacked
+                              ? "md2/update"
+                              : "md2/update_compact";
+        if (!suite.selected(name)) {
+            continue;
+        }
+        auto const model = std::make_shared<MD2Model const>(
+            bytes, MD2Model::Layout::triangle_list, storage);
+        MD2Instance instance{model};
+        auto const vertices = static_cast<double>(model->vertex_count());
+        suite.run(name, "vertex", [&] {
+            instance.update(frame_time);
+            Bench::keep(instance.interpolated_vertices());
+            return vertices;
+        });
+    }
+
+    // the vertex cache pass on the model's triangles in a shuffled order,
+    // standing in for a model whose triangles were written in no useful order
+    if (suite.selected("md2/optimize_vertex_cache")) {
+        MD2Model const indexed{bytes, MD2Model::Layout::indexed};
+        auto const vertex_count = indexed.vertex_count();
+        std::vector<std::array<uint16_t, 3>> triangles;
+        for (size_t i = 0; i < indexed.indices().size(); i += 3) {
+            triangles.push_back({indexed.indices()[i], indexed.indices()[i + 1],
+                                 indexed.indices()[i + 2]});
+        }
+        std::ranges::shuffle(triangles, std::mt19937{42});
+        std::vector<uint16_t> shuffled;
+        for (auto const& tri : triangles) {
+            shuffled.insert(shuffled.end(), tri.begin(), tri.end());
+        }
+
+        auto optimized = shuffled;
+        VertexCache::optimize_triangles(optimized, vertex_count);
+        auto const before = VertexCache::analyze(shuffled, vertex_count);
+        auto const after = VertexCache::analyze(optimized, vertex_count);
+        suite.add_context("vertex cache acmr",
+                          fmt::format("{:.3f} -> {:.3f}", before.acmr,
+                                      after.acmr));
+        suite.add_context("vertex cache atvr",
+                          fmt::format("{:.3f} -> {:.3f}", before.atvr,
+                                      after.atvr));
+
+        auto const triangle_count = static_cast<double>(triangles.size());
+        suite.run("md2/optimize_vertex_cache", "triangle", [&] {
+            optimized = shuffled;
+            VertexCache::optimize_triangles(optimized, vertex_count);
+            Bench::keep(optimized);
+            return triangle_count;
+        });
+    }
+
+    // the cpu side of a frame for each layout: blend every output vertex and
+    // copy it into a stand-in for the mapped vertex buffer. the layouts differ
+    // only in how many output vertices the same triangles need
+    static constexpr std::array layouts = {
+        std::pair{MD2Model::Layout::triangle_list, "md2/frame_triangle_list"},
+        std::pair{MD2Model::Layout::indexed, "md2/frame_indexed"},
+        std::pair{MD2Model::Layout::gl_commands, "md2/frame_gl_commands"},
+    };
+    for (auto const& [layout, name] : layouts) {
+        if (!suite.selected(name)) {
+            continue;
+        }
+        auto const model = std::make_shared<MD2Model const>(bytes, layout);
+        MD2Instance instance{model};
+        std::vector<glm::vec3> upload(model->vertex_count());
+        suite.add_context(std::string{name} + " vertices",
+                          std::to_string(model->vertex_count()));
+        suite.run(name, "frame", [&] {
+            instance.update(frame_time);
+            std::ranges::copy(instance.interpolated_vertices(),
+                              upload.begin());
+            Bench::keep(upload);
+            return 1.0;
+        });
+    }
+}
+
+// a warm ModelCache::load(): everything a cache hit costs, from checking the
+// source is unchanged to building the model from its .md2c, for a model in
+// an archive and for a loose file
+void bench_model_cache(Bench::Suite& suite,
+                       std::filesystem::path const& root,
+                       std::filesystem::path const& pak_path,
+                       std::span<std::byte const> bytes) {
+    auto const loose = root / "loose";
+    auto const entry = std::string{"models/bench/tris.md2"};
+    std::filesystem::create_directories(loose / "models" / "bench");
+    {
+        std::ofstream out{loose / entry, std::ios::binary};
+        out.write(reinterpret_cast<char const*>(bytes.data()),
+                  static_cast<std::streamsize>(bytes.size()));
+    }
+
+    ModelCache const cache{root / "md2c"};
+    auto const layout = MD2Model::Layout::indexed;
+    auto const storage = MD2Model::Storage::unpacked;
+    static constexpr std::array sources = {
+        std::pair{false, "model_cache/hit"},
+        std::pair{true, "model_cache/hit_loose"},
+    };
+    for (auto const& [is_loose, name] : sources) {
+        if (!suite.selected(name)) {
+            continue;
+        }
+        VFS const vfs{{is_loose ? loose : pak_path}};
+        auto const path = is_loose ? entry : Synthetic::pak_entry_name(0);
+        cache.bake(vfs, path, layout, storage);
+        suite.run(name, "model", [&] {
+            Bench::keep(cache.load(vfs, path, layout, storage));
+            return 1.0;
+        });
+    }
+}
+
+void bench_pcx(Bench::Suite& suite) {
+    auto const image = Synthetic::pcx(pcx_size, pcx_size);
+    auto const megapixels = pcx_size * pcx_size / 1e6;
+    suite.run("pcx/decode", "megapixel", [&] {
+        PCX const pcx{image};
+        Bench::keep(pcx.image());
+        return megapixels;
+    });
+    suite.run("pcx/decode_stream", "megapixel", [&] {
+        SpanStream stream{image};
+        PCX const pcx{stream};
+        Bench::keep(pcx.image());
+        return megapixels;
+    });
+}
+
+void bench_resource_manager(Bench::Suite& suite,
+                            std::filesystem::path const& root,
+                            std::filesystem::path const& pak_path,
+                            size_t entries) {
+    ResourceManager cold{root, {pak_path}};
+    size_t next = 0;
+    // every call parses a model that is not cached yet, so the run stops
+    // once each entry has been loaded
+    suite.run(
+        "resource_manager/load_cold", "model",
+        [&] {
+            Bench::keep(cold.load_model(Synthetic::pak_entry_name(next++)));
+            return 1.0;
+        },
+        entries);
+
+    ResourceManager warm{root, {pak_path}};
+    auto const path = Synthetic::pak_entry_name(0);
+    Bench::keep(warm.load_model(path));
+    suite.run("resource_manager/load_warm", "model", [&] {
+        Bench::keep(warm.load_model(path));
+        return 1.0;
+    });
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) try {
+    namespace po = boost::program_options;
+
+    std::string json_path;
+    std::string filter;
+    std::string model_path =
+        std::string{MD2V_BENCH_FIXTURE_DIR} + "/bench.md2";
+    double seconds = 0.5;
+
+    po::options_description options("Benchmark options");
+    options.add_options()("help,h", "Show help")(
+        "json", po::value<std::string>(&json_path), "Write results as JSON")(
+        "filter", po::value<std::string>(&filter),
+        "Only run benchmarks whose name contains this")(
+        "model", po::value<std::string>(&model_path), "MD2 file to use")(
+        "seconds", po::value<double>(&seconds), "Minimum time per benchmark");
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, options), vm);
+    po::notify(vm);
+    if (vm.count("help") != 0U) {
+        std::cout << options << '\n';
+        return 0;
+    }
+
+    // the loaders log at info level on every call
+    spdlog::set_level(spdlog::level::warn);
+
+    MappedFile const model_file{model_path};
+    TmpDir const tmp{"md2v_bench"};
+    auto const pak_path = tmp.path() / "bench.pak";
+    Synthetic::pak(pak_path, model_file.bytes(), pak_entries);
+
+    Bench::Suite suite{seconds, filter};
+    suite.add_context("model", model_path);
+    suite.add_context("threads",
+                      std::to_string(std::thread::hardware_concurrency()));
+    suite.add_context("lerp_kernel", SIMD::name(SIMD::best_kernel()));
+
+    bench_pak(suite, pak_path, pak_entries);
+    bench_pak_directory(suite, tmp.path());
+    bench_md2(suite, model_file.bytes());
+    bench_model_cache(suite, tmp.path(), pak_path, model_file.bytes());
+    bench_pcx(suite);
+    bench_resource_manager(suite, tmp.path(), pak_path, pak_entries);
+
+    if (!json_path.empty()) {
+        std::ofstream json{json_path};
+        if (!json) {
+            throw std::runtime_error("failed to create " + json_path);
+        }
+        suite.write_json(json);
+    }
+    return 0;
+} catch (std::exception const& e) {
+    fmt::print(stderr, "bench_md2v: {}\n", e.what());
+    return 1;
+}
@@ -0,0 +1,120 @@
+// Thread scaling of update_all(): how many MD2 instances per millisecond
+// can be animated with 1..N threads.
+//
+// Usage: bench_update_all [--model file.md2] [--instances n]
+//                         [--threads n] [--seconds s]
+#include "md2view/mapped_file.hpp"
+#include "md2view/md2_instance.hpp"
+#include "md2view/md2_model.hpp"
+#include "md2view/thread_pool.hpp"
+
+#include <boost/program_options.hpp>
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr float frame_time = 1.0f / 60.0f;
+
+/// `count` instances of @p model at staggered speeds and frames, so chunks do
+/// not all hit the same keyframe pair.
+std::vector<MD2Instance> make_instances(
+    std::shared_ptr<MD2Model const> const& model,
+    size_t count) {
+    std::vector<MD2Instance> instances;
+    instances.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        auto& instance = instances.emplace_back(model);
+        instance.set_frames_per_second(static_cast<float>(6 + (i % 8)));
+        instance.advance(static_cast<float>(i % 40) * 0.125f);
+    }
+    return instances;
+}
+
+/// Instances updated per millisecond by `update_all()` on @p pool.
+double measure(std::vector<MD2Instance>& instances,
+               ThreadPool& pool,
+               double seconds) {
+    using clock = std::chrono::steady_clock;
+
+    for (int i = 0; i < 10; ++i) {
+        update_all(instances, frame_time, pool);
+    }
+
+    size_t iterations = 0;
+    auto const start = clock::now();
+    auto const deadline =
+        start + std::chrono::duration_cast<clock::duration>(
+                    std::chrono::duration<double>(seconds));
+    auto now = start;
+    while (now < deadline) {
+        update_all(instances, frame_time, pool);
+        ++iterations;
+        now = clock::now();
+    }
+
+    auto const ms =
+        std::chrono::duration<double, std::milli>(now - start).count();
+    return static_cast<double>(instances.size() * iterations) / ms;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) try {
+    namespace po = boost::program_options;
+
+    std::string model_path =
+        std::string{MD2V_BENCH_FIXTURE_DIR} + "/bench.md2";
+    size_t instance_count = 512;
+    size_t max_threads = std::max(1U, std::thread::hardware_concurrency());
+    double seconds = 1.0;
+
+    po::options_description options("Benchmark options");
+    options.add_options()("help,h", "Show help")(
+        "model", po::value<std::string>(&model_path), "MD2 file to animate")(
+        "instances", po::value<size_t>(&instance_count), "Instance count")(
+        "threads", po::value<size_t>(&max_threads), "Highest thread count")(
+        "seconds", po::value<double>(&seconds), "Time per thread count");
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, options), vm);
+    po::notify(vm);
+    if (vm.count("help") != 0U) {
+        std::cout << options << '\n';
+        return 0;
+    }
+
+    MappedFile const file{model_path};
+    auto const model = std::make_shared<MD2Model const>(file.bytes());
+    auto instances = make_instances(model, instance_count);
+
+    fmt::print("{}: {} vertices, {} frames, {} instances\n", model_path,
+               model->vertex_count(), model->header().num_frames,
+               instance_count);
+    fmt::print("{:>8} {:>16} {:>9}\n", "threads", "instances/ms", "speedup");
+
+    double baseline = 0.0;
+    for (size_t threads = 1; threads <= max_threads; ++threads) {
+        // the calling thread takes part in update_all, so it counts as one
+        ThreadPool pool(threads - 1);
+        auto const rate = measure(instances, pool, seconds);
+        if (threads == 1) {
+            baseline = rate;
+        }
+        fmt::print("{:>8} {:>16.1f} {:>8.2f}x\n", threads, rate,
+                   rate / baseline);
+    }
+    return 0;
+} catch (std::exception const& e) {
+    fmt::print(stderr, "bench_update_all: {}\n", e.what());
+    return 1;
+}
@@ -0,0 +1,135 @@
+#include "synthetic.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace Synthetic {
+
+namespace {
+
+void put_u16le(std::vector<std::byte>& out, uint16_t v) {
+    out.push_back(static_cast<std::byte>(v & 0xFFU));
+    out.push_back(static_cast<std::byte>(v >> 8U));
+}
+
+void write_i32le(std::ofstream& f, int32_t v) {
+    auto const u = static_cast<uint32_t>(v);
+    for (auto shift : {0U, 8U, 16U, 24U}) {
+        f.put(static_cast<char>((u >> shift) & 0xFFU));
+    }
+}
+
+} // namespace
+
+std::vector<std::byte> pcx(int width, int height) {
+    std::vector<std::byte> out;
+    out.reserve(128 + static_cast<size_t>(width * height) + 769);
+
+    // 128-byte header; the offsets of the fields used by the decoder match
+    // PCX::Header
+    out.push_back(std::byte{0x0A}); // identifier
+    out.push_back(std::byte{5});    // version
+    out.push_back(std::byte{1});    // RLE
+    out.push_back(std::byte{8});    // bits per pixel
+    put_u16le(out, 0);
+    put_u16le(out, 0);
+    put_u16le(out, static_cast<uint16_t>(width - 1));
+    put_u16le(out, static_cast<uint16_t>(height - 1));
+    put_u16le(out, 72);
+    put_u16le(out, 72);
+    out.insert(out.end(), 48, std::byte{0}); // EGA palette
+    out.push_back(std::byte{0});             // reserved
+    out.push_back(std::byte{1});             // planes
+    put_u16le(out, static_cast<uint16_t>(width));
+    put_u16le(out, 1);
+    put_u16le(out, 0);
+    put_u16le(out, 0);
+    out.insert(out.end(), 54, std::byte{0});
+
+    for (int y = 0; y < height; ++y) {
+        int x = 0;
+        while (x < width) {
+            auto const value = static_cast<uint8_t>((x + y) & 0xFF);
+            if (((x / 8) + y) % 2 == 0) {
+                // run of up to 63 copies
+                auto const run = std::min(width - x, 1 + ((x + y) % 63));
+                out.push_back(static_cast<std::byte>(0xC0U | unsigned(run)));
+                out.push_back(static_cast<std::byte>(value));
+                x += run;
+            } else {
+                // values of 0xC0 and above must be written as a run of one
+                if (value >= 0xC0) {
+                    out.push_back(std::byte{0xC1});
+                }
+                out.push_back(static_cast<std::byte>(value));
+                ++x;
+            }
+        }
+    }
+
+    out.push_back(std::byte{0x0C}); // palette marker
+    for (int i = 0; i < 256; ++i) {
+        out.push_back(static_cast<std::byte>(i));
+        out.push_back(static_cast<std::byte>(255 - i));
+        out.push_back(static_cast<std::byte>((i * 7) & 0xFF));
+    }
+    return out;
+}
+
+std::string pak_entry_name(size_t index) {
+    return fmt::format("models/m{:05}/tris.md2", index);
+}
+
+void pak(std::filesystem::path const& path,
+         std::span<std::byte const> content,
+         size_t count) {
+    std::ofstream f(path, std::ios::binary);
+    if (!f) {
+        throw std::runtime_error("failed to create " + path.string());
+    }
+
+    constexpr int32_t header_size = 12;
+    constexpr int32_t entry_size = 64;
+    auto const content_size = static_cast<int32_t>(content.size());
+
+    f.write("PACK", 4);
+    write_i32le(f, header_size + content_size);
+    write_i32le(f, static_cast<int32_t>(count) * entry_size);
+    f.write(reinterpret_cast<char const*>(content.data()),
+            static_cast<std::streamsize>(content.size()));
+
+    for (size_t i = 0; i < count; ++i) {
+        std::array<char, 56> name{};
+        auto const entry = pak_entry_name(i);
+        std::memcpy(name.data(), entry.data(),
+                    std::min(entry.size(), name.size() - 1));
+        f.write(name.data(), name.size());
+        write_i32le(f, header_size);
+        write_i32le(f, content_size);
+    }
+}
+
+void directory(std::filesystem::path const& root,
+               size_t dirs,
+               size_t files_per_dir) {
+    for (size_t d = 0; d < dirs; ++d) {
+        auto const dir = root / "models" / fmt::format("m{:04}", d);
+        std::filesystem::create_directories(dir);
+        for (size_t i = 0; i < files_per_dir; ++i) {
+            std::ofstream f(dir / fmt::format("f{:02}.pcx", i),
+                            std::ios::binary);
+            if (!f) {
+                throw std::runtime_error("failed to create " + dir.string());
+            }
+            f << i;
+        }
+    }
+}
+
+} // namespace Synthetic
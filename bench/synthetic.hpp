@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+/// Synthetic inputs for `bench_md2v` that are too large to generate with the
+/// test fixtures. Sizes are parameters so the benchmarks can scale them.
+namespace Synthetic {
+
+/// An 8-bit RLE PCX image of @p width x @p height with a full palette.
+///
+/// Rows alternate between long runs and single literal pixels so the decoder
+/// sees both encodings.
+std::vector<std::byte> pcx(int width, int height);
+
+/// Archive-relative path of the @p index-th entry written by `pak()`.
+std::string pak_entry_name(size_t index);
+
+/// Write a PAK archive to @p path with @p count directory entries named by
+/// `pak_entry_name()`. Every entry points at the same single copy of
+/// @p content, so the directory can be large while the file stays small.
+void pak(std::filesystem::path const& path,
+         std::span<std::byte const> content,
+         size_t count);
+
+/// Fill @p root with @p dirs directories of @p files_per_dir small files
+/// each, laid out as `models/mNNNN/fNN.pcx` like an unpacked game tree.
+void directory(std::filesystem::path const& root,
+               size_t dirs,
+               size_t files_per_dir);
+
+} // namespace Synthetic
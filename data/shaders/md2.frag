@@ -9,8 +9,32 @@ layout(location = 1) out vec4 glow;
 
 uniform vec3 glow_color;
 
+// Indexed skins: skin is an R8 texture of palette indices and palette a
+// 256x1 RGB texture. Indices cannot be filtered, so each of the four
+// nearest texels is resolved through the palette and the colours are
+// blended here, matching GL_LINEAR with GL_REPEAT on an RGB skin.
+uniform bool indexed;
+uniform sampler2D palette;
+
+vec3 palette_color(ivec2 texel) {
+  int index = int(texelFetch(skin, texel, 0).r * 255.0 + 0.5);
+  return texelFetch(palette, ivec2(index, 0), 0).rgb;
+}
+
+vec4 indexed_color(vec2 uv) {
+  vec2 size = vec2(textureSize(skin, 0));
+  vec2 st = uv * size - 0.5;
+  vec2 base = floor(st);
+  vec2 f = st - base;
+  ivec2 t0 = ivec2(mod(base, size));
+  ivec2 t1 = ivec2(mod(base + 1.0, size));
+  vec3 top = mix(palette_color(t0), palette_color(ivec2(t1.x, t0.y)), f.x);
+  vec3 bottom = mix(palette_color(ivec2(t0.x, t1.y)), palette_color(t1), f.x);
+  return vec4(mix(top, bottom, f.y), 1.0);
+}
+
 void main(void) {
 
   glow = vec4(glow_color, 1.0);
-  color = texture(skin, TexCoords);
+  color = indexed ? indexed_color(TexCoords) : texture(skin, TexCoords);
 }
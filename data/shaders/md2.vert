@@ -9,8 +9,24 @@ uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+// GPU morphing: when enabled the position attribute is ignored and the
+// vertex is blended from two keyframes held in a texture buffer. The frame
+// offsets are in vertices (frame index * vertices per frame).
+uniform bool morph;
+uniform samplerBuffer key_frames;
+uniform int current_frame_offset;
+uniform int next_frame_offset;
+uniform float blend;
+
 void main(void)
 {
+  vec3 p = position;
+  if (morph) {
+    vec3 p0 = texelFetch(key_frames, current_frame_offset + gl_VertexID).xyz;
+    vec3 p1 = texelFetch(key_frames, next_frame_offset + gl_VertexID).xyz;
+    p = mix(p0, p1, blend);
+  }
+
   TexCoords = texCoords;
-  gl_Position = projection * view * model * vec4(position, 1.0);
+  gl_Position = projection * view * model * vec4(p, 1.0);
 }
@@ -1,10 +1,15 @@
 #pragma once
 
+#include "md2view/frame_pacer.hpp"
+#include "md2view/frame_profiler.hpp"
+
 #include <boost/program_options.hpp>
 
 #include <bitset>
 #include <memory>
 #include <span>
+#include <string>
+#include <vector>
 
 class Engine {
 public:
@@ -19,6 +24,14 @@ public:
 
     Engine() = default;
 
+    /// Writes the trace file if `--trace` was given.
+    ~Engine();
+
+    Engine(Engine const&) = delete;
+    Engine& operator=(Engine const&) = delete;
+    Engine(Engine&&) = delete;
+    Engine& operator=(Engine&&) = delete;
+
     [[nodiscard]] int width() const { return width_; }
     [[nodiscard]] int height() const { return height_; }
 
@@ -42,6 +55,10 @@ public:
 
     [[nodiscard]] Mouse const& mouse() const { return mouse_; }
 
+    /// Per-stage timings of recent frames.
+    [[nodiscard]] FrameProfiler& profiler() { return profiler_; }
+    [[nodiscard]] FrameProfiler const& profiler() const { return profiler_; }
+
 protected:
     bool parse_args(std::span<char const*> args);
 
@@ -52,8 +69,18 @@ protected:
     std::bitset<max_keys> keys_;
     std::bitset<max_keys> keys_pressed_;
     Mouse mouse_;
+    FrameProfiler profiler_;
 
     boost::program_options::options_description opt_desc_;
     boost::program_options::variables_map variables_map_;
-    std::string pak_path_;
+    std::vector<std::string> pak_paths_;
+    bool compact_frames_{false};
+    bool gl_commands_{false};
+    bool indexed_skins_{false};
+    size_t model_cache_mib_{};
+    size_t texture_cache_mib_{};
+    std::string baked_model_dir_;
+    std::string pak_index_dir_;
+    std::string trace_path_;
+    FramePacer::Config pacing_;
 };
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <optional>
+
+/// Frame timing for the engine loop, kept free of GLFW so it can be tested
+/// with made up timestamps.
+///
+/// The loop hands `begin_frame()` the current time and gets back how many
+/// fixed steps to advance the game by and how long each one covers:
+/// - With no `Config::update_hz` every frame runs one update covering the
+///   time since the previous frame, as the loop always has.
+/// - With an update rate, updates advance the simulation in fixed steps out
+///   of an accumulator, however fast frames are drawn. A frame may run no
+///   steps or several; the backlog is capped so a stall cannot snowball into
+///   ever longer frames.
+///
+/// `run()` plays a frame out on the game: the steps only move the simulation
+/// forward, and the per-frame work that turns its state into something to
+/// draw runs once however many steps there were, even none.
+///
+/// Frame time is clamped to `max_frame_time`, so a debugger break or a long
+/// idle wait does not turn into one huge step. `end_frame()` returns how
+/// long to sleep to hold `Config::max_fps`, measured from frame deadlines
+/// rather than from the end of the last sleep so oversleeping does not
+/// lower the rate, and `sleep_for()` sleeps that precisely.
+///
+/// `Config::on_demand` is only recorded here; the loop decides when the
+/// game is idle and waits for events instead of drawing, then calls
+/// `reset()` so the wait is not counted as frame time.
+class FramePacer {
+public:
+    struct Config {
+        double update_hz{0.0}; ///< Fixed update rate; 0 for one update of
+                               ///< the frame's length per frame.
+        double max_fps{0.0};   ///< Frame rate cap; 0 for none.
+        bool on_demand{false}; ///< Only draw while something changes.
+    };
+
+    /// Updates to run for one frame.
+    struct Frame {
+        double dt;      ///< Seconds since the previous frame, clamped.
+        int steps;      ///< Number of game steps to run.
+        double step_dt; ///< Seconds each of those updates covers.
+    };
+
+    /// Longest frame time `begin_frame()` reports.
+    static constexpr double max_frame_time = 0.25;
+
+    /// Most fixed steps run in one frame; older backlog is dropped.
+    static constexpr int max_steps = 8;
+
+    /// Longest an on-demand loop waits for events before checking on the
+    /// game again, in seconds.
+    static constexpr double idle_timeout = 0.5;
+
+    FramePacer();
+    explicit FramePacer(Config config);
+
+    [[nodiscard]] Config const& config() const { return config_; }
+
+    /// Start a frame at @p now seconds. The first frame has a `dt` of 0.
+    [[nodiscard]] Frame begin_frame(double now);
+
+    /// Seconds to wait after a frame finishing at @p now before the next
+    /// may start; always 0 without a frame rate cap.
+    [[nodiscard]] double end_frame(double now);
+
+    /// Forget the time since the last frame, as if one had just been drawn
+    /// at @p now, and drop any fixed step backlog.
+    void reset(double now);
+
+    /// Call @p advance with `step_dt` once for each of @p frame's steps, then
+    /// @p update once.
+    template <typename Advance, typename Update>
+    static void run(Frame const& frame, Advance&& advance, Update&& update) {
+        for (int step = 0; step < frame.steps; ++step) {
+            advance(frame.step_dt);
+        }
+        update();
+    }
+
+    /// Sleep for @p seconds, waking closer to the deadline than a plain
+    /// `std::this_thread::sleep_for` would: the OS sleep stops short and the
+    /// rest is spent yielding.
+    static void sleep_for(double seconds);
+
+private:
+    Config config_;
+    std::optional<double> last_;
+    double accumulator_{};
+    double deadline_{};
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// Rolling per-stage frame timings, for finding where a frame's time goes.
+///
+/// A stage is a named part of the frame such as "animate" or "main pass".
+/// Each stage keeps one sample per frame and clock for the last
+/// `history_size` frames. CPU samples come from `Scope` and GPU samples from
+/// `GL::GpuTimer`, which only learns a GPU time a few frames after the work
+/// was issued and so records it against the frame it belongs to. A stage
+/// timed more than once in a frame, such as an update run for several fixed
+/// steps, adds up to one sample.
+///
+/// Knows nothing of GL or the clock source so it can be tested with made up
+/// times. Not thread-safe; stages are timed on the render thread.
+class FrameProfiler {
+public:
+    enum class Clock : std::uint8_t { cpu = 0, gpu, num_clocks };
+
+    using StageId = size_t;
+
+    /// Summary of a stage's samples in the history window, in milliseconds.
+    struct Percentiles {
+        float p50{};
+        float p95{};
+        float p99{};
+        float max{};
+        size_t samples{}; ///< Frames in the window with a sample.
+    };
+
+    /// Frames of history kept per stage.
+    static constexpr size_t history_size = 240;
+
+    /// Time the enclosing block on the CPU clock, and record it as a trace
+    /// event while tracing.
+    class Scope {
+    public:
+        Scope(FrameProfiler& profiler, StageId stage);
+        ~Scope();
+
+        Scope(Scope const&) = delete;
+        Scope& operator=(Scope const&) = delete;
+        Scope(Scope&&) = delete;
+        Scope& operator=(Scope&&) = delete;
+
+    private:
+        FrameProfiler& profiler_;
+        StageId stage_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    /// The id of the stage named @p name, adding it if it is new. Stages are
+    /// listed in the order they were added.
+    [[nodiscard]] StageId stage(std::string_view name);
+
+    [[nodiscard]] size_t stage_count() const { return stages_.size(); }
+
+    /// @throws gsl_lite::fail_fast if @p stage is not a stage id.
+    [[nodiscard]] std::string const& stage_name(StageId stage) const;
+
+    /// Start the next frame; samples recorded without a frame go to it.
+    void begin_frame() { ++frame_; }
+
+    /// Number of the current frame, counting from 0.
+    [[nodiscard]] std::uint64_t frame() const { return frame_; }
+
+    /// Add @p ms to @p stage's sample for @p frame. Samples for frames that
+    /// have left the history window are dropped.
+    ///
+    /// @throws gsl_lite::fail_fast if @p stage is not a stage id or @p frame
+    ///         is later than the current frame.
+    void record(StageId stage, Clock clock, std::uint64_t frame, float ms);
+
+    /// `record()` against the current frame.
+    void record(StageId stage, Clock clock, float ms) {
+        record(stage, clock, frame_, ms);
+    }
+
+    /// @p stage's samples in the history window, oldest first, with 0 for
+    /// frames that have none; suitable for plotting.
+    [[nodiscard]] std::vector<float> history(StageId stage, Clock clock) const;
+
+    /// Percentiles of the frames in the history window that have a sample.
+    [[nodiscard]] Percentiles percentiles(StageId stage, Clock clock) const;
+
+private:
+    static constexpr auto no_frame = std::numeric_limits<std::uint64_t>::max();
+
+    /// Ring of samples indexed by frame number modulo `history_size`, each
+    /// tagged with the frame it belongs to so stale slots are told apart.
+    struct Series {
+        std::array<float, history_size> ms{};
+        std::array<std::uint64_t, history_size> frames{};
+    };
+
+    struct Stage {
+        std::string name;
+        std::array<Series, static_cast<size_t>(Clock::num_clocks)> series;
+    };
+
+    [[nodiscard]] Series const& series(StageId stage, Clock clock) const;
+    [[nodiscard]] bool in_window(std::uint64_t frame) const;
+
+    std::vector<Stage> stages_;
+    std::uint64_t frame_{};
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "md2view/engine.hpp"
+#include "md2view/gl/gpu_timer.hpp"
 #include "md2view/gl/gui.hpp"
 #include "md2view/resource_manager.hpp"
 
@@ -20,6 +21,12 @@ public:
         return *resource_manager_;
     }
 
+    /// Times stages on both clocks into `profiler()`.
+    GpuTimer& gpu_timer() {
+        gsl_Expects(gpu_timer_);
+        return *gpu_timer_;
+    }
+
 protected:
     [[nodiscard]] GLfloat delta_time() const { return delta_time_; }
 
@@ -27,17 +34,32 @@ protected:
     void key_callback(int key, int action);
     void mouse_callback(double xpos, double ypos);
     void scroll_callback(double xoffset, double yoffset);
+    void mouse_button_callback();
 
     void window_resize_callback(int x, int y);
     void framebuffer_resize_callback(int x, int y);
 
 private:
+    /// Frames an on-demand loop keeps drawing after input, so ImGui sees
+    /// both a press and its release and finishes reacting to them.
+    static constexpr int input_redraw_frames = 3;
+
+    /// Keep drawing for a few frames after some input.
+    void wake() { redraw_frames_ = input_redraw_frames; }
+
+    /// True when an on-demand loop can wait for events instead of drawing:
+    /// no recent input, no key held and the game has nothing to animate.
+    [[nodiscard]] bool idle() const;
+
     Game game_;
     GLFWwindow* window_{nullptr};
     std::unique_ptr<ResourceManager> resource_manager_;
     std::unique_ptr<GL::Gui> gui_;
+    std::unique_ptr<GpuTimer> gpu_timer_;
+    FrameProfiler::StageId gui_stage_{};
+    FramePacer pacer_;
     GLfloat delta_time_ = 0.0f;
-    GLfloat last_frame_ = 0.0f;
+    int redraw_frames_ = input_redraw_frames;
     bool input_goes_to_game_ = false;
 };
 
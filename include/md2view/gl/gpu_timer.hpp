@@ -0,0 +1,84 @@
+#pragma once
+
+#include "md2view/frame_profiler.hpp"
+#include "md2view/gl/gl.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <vector>
+
+namespace GL {
+
+/// GPU stage timings from `GL_TIME_ELAPSED` queries, fed into a
+/// `FrameProfiler`.
+///
+/// A query's result is only ready once the GPU has finished the work, a
+/// frame or more after it was issued, and asking for it sooner stalls the
+/// CPU until it is. Queries therefore go round a ring: `begin_frame()`
+/// reads back only the queries whose results are already available and
+/// records them against the frame that issued them, and their query
+/// objects are reused. If the GPU falls so far behind that the ring is
+/// used up, stages go untimed until queries free up rather than waiting.
+///
+/// Elapsed time queries cannot nest, so neither can stages.
+class GpuTimer {
+public:
+    /// Time the enclosing block on both the CPU and the GPU clock.
+    class Scope {
+    public:
+        Scope(GpuTimer& timer, FrameProfiler::StageId stage);
+        ~Scope();
+
+        Scope(Scope const&) = delete;
+        Scope& operator=(Scope const&) = delete;
+        Scope(Scope&&) = delete;
+        Scope& operator=(Scope&&) = delete;
+
+    private:
+        GpuTimer& timer_;
+        FrameProfiler::Scope cpu_;
+    };
+
+    /// Most queries in flight at once; enough for a dozen stages over the
+    /// three or so frames a driver queues ahead.
+    static constexpr size_t max_queries = 64;
+
+    explicit GpuTimer(FrameProfiler& profiler);
+    ~GpuTimer();
+
+    GpuTimer(GpuTimer const&) = delete;
+    GpuTimer& operator=(GpuTimer const&) = delete;
+    GpuTimer(GpuTimer&&) = delete;
+    GpuTimer& operator=(GpuTimer&&) = delete;
+
+    [[nodiscard]] FrameProfiler& profiler() { return profiler_; }
+
+    /// Record every finished query and start timing the profiler's current
+    /// frame. Never waits on the GPU.
+    void begin_frame();
+
+    /// Start timing @p stage on the GPU.
+    ///
+    /// @throws gsl_lite::fail_fast if a stage is already being timed.
+    void begin(FrameProfiler::StageId stage);
+
+    /// Stop timing the stage started by `begin()`.
+    void end();
+
+private:
+    struct Pending {
+        GLuint query;
+        FrameProfiler::StageId stage;
+        std::uint64_t frame;
+    };
+
+    FrameProfiler& profiler_;
+    std::vector<GLuint> queries_;
+    std::vector<GLuint> free_;
+    std::deque<Pending> pending_; ///< In issue order.
+    std::optional<Pending> active_;
+    bool skipped_{false}; ///< `begin()` found no free query.
+};
+
+} // namespace GL
@@ -5,16 +5,21 @@
 #include <glm/glm.hpp>
 
 #include <array>
+#include <cstdint>
 #include <span>
+#include <vector>
 
 namespace GL {
 class Shader;
 
-/// Model-agnostic GPU mesh owning a VAO and two VBOs.
+/// Model-agnostic GPU mesh owning a VAO and its buffers.
 ///
 /// Holds one vertex-position buffer (dynamic, updated every frame via `sync()`)
 /// and one texture-coordinate buffer (static, uploaded once at construction).
-/// The draw call issues a single `glDrawArrays(GL_TRIANGLES, ...)`.
+/// The draw call issues a single `glDrawArrays(GL_TRIANGLES, ...)`, or
+/// `glDrawElements` when the mesh was created with an index buffer. Meshes
+/// made of strips and fans instead give their ranges to `set_batches()` and
+/// are drawn with one `glMultiDrawArrays` per primitive type.
 ///
 /// This class is deliberately decoupled from any specific model type. Any
 /// source that can produce a flat `span<glm::vec3>` of world-space vertex
@@ -26,18 +31,71 @@ class Shader;
 /// mesh.sync(model.interpolated_vertices());  // upload to GPU
 /// mesh.draw(shader);                         // draw
 /// @endcode
+///
+/// Alternatively every keyframe can be uploaded once with
+/// `upload_key_frames()`. `draw()` then binds them as a `samplerBuffer` on
+/// texture unit `key_frame_texture_unit` and the vertex shader blends two
+/// frames itself, so an animation step costs a few uniforms instead of a
+/// buffer upload:
+/// @code
+/// mesh.upload_key_frames(model.key_frames());  // once
+/// model.advance(dt);                           // per frame, no lerp
+/// // set frame offsets and blend uniforms from model.frame_blend()
+/// mesh.draw(shader);
+/// @endcode
+///
+/// With `Streaming::persistent` the position buffer is immutable storage
+/// holding `stream_regions` copies of the vertices, mapped once for the life
+/// of the mesh. Each frame writes the next region while the GPU may still be
+/// reading the previous ones, and a fence per region stops the CPU from
+/// overwriting a region before the draw that reads it has finished. This
+/// avoids the implicit synchronisation of `glBufferSubData` on a buffer that
+/// is in use, and lets the animation blend straight into GPU-visible memory:
+/// @code
+/// model.update(dt, mesh.next_vertices());  // blend into the mapped ring
+/// mesh.draw(shader);
+/// @endcode
 class Mesh {
 public:
+    /// How vertex positions reach the GPU each frame.
+    enum class Streaming : uint8_t {
+        sub_data,   ///< `glBufferSubData` into a `GL_DYNAMIC_DRAW` buffer.
+        persistent, ///< Persistently mapped, fenced ring of regions.
+    };
+
+    /// A range of vertices drawn as one primitive, e.g. a triangle strip.
+    struct Batch {
+        GLenum mode;
+        GLint first;
+        GLsizei count;
+    };
+
+    /// Number of regions in the persistent ring: one being written, and up
+    /// to two frames queued on the GPU.
+    static constexpr size_t stream_regions = 3;
+
+    /// `persistent` if the context has `ARB_buffer_storage`, otherwise
+    /// `sub_data`. Requires a current context.
+    [[nodiscard]] static Streaming preferred_streaming();
+
     /// Allocate GPU resources and upload initial vertex and texcoord data.
     ///
     /// @param vertices  Flat array of world-space vertex positions
-    ///                  (num_triangles × 3 entries).
+    ///                  (num_triangles × 3 entries when @p indices is empty).
     /// @param texcoords Flat array of normalised texture coordinates,
     ///                  parallel to @p vertices.
+    /// @param indices   Optional static triangle list indices into
+    ///                  @p vertices. If non-empty the mesh is drawn with
+    ///                  `glDrawElements`.
+    /// @param streaming How `sync()` and `next_vertices()` update positions.
+    /// @throws gsl_lite::fail_fast if @p streaming is `persistent` and the
+    ///         context lacks `ARB_buffer_storage`.
     Mesh(std::span<glm::vec3 const> vertices,
-         std::span<glm::vec2 const> texcoords);
+         std::span<glm::vec2 const> texcoords,
+         std::span<uint16_t const> indices = {},
+         Streaming streaming = preferred_streaming());
 
-    /// Release the VAO and VBOs.
+    /// Release the VAO, VBOs and any outstanding fences.
     ~Mesh();
 
     Mesh(Mesh const&) = delete;
@@ -49,16 +107,77 @@ public:
     ///
     /// Only the dynamic vertex buffer is updated; the static texcoord buffer
     /// is untouched. @p vertices must be the same size as the span passed to
-    /// the constructor.
+    /// the constructor. With `Streaming::persistent` this copies into
+    /// `next_vertices()`.
     void sync(std::span<glm::vec3 const> vertices);
 
-    /// Bind the VAO and issue `glDrawArrays`.
+    /// Advance the persistent ring and return its next region for the caller
+    /// to fill with every vertex position; `draw()` reads it from then on.
+    ///
+    /// Blocks only if the GPU is still reading that region from
+    /// `stream_regions` frames ago.
+    /// @throws gsl_lite::fail_fast unless `streaming()` is `persistent`.
+    [[nodiscard]] std::span<glm::vec3> next_vertices();
+
+    [[nodiscard]] Streaming streaming() const { return streaming_; }
+
+    /// Upload every keyframe into a `GL_RGB32F` texture buffer.
+    ///
+    /// @p key_frames holds whole frames back to back, each the size of the
+    /// span passed to the constructor. Replaces any previous upload.
+    /// @return False, with nothing uploaded and `has_key_frames()` false, if
+    ///         there are more vertices than `GL_MAX_TEXTURE_BUFFER_SIZE`
+    ///         texels; the caller then has to blend on the CPU.
+    /// @throws gsl_lite::fail_fast if @p key_frames is empty or not a whole
+    ///         number of frames.
+    bool upload_key_frames(std::span<glm::vec3 const> key_frames);
+
+    /// Draw @p batches instead of a triangle list. Batches are grouped by
+    /// mode here so `draw()` issues one `glMultiDrawArrays` per mode; an
+    /// empty span goes back to the triangle list.
+    /// @throws gsl_lite::fail_fast if a batch lies outside the vertices or
+    ///         the mesh has indices.
+    void set_batches(std::span<Batch const> batches);
+
+    /// True once `upload_key_frames()` has succeeded.
+    [[nodiscard]] bool has_key_frames() const {
+        return key_frame_texture_ != 0;
+    }
+
+    /// Bind the VAO and issue `glDrawArrays`, `glDrawElements` or the
+    /// `glMultiDrawArrays` calls of `set_batches()`. If key
+    /// frames were uploaded their texture buffer is bound to
+    /// `key_frame_texture_unit` first.
     void draw(Shader& shader) const;
 
+    /// Texture unit the key frame buffer is bound to by `draw()`.
+    static constexpr GLuint key_frame_texture_unit = 1;
+
 private:
+    static constexpr size_t position_vbo = 0;
+    static constexpr size_t texcoord_vbo = 1;
+    static constexpr size_t element_vbo = 2;
+
+    /// Every batch of one mode, as the parallel arrays `glMultiDrawArrays`
+    /// takes.
+    struct MultiDraw {
+        GLenum mode;
+        std::vector<GLint> firsts;
+        std::vector<GLsizei> counts;
+    };
+
     GLuint vao_{};
-    std::array<GLuint, 2> vbo_{};
+    std::array<GLuint, 3> vbo_{};
     GLsizei vertex_count_{};
+    GLsizei index_count_{};
+    GLuint key_frame_buffer_{};
+    GLuint key_frame_texture_{};
+    std::vector<MultiDraw> multi_draws_;
+
+    Streaming streaming_{Streaming::sub_data};
+    glm::vec3* mapped_{};
+    size_t region_{};
+    std::array<GLsync, stream_regions> fences_{};
 };
 
 } // namespace GL
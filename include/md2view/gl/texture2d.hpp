@@ -2,15 +2,24 @@
 
 #include "md2view/gl/gl.hpp"
 
+#include <cstdint>
 #include <memory>
 #include <span>
 #include <string>
+#include <vector>
 
-class PAK;
+class VFS;
 
 namespace GL {
 
 /// An OpenGL 2D texture wrapping a single `GL_TEXTURE_2D` object.
+///
+/// An indexed texture instead holds an 8-bit palette index per texel in an
+/// `R8` texture plus a second 256x1 RGB palette texture, a third of the
+/// memory of the expanded image. `bind()` binds the palette to
+/// `palette_texture_unit` and the shader resolves colours with two
+/// `texelFetch`es; swapping the palette with `set_palette()` recolours the
+/// skin without touching the indices.
 class Texture2D {
 public:
     /// Sampling and wrap parameters applied at upload time.
@@ -23,6 +32,17 @@ public:
         GLint filter_max = GL_LINEAR;   ///< Magnification filter.
     };
 
+    /// A decoded image ready for `upload()`. Produced by `decode()`, which
+    /// makes no GL calls and may run on any thread.
+    struct Image {
+        GLuint width{};
+        GLuint height{};
+        /// RGB triples, or one palette index per pixel if `palette` is set.
+        std::vector<unsigned char> pixels;
+        /// `palette_size` RGB triples for an indexed image, else empty.
+        std::vector<unsigned char> palette;
+    };
+
     ~Texture2D();
 
     /// Upload pixel data to the GPU.
@@ -37,30 +57,73 @@ public:
               std::span<unsigned char const> data,
               bool alpha = false);
 
+    /// Upload an 8-bit palette-indexed image and its palette.
+    ///
+    /// @param width   Image width in pixels.
+    /// @param height  Image height in pixels.
+    /// @param indices One palette index per pixel, row-major.
+    /// @param palette `palette_size` packed RGB triples.
+    Texture2D(GLuint width,
+              GLuint height,
+              std::span<uint8_t const> indices,
+              std::span<unsigned char const> palette);
+
     Texture2D(Texture2D const&) = delete;
     Texture2D& operator=(Texture2D const&) = delete;
 
     Texture2D(Texture2D&& rhs) noexcept;
     Texture2D& operator=(Texture2D&& rhs) noexcept;
 
-    /// Bind to the currently active texture unit.
+    /// Bind to the currently active texture unit. An indexed texture also
+    /// binds its palette to `palette_texture_unit` and then makes
+    /// `GL_TEXTURE0` active.
     void bind() const;
 
+    /// Replace the palette of an indexed texture.
+    ///
+    /// @param palette `palette_size` packed RGB triples.
+    void set_palette(std::span<unsigned char const> palette);
+
     [[nodiscard]] Attributes const& attributes() const { return attr_; }
     [[nodiscard]] GLuint id() const { return id_; }
+    [[nodiscard]] bool indexed() const { return palette_id_ != 0U; }
+
+    /// Estimated GPU memory held, assuming drivers pad RGB texels to four
+    /// bytes: the full mip chain of an RGB texture, or the single level of
+    /// an indexed texture plus its palette.
+    [[nodiscard]] size_t gpu_bytes() const;
     [[nodiscard]] GLuint width() const { return width_; }
     [[nodiscard]] GLuint height() const { return height_; }
 
+    /// Texture unit the palette of an indexed texture is bound to.
+    static constexpr GLuint palette_texture_unit = 2;
+    /// Number of entries in a palette.
+    static constexpr GLuint palette_size = 256;
+
     /// Unbind any texture from `GL_TEXTURE_2D`.
     static void unbind() { glBindTexture(GL_TEXTURE_2D, 0); }
 
-    /// Load a texture from a PAK entry, decoding PCX or common image formats.
+    /// Decode a VFS entry, PCX or a common image format, without touching
+    /// GL. Safe to call from worker threads.
+    ///
+    /// Every format is decoded from `VFS::view()`, so textures inside `.pak`
+    /// archives load without unpacking them to disk.
+    ///
+    /// @param vfs     The search path to load from.
+    /// @param path    Archive-relative path to the image file.
+    /// @param indexed Keep PCX images palette-indexed rather than expanding
+    ///                them to RGB. Other formats are always RGB.
+    static Image
+    decode(VFS const& vfs, std::string const& path, bool indexed = false);
+
+    /// Create a texture from a decoded image. Must run on the GL thread.
+    static std::shared_ptr<Texture2D> upload(Image const& image);
+
+    /// `upload(decode(vfs, path, indexed))`.
     ///
-    /// @param pak  The archive to load from.
-    /// @param path Archive-relative path to the image file.
     /// @return A heap-allocated Texture2D ready for use.
-    static std::shared_ptr<Texture2D> load(PAK const& pak,
-                                           std::string const& path);
+    static std::shared_ptr<Texture2D>
+    load(VFS const& vfs, std::string const& path, bool indexed = false);
 
 private:
     void cleanup();
@@ -71,6 +134,7 @@ private:
 
     Attributes attr_;
     GLuint id_{};
+    GLuint palette_id_{};
     GLuint width_{};
     GLuint height_{};
 };
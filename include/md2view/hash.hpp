@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+/// 64-bit FNV-1a.
+///
+/// Not cryptographic; used to detect changed files and to key caches, where
+/// a fast, dependency-free, stable-across-runs hash is what matters.
+namespace Hash {
+
+inline constexpr uint64_t fnv1a_64_basis = 14695981039346656037ULL;
+inline constexpr uint64_t fnv1a_64_prime = 1099511628211ULL;
+
+/// Continue hashing @p bytes from @p hash, so several pieces can be hashed
+/// as if they were one buffer.
+[[nodiscard]] constexpr uint64_t
+fnv1a_64(std::span<std::byte const> bytes, uint64_t hash = fnv1a_64_basis) {
+    for (auto const b : bytes) {
+        hash = (hash ^ static_cast<uint64_t>(b)) * fnv1a_64_prime;
+    }
+    return hash;
+}
+
+[[nodiscard]] constexpr uint64_t fnv1a_64(std::string_view str,
+                                          uint64_t hash = fnv1a_64_basis) {
+    for (auto const c : str) {
+        hash = (hash ^ static_cast<uint64_t>(static_cast<unsigned char>(c))) *
+               fnv1a_64_prime;
+    }
+    return hash;
+}
+
+} // namespace Hash
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <spdlog/spdlog.h>
+
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+/// String-keyed cache of shared resources with a byte budget and least
+/// recently used eviction.
+///
+/// Each entry records its size in bytes as given to `insert()`. Whenever the
+/// total exceeds the budget, entries are evicted oldest first, but only
+/// those the cache holds the sole reference to: anything still in use
+/// elsewhere stays, even if that leaves the cache over budget. The newest
+/// entry is never evicted by its own insertion.
+///
+/// Not thread-safe; `ResourceManager` only touches its caches from the
+/// render thread.
+template <typename T> class LruCache {
+public:
+    /// Lookup and eviction counters since construction.
+    struct Stats {
+        size_t hits{};
+        size_t misses{};
+        size_t evictions{};
+    };
+
+    /// A budget that never evicts.
+    static constexpr size_t unlimited = std::numeric_limits<size_t>::max();
+
+    /// @param name   Used in log messages, e.g. "model".
+    /// @param budget Byte budget, or `unlimited`.
+    explicit LruCache(std::string name, size_t budget = unlimited)
+        : name_{std::move(name)}
+        , budget_{budget} {}
+
+    /// Return the entry for @p key and mark it most recently used, or null.
+    /// Counts a hit or a miss.
+    std::shared_ptr<T> find(std::string const& key) {
+        auto const iter = entries_.find(key);
+        if (iter == entries_.end()) {
+            ++stats_.misses;
+            return {};
+        }
+        ++stats_.hits;
+        order_.splice(order_.begin(), order_, iter->second.order);
+        return iter->second.value;
+    }
+
+    /// `find()`, throwing if @p key is not cached.
+    /// @throws std::out_of_range if @p key is not cached.
+    std::shared_ptr<T> at(std::string const& key) {
+        auto value = find(key);
+        if (!value) {
+            throw std::out_of_range(name_ + " not cached: " + key);
+        }
+        return value;
+    }
+
+    /// True if @p key is cached. Does not count as a lookup or touch the
+    /// LRU order.
+    [[nodiscard]] bool contains(std::string const& key) const {
+        return entries_.contains(key);
+    }
+
+    /// Cache @p value as the most recently used entry, then evict down to
+    /// the budget. If @p key is already cached the existing entry is kept
+    /// and returned instead.
+    std::shared_ptr<T> insert(std::string const& key,
+                              std::shared_ptr<T> value,
+                              size_t bytes) {
+        if (auto const iter = entries_.find(key); iter != entries_.end()) {
+            order_.splice(order_.begin(), order_, iter->second.order);
+            return iter->second.value;
+        }
+        order_.push_front(key);
+        entries_.emplace(key, Entry{value, bytes, order_.begin()});
+        bytes_ += bytes;
+        evict();
+        return value;
+    }
+
+    /// Change the budget, evicting at once if the cache is over it.
+    void set_budget(size_t budget) {
+        budget_ = budget;
+        evict();
+    }
+
+    [[nodiscard]] std::string const& name() const { return name_; }
+    [[nodiscard]] size_t budget() const { return budget_; }
+    /// Total bytes of all cached entries.
+    [[nodiscard]] size_t bytes() const { return bytes_; }
+    [[nodiscard]] size_t size() const { return entries_.size(); }
+    [[nodiscard]] Stats const& stats() const { return stats_; }
+
+private:
+    struct Entry {
+        std::shared_ptr<T> value;
+        size_t bytes;
+        std::list<std::string>::iterator order;
+    };
+
+    void evict() {
+        if (bytes_ <= budget_ || order_.empty()) {
+            return;
+        }
+        // walk from the oldest entry up to, but not including, the newest
+        auto iter = std::prev(order_.end());
+        while (bytes_ > budget_ && iter != order_.begin()) {
+            auto const current = iter--;
+            auto const entry = entries_.find(*current);
+            if (entry->second.value.use_count() > 1) {
+                continue;
+            }
+            bytes_ -= entry->second.bytes;
+            ++stats_.evictions;
+            spdlog::info("evicted {} {} ({} bytes), cache at {}/{} bytes",
+                         name_, *current, entry->second.bytes, bytes_,
+                         budget_);
+            entries_.erase(entry);
+            order_.erase(current);
+        }
+    }
+
+    std::string name_;
+    size_t budget_;
+    size_t bytes_{};
+    Stats stats_;
+    // most recently used first
+    std::list<std::string> order_;
+    std::unordered_map<std::string, Entry> entries_;
+};
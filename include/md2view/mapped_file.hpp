@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <utility>
+
+/// Read-only memory mapping of an entire file.
+///
+/// The mapped bytes stay valid for the lifetime of the object. Parsers take
+/// `std::span<std::byte const>` views into the mapping instead of issuing
+/// stream reads, so a file is paged in on demand with no intermediate copies.
+/// An empty file yields an empty span.
+class MappedFile {
+public:
+    /// Construct an empty mapping.
+    MappedFile() = default;
+
+    /// Map @p fpath read-only.
+    ///
+    /// @throws std::runtime_error if the file cannot be opened or mapped.
+    explicit MappedFile(std::filesystem::path const& fpath);
+
+    ~MappedFile();
+
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    MappedFile(MappedFile&& rhs) noexcept;
+    MappedFile& operator=(MappedFile&& rhs) noexcept;
+
+    /// The mapped file contents.
+    [[nodiscard]] std::span<std::byte const> bytes() const noexcept {
+        return {data_, size_};
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0U; }
+
+private:
+    void cleanup() noexcept;
+
+    std::byte const* data_{};
+    std::size_t size_{};
+#ifdef _WIN32
+    void* file_{};
+    void* mapping_{};
+#endif
+};
+
+/// A byte range that keeps the `MappedFile` it points into alive.
+///
+/// Copies share the mapping, which is unmapped once the last of them is
+/// gone. A range without a file is a plain view whose storage the caller
+/// keeps alive by other means, such as an entry of a mapped PAK archive.
+class MappedBytes {
+public:
+    MappedBytes() = default;
+
+    /// @p bytes, which lie inside @p file if it is set.
+    explicit MappedBytes(std::span<std::byte const> bytes,
+                         std::shared_ptr<MappedFile const> file = {})
+        : bytes_(bytes)
+        , file_(std::move(file)) {}
+
+    /// The whole of @p file.
+    explicit MappedBytes(std::shared_ptr<MappedFile const> file)
+        : bytes_(file ? file->bytes() : std::span<std::byte const>{})
+        , file_(std::move(file)) {}
+
+    [[nodiscard]] std::span<std::byte const> bytes() const noexcept {
+        return bytes_;
+    }
+    [[nodiscard]] std::byte const* data() const noexcept {
+        return bytes_.data();
+    }
+    [[nodiscard]] std::size_t size() const noexcept { return bytes_.size(); }
+    [[nodiscard]] bool empty() const noexcept { return bytes_.empty(); }
+
+    /// The mapping backing the bytes, or null for a plain view.
+    [[nodiscard]] std::shared_ptr<MappedFile const> const& file() const {
+        return file_;
+    }
+
+private:
+    std::span<std::byte const> bytes_;
+    std::shared_ptr<MappedFile const> file_;
+};
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "md2view/md2_model.hpp"
+
+#include <boost/algorithm/clamp.hpp>
+#include <glm/glm.hpp>
+#include <gsl-lite/gsl-lite.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+/// Per-instance animation state for a shared `MD2Model`.
+///
+/// Holds only what differs between two copies of the same model on screen:
+/// the current animation and frame pair, playback speed, selected skin, and
+/// the blended output vertices. The parsed frames, texcoords and animation
+/// table stay in the `MD2Model`, so any number of instances can animate
+/// independently without duplicating model data. Instances are cheap to copy
+/// and move.
+///
+/// `update(dt)` advances the animation and writes lerped world-space
+/// positions into `interpolated_vertices()`. Renderers that blend on the GPU
+/// call `advance(dt)` instead and read `frame_blend()`; renderers that step
+/// the animation several times per drawn frame call `advance(dt)` per step
+/// and `blend()` once before drawing.
+class MD2Instance {
+public:
+    /// Start at the first frame of the model's first animation.
+    ///
+    /// @throws gsl_lite::fail_fast if @p model is null.
+    explicit MD2Instance(std::shared_ptr<MD2Model const> model);
+
+    /// @name Accessors
+    /// @{
+    MD2Model const& model() const { return *model_; }
+    std::shared_ptr<MD2Model const> const& shared_model() const {
+        return model_;
+    }
+    size_t animation_index() const { return current_animation_index_; }
+    size_t skin_index() const { return current_skin_index_; }
+    float frames_per_second() const { return frames_per_second_; }
+
+    MD2Model::SkinData const& current_skin() const {
+        return gsl_lite::at(model_->skins(), current_skin_index_);
+    }
+
+    /// World-space vertex positions for the current interpolated frame,
+    /// `model().vertex_count()` entries. This is the data that should be
+    /// uploaded to the GPU via `GL::Mesh::sync()`.
+    std::vector<glm::vec3> const& interpolated_vertices() const {
+        return interpolated_vertices_;
+    }
+
+    /// False if `advance()` would do nothing: the animation is paused
+    /// (fps == 0), is a single frame, or is a non-looping animation that
+    /// has reached its last frame. A renderer can stop redrawing while this
+    /// is false and nothing else changes.
+    [[nodiscard]] bool animating() const;
+
+    /// Current frame pair and blend factor, as set by `advance()`.
+    MD2Model::FrameBlend frame_blend() const {
+        return {current_frame_, next_frame_, interpolation_};
+    }
+    /// @}
+
+    /// Advance the animation by @p dt seconds without touching
+    /// `interpolated_vertices()`; only `frame_blend()` changes.
+    ///
+    /// No-op unless `animating()`.
+    void advance(float dt);
+
+    /// Blend the current frame pair into `interpolated_vertices()` without
+    /// advancing the animation.
+    void blend();
+
+    /// Blend the current frame pair straight into @p out without advancing
+    /// the animation.
+    ///
+    /// @throws gsl_lite::fail_fast unless @p out has
+    ///         `model().vertex_count()` entries.
+    void blend(std::span<glm::vec3> out) const;
+
+    /// `advance(dt)`, then `blend()`.
+    void update(float dt);
+
+    /// `advance(dt)`, then blend the current frame pair straight into @p out,
+    /// e.g. a mapped GPU buffer from `GL::Mesh::next_vertices()`.
+    /// `interpolated_vertices()` is left untouched.
+    ///
+    /// @throws gsl_lite::fail_fast unless @p out has
+    ///         `model().vertex_count()` entries.
+    void update(float dt, std::span<glm::vec3> out);
+
+    /// Switch to the animation with the given name. No-op if not found.
+    void set_animation(std::string const& id);
+
+    /// Switch to the animation at @p index.
+    /// @throws gsl_lite::fail_fast if @p index is out of range.
+    void set_animation(size_t index);
+
+    /// @throws gsl_lite::fail_fast if @p index is out of range.
+    void set_skin_index(size_t index);
+
+    /// @param f Frames per second, clamped to [0, 60]. Pass 0 to pause.
+    void set_frames_per_second(float f) {
+        frames_per_second_ = boost::algorithm::clamp(f, 0.0f, 60.0f);
+    }
+
+private:
+    std::shared_ptr<MD2Model const> model_;
+    std::vector<glm::vec3> interpolated_vertices_;
+
+    int next_frame_{};
+    int current_frame_{};
+    float interpolation_{};
+    float frames_per_second_ = 8.0f;
+
+    std::size_t current_animation_index_{};
+    std::size_t current_skin_index_{};
+};
+
+/// `update(dt)` every instance in @p instances, one after another.
+void update_all(std::span<MD2Instance> instances, float dt);
+
+/// `update(dt)` every instance in @p instances, spread across @p pool.
+///
+/// Instances are independent (shared models are only read), so the span is
+/// split into chunks that idle workers steal from each other; the calling
+/// thread works too and returns once every instance is updated.
+void update_all(std::span<MD2Instance> instances, float dt, ThreadPool& pool);
@@ -0,0 +1,397 @@
+#pragma once
+
+/// @see http://tfc.duke.free.fr/coding/md2-specs-en.html
+/// @see http://tfc.duke.free.fr/old/models/md2.htm
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class PAK;
+class VFS;
+
+/// Immutable Quake II MD2 keyframe model: parser and frame interpolator.
+///
+/// MD2 is a keyframe animation format. Each frame stores compressed vertex
+/// positions (3 × uint8 scaled by per-frame floats). This class:
+/// - Parses all sections of the binary file (header, skins, texcoords,
+///   triangles, frames) directly from a byte span, typically a memory-mapped
+///   file. Every section is bounds-checked against the span before it is
+///   read.
+/// - Unpacks triangles into a vertex buffer. The default
+///   `Layout::triangle_list` has one entry per triangle corner for
+///   `glDrawArrays`;
+///   `Layout::indexed` welds corners sharing the same (xyz, st) pair into
+///   unique vertices and emits a `uint16` index buffer for `glDrawElements`,
+///   reordered for the vertex cache by `VertexCache`;
+///   `Layout::gl_commands` instead takes the file's own triangle strips and
+///   fans, with their embedded texcoords, as `batches()` for
+///   `glMultiDrawArrays`.
+/// - Blends any two keyframes into a caller-provided buffer with `blend()`.
+///   Renderers that blend on the GPU upload `key_frames()` instead.
+/// - Keeps keyframes either unpacked to floats (`Storage::unpacked`) or in
+///   their quantized on-disk form (`Storage::compact`), in which case only
+///   the two frames being blended are decoded by `blend()`.
+///
+/// A loaded model can be written out with `write_baked()` in the `.md2c`
+/// format: the post-processed texcoords, vertex map, indices, keyframes,
+/// skins and animations laid out ready to copy back, so the `Baked`
+/// constructor skips triangle unpacking, welding and dequantizing
+/// altogether. `ModelCache` manages those files.
+///
+/// Nothing changes after construction, so one model is shared (usually as a
+/// `std::shared_ptr<MD2Model const>`) by any number of `MD2Instance`s, each
+/// holding its own animation cursor and output vertices.
+///
+/// **This class has no OpenGL dependency.** GPU upload is handled separately
+/// by `GL::Mesh`. Because no graphics context is required, models can be
+/// constructed and tested without a display.
+///
+/// Coordinate remapping: the loader swaps Y and Z to convert from Quake's
+/// right-handed Z-up convention to OpenGL's Y-up convention
+/// (`v[0]`→x, `v[1]`→z, `v[2]`→y).
+class MD2Model {
+public:
+    /// @name File format constants
+    /// @{
+    static int32_t const ident = 844121161; ///< Magic number ("IDP2").
+    static int32_t const version = 8;
+    static int32_t const max_tris = 4096;
+    static int32_t const max_vertices = 2048;
+    static int32_t const max_texcoords = 2048;
+    static int32_t const max_frames = 512;
+    static int32_t const max_skins = 32;
+    /// @}
+
+    /// On-disk file header (17 × int32, no padding).
+    struct Header {
+        int32_t ident;      ///< Must equal MD2Model::ident.
+        int32_t version;    ///< Must equal MD2Model::version.
+        int32_t skinwidth;  ///< Skin texture width in pixels.
+        int32_t skinheight; ///< Skin texture height in pixels.
+        int32_t framesize;  ///< Size of one frame in bytes.
+        int32_t num_skins;  ///< Number of skin entries.
+        int32_t num_xyz;    ///< Number of vertices per frame.
+        int32_t num_st;     ///< Number of texture coordinate pairs.
+        int32_t num_tris;   ///< Number of triangles.
+        int32_t num_glcmds; ///< Size of the GL command section in int32s.
+        int32_t num_frames; ///< Total number of keyframes.
+        int32_t offset_skins;  ///< File offset to the skin section.
+        int32_t offset_st;     ///< File offset to the texcoord section.
+        int32_t offset_tris;   ///< File offset to the triangle section.
+        int32_t offset_frames; ///< File offset to the frame section.
+        int32_t offset_glcmds; ///< File offset to GL commands.
+        int32_t offset_end;    ///< File size.
+    };
+
+    /// A skin name entry (64-byte null-padded string).
+    struct Skin {
+        std::array<char, 64> name{};
+    };
+
+    /// Raw integer texture coordinate pair as stored on disk.
+    /// Scale by (1/skinwidth, 1/skinheight) to get normalised UVs.
+    struct TexCoord {
+        int16_t s;
+        int16_t t;
+    };
+
+    /// A triangle referencing three vertex indices and three texcoord indices.
+    struct Triangle {
+        std::array<uint16_t, 3>
+            vertex;                 ///< Indices into the frame vertex array.
+        std::array<uint16_t, 3> st; ///< Indices into the texcoord array.
+    };
+
+    /// A compressed vertex: three uint8 components scaled by the frame's
+    /// scale/translate vectors, plus a pre-computed normal index.
+    struct Vertex {
+        std::array<uint8_t, 3> v;
+        uint8_t normal_index;
+    };
+
+    /// One keyframe: per-frame scale/translate, a name, and the raw vertices.
+    struct Frame {
+        std::array<float, 3> scale{};
+        std::array<float, 3> translate{};
+        std::array<char, 16> name{};
+        std::vector<Vertex> vertices;
+    };
+
+    /// A named animation consisting of a contiguous range of frames.
+    ///
+    /// Animation names are derived by stripping trailing digits from frame
+    /// names (e.g. `"stand0"`, `"stand1"` → animation `"stand"`).
+    struct Animation {
+        std::string name;
+        int start_frame; ///< Index of the first frame (inclusive).
+        int end_frame;   ///< Index of the last frame (inclusive).
+        bool loop;       ///< If false, animation stops at end_frame.
+
+        Animation()
+            : start_frame(-1)
+            , end_frame(-1)
+            , loop(true) {}
+
+        explicit Animation(std::string id)
+            : name(std::move(id))
+            , start_frame(-1)
+            , end_frame(-1)
+            , loop(true) {}
+    };
+
+    /// Vertex layout produced by the loader.
+    enum class Layout : std::uint8_t {
+        triangle_list, ///< One vertex per triangle corner, `glDrawArrays`.
+        indexed, ///< Unique (xyz, st) vertices plus `indices()`, drawn with
+                 ///< `glDrawElements`.
+        gl_commands, ///< The file's strips and fans back to back, drawn
+                     ///< with one `glMultiDrawArrays` per primitive type.
+    };
+
+    /// Primitive type of a GL command.
+    enum class Primitive : std::uint32_t {
+        triangle_strip,
+        triangle_fan,
+    };
+
+    /// One GL command of a `Layout::gl_commands` model: @p count output
+    /// vertices starting at @p first, drawn as @p primitive.
+    struct Batch {
+        uint32_t first;
+        uint32_t count;
+        Primitive primitive;
+
+        friend bool operator==(Batch const&, Batch const&) = default;
+    };
+
+    /// How keyframe positions are held in memory after loading.
+    ///
+    /// `unpacked` stores a pre-scaled `vec3` per output vertex per frame,
+    /// which makes `blend()` a straight lerp. `compact` keeps only the
+    /// 4 byte quantized vertices plus per-frame scale/translate (roughly a
+    /// tenth of the size) and dequantizes the two frames on each `blend()`.
+    /// Both produce the same positions.
+    enum class Storage : std::uint8_t {
+        unpacked, ///< Float keyframes, fastest `blend()`.
+        compact,  ///< Quantized frames decoded on demand.
+    };
+
+    /// The two keyframes being blended and how far between them the
+    /// animation is. Positions are `mix(frame current, frame next, t)`.
+    struct FrameBlend {
+        int current; ///< Frame blended from.
+        int next;    ///< Frame blended towards.
+        float t;     ///< Blend factor in [0, 1).
+    };
+
+    /// @name Baked (.md2c) format
+    /// @{
+    static constexpr std::array<char, 4> baked_magic = {'M', 'D', '2', 'C'};
+    /// Bumped whenever the baked layout or the post-processing changes, so
+    /// stale caches are rebuilt rather than misread.
+    static constexpr uint32_t baked_version = 4;
+
+    /// Leading header of a `.md2c` file. Sections follow in this order, each
+    /// starting on a 4 byte boundary: vertex map (`uint16` × vertex_count),
+    /// indices (`uint16` × index_count), batches (`Batch` × batch_count),
+    /// scaled texcoords (`vec2` × vertex_count), then either the unpacked
+    /// keyframes (`vec3` × frame_count × vertex_count) or, for
+    /// `Storage::compact`, frame_count records of scale, translate, name and
+    /// `num_xyz` quantized vertices.
+    /// Skins and animations close the file as length-prefixed strings.
+    struct BakedHeader {
+        std::array<char, 4> magic;
+        uint32_t version;
+        uint64_t source_key;  ///< Identifies the source; see `ModelCache`.
+        Header md2;           ///< Header of the source file.
+        uint8_t layout;       ///< `Layout` the model was built with.
+        uint8_t storage;      ///< `Storage` the model was built with.
+        uint16_t reserved;
+        uint32_t vertex_count;
+        uint32_t index_count;
+        uint32_t frame_count;
+        uint32_t skin_count;
+        uint32_t animation_count;
+        uint32_t batch_count;
+    };
+
+    /// Tag selecting the constructor that loads a `.md2c` image.
+    struct Baked {};
+    /// @}
+
+    /// Resolved skin entry pairing a PAK-relative file path with a display
+    /// name.
+    struct SkinData {
+        std::string fpath; ///< PAK-relative path to the skin image.
+        std::string name;  ///< Display name (file stem).
+
+        SkinData(std::string fp, std::string n)
+            : fpath(std::move(fp))
+            , name(std::move(n)) {}
+    };
+
+    /// Load an MD2 model from a named entry within a PAK.
+    ///
+    /// @param filename Archive-relative path (e.g. `"models/player/tris.md2"`).
+    /// @param pak      The archive or directory to load from.
+    /// @param layout   Vertex layout to unpack the keyframes into.
+    /// @param storage  How keyframes are kept after loading.
+    /// @throws std::runtime_error if the file cannot be opened or parsed.
+    MD2Model(std::string const& filename,
+             PAK const& pak,
+             Layout layout = Layout::triangle_list,
+             Storage storage = Storage::unpacked);
+
+    /// Load an MD2 model from whichever mount of @p vfs @p filename resolves
+    /// to. Skins of a model in a directory mount are looked up across the
+    /// whole search path.
+    ///
+    /// @throws std::runtime_error if the file cannot be opened or parsed.
+    MD2Model(std::string const& filename,
+             VFS const& vfs,
+             Layout layout = Layout::triangle_list,
+             Storage storage = Storage::unpacked);
+
+    /// Parse an MD2 model from an in-memory image of the file.
+    ///
+    /// @p data is only read during construction; it may be a view into a
+    /// `MappedFile` or PAK entry that is released afterwards. Skin paths are
+    /// taken verbatim from the file's skin table.
+    ///
+    /// @param data   The complete MD2 file contents.
+    /// @param layout  Vertex layout to unpack the keyframes into.
+    /// @param storage How keyframes are kept after loading.
+    /// @throws std::runtime_error if any section lies outside @p data or the
+    ///         header is invalid.
+    explicit MD2Model(std::span<std::byte const> data,
+                      Layout layout = Layout::triangle_list,
+                      Storage storage = Storage::unpacked);
+
+    /// Parse an MD2 model from a stream by reading the file into memory
+    /// first; the size comes from the header, so the stream need not seek.
+    ///
+    /// @param is An open stream positioned at the start of MD2 data.
+    /// @throws std::runtime_error if the stream is truncated or the data
+    ///         cannot be parsed.
+    explicit MD2Model(std::istream& is,
+                      Layout layout = Layout::triangle_list,
+                      Storage storage = Storage::unpacked);
+
+    /// Load a model from a `.md2c` image written by `write_baked()`.
+    ///
+    /// Only bulk copies out of @p data; nothing is re-derived. @p data is
+    /// only read during construction.
+    ///
+    /// @throws std::runtime_error if @p data is not a complete `.md2c` image
+    ///         of `baked_version`.
+    MD2Model(Baked, std::span<std::byte const> data);
+
+    MD2Model(MD2Model const&) = delete;
+    MD2Model& operator=(MD2Model const&) = delete;
+    MD2Model(MD2Model&&) = delete;
+    MD2Model& operator=(MD2Model&&) = delete;
+
+    /// @name Accessors
+    /// @{
+    Header const& header() const { return hdr_; }
+    Layout layout() const { return layout_; }
+    Storage storage() const { return storage_; }
+    std::vector<SkinData> const& skins() const { return skins_; }
+    std::vector<Animation> const& animations() const { return animations_; }
+
+    /// Index of the animation named @p id, if there is one.
+    [[nodiscard]] std::optional<size_t>
+    find_animation(std::string const& id) const;
+
+    /// Normalised texture coordinates, one per output vertex.
+    std::vector<glm::vec2> const& scaled_texcoords() const {
+        return scaled_texcoords_;
+    }
+
+    /// Triangle list indices into the output vertices. Empty unless the
+    /// model was loaded with `Layout::indexed`.
+    std::vector<uint16_t> const& indices() const { return indices_; }
+
+    /// Strips and fans over the output vertices, in file order. Empty unless
+    /// the model was loaded with `Layout::gl_commands`.
+    std::vector<Batch> const& batches() const { return batches_; }
+
+    /// Number of output vertices per frame: `num_tris × 3` (one per triangle
+    /// corner) for `Layout::triangle_list`, the number of unique (xyz, st)
+    /// pairs for `Layout::indexed`, or the total length of every command for
+    /// `Layout::gl_commands`.
+    size_t vertex_count() const { return vertex_map_.size(); }
+
+    /// Every keyframe unpacked to world-space positions, stored frame after
+    /// frame with `vertex_count()` entries each. Uploaded once by renderers
+    /// that interpolate on the GPU. Empty with `Storage::compact`.
+    std::span<glm::vec3 const> key_frames() const { return key_frames_; }
+
+    /// Approximate number of bytes held by this model: the object itself
+    /// plus the allocated capacity of its geometry, keyframe, and animation
+    /// containers. Used to compare `Storage` modes.
+    [[nodiscard]] size_t memory_usage() const;
+    /// @}
+
+    /// Write this model as a `.md2c` image.
+    ///
+    /// @param os          Binary output stream.
+    /// @param source_key Key of the source the model was built from,
+    ///                   stored so a cache can tell when it is stale.
+    void write_baked(std::ostream& os, uint64_t source_key) const;
+
+    /// Write the world-space positions for @p frames into @p out.
+    ///
+    /// @throws gsl_lite::fail_fast if either frame is out of range or @p out
+    ///         does not hold `vertex_count()` entries.
+    void blend(FrameBlend const& frames, std::span<glm::vec3> out) const;
+
+private:
+    template <typename Source>
+    [[nodiscard]] bool load(Source const& pf, std::string const& filename);
+    [[nodiscard]] bool load(std::istream& infile);
+    [[nodiscard]] bool load(std::span<std::byte const> data);
+    [[nodiscard]] bool load_skins(std::span<std::byte const> data);
+    [[nodiscard]] bool load_triangles(std::span<std::byte const> data);
+    [[nodiscard]] bool load_texcoords(std::span<std::byte const> data);
+    [[nodiscard]] bool load_gl_commands(std::span<std::byte const> data);
+    [[nodiscard]] bool load_frames(std::span<std::byte const> data);
+    [[nodiscard]] bool load_baked(std::span<std::byte const> data);
+    void build_layout();
+    void optimize_vertex_cache();
+    [[nodiscard]] std::span<glm::vec3 const> key_frame(int index) const;
+    template <typename Source>
+    void load_skins_from_directory(Source const& pak, std::string const& dir);
+
+    Header hdr_{};
+    Layout layout_{Layout::triangle_list};
+    Storage storage_{Storage::unpacked};
+    std::vector<Triangle> triangles_;
+    std::vector<TexCoord> texcoords_;
+    std::vector<Frame> frames_; ///< Storage::compact only.
+    /// Storage::unpacked only: pre-scaled positions of every output vertex
+    /// for every frame, stored contiguously frame after frame so a frame is
+    /// a flat float range the lerp kernel can stream through.
+    std::vector<glm::vec3> key_frames_;
+    std::vector<glm::vec2> scaled_texcoords_;
+    std::vector<uint16_t> vertex_map_; ///< Output vertex → frame xyz index.
+    std::vector<uint16_t> indices_;
+    std::vector<Batch> batches_;
+    std::vector<SkinData> skins_;
+    std::vector<Animation> animations_;
+    std::unordered_map<std::string, size_t> animation_index_map_;
+};
+
+std::ostream& operator<<(std::ostream& os, MD2Model::Header const& hdr);
+std::ostream& operator<<(std::ostream& os, MD2Model::Animation const& anim);
@@ -1,16 +1,19 @@
 #pragma once
 
 #include "md2view/camera.hpp"
+#include "md2view/frame_profiler.hpp"
 #include "md2view/gl/frame_buffer.hpp"
 #include "md2view/gl/mesh.hpp"
 #include "md2view/gl/screen_quad.hpp"
 #include "md2view/gl/texture2d.hpp"
-#include "md2view/md2.hpp"
+#include "md2view/md2_instance.hpp"
 #include "md2view/model_selector.hpp"
+#include "md2view/resource_manager.hpp"
 
 #include <glm/glm.hpp>
 
 #include <memory>
+#include <optional>
 #include <string>
 
 namespace GL {
@@ -26,8 +29,16 @@ public:
     void on_mouse_movement(GLfloat xoffset, GLfloat yoffset);
     void on_mouse_scroll(double xoffset, double yoffset);
     void on_framebuffer_resized(int width, int height);
-    void update(GL::Engine<MD2View>& engine, GLfloat delta_time);
+    /// Move the animation forward by one fixed step of @p delta_time
+    /// seconds. May run several times, or not at all, per drawn frame.
+    void advance(GL::Engine<MD2View>& engine, GLfloat delta_time);
+    /// Once per drawn frame, before `render()`: finish pending loads and
+    /// blend the animation's current state into the mesh.
+    void update(GL::Engine<MD2View>& engine);
     void render(GL::Engine<MD2View>& engine);
+    /// True when another frame would draw the same image: no model is
+    /// loading, the camera has not moved and the model is not animating.
+    [[nodiscard]] bool idle() const;
     static char const* title() { return "MD2View"; }
 
 private:
@@ -36,10 +47,34 @@ private:
     void load_current_texture(GL::Engine<MD2View>& engine);
     void update_model();
     void draw_ui(GL::Engine<MD2View>& engine);
+    template <typename T> static void draw_cache_ui(LruCache<T> const& cache);
     void set_vsync() const;
     void load_model(GL::Engine<MD2View>& engine);
+    void install_model(std::shared_ptr<MD2Model const> model_data);
+    void set_texture(std::shared_ptr<GL::Texture2D> texture);
+    void poll_pending_model(GL::Engine<MD2View>& engine);
+    [[nodiscard]] bool gpu_morph_active() const;
+    void set_morph_uniforms() const;
 
-    std::shared_ptr<MD2> md2_;
+    /// A model selected in the UI that is still loading. The skin load
+    /// starts once the model is parsed and its skin names are known.
+    struct PendingModel {
+        ResourceManager::Future<MD2Model const> model;
+        ResourceManager::Future<GL::Texture2D> texture;
+    };
+
+    /// Profiler stages of a frame, in the order they run.
+    struct Stages {
+        FrameProfiler::StageId uploads{};
+        FrameProfiler::StageId animate{};
+        FrameProfiler::StageId sync{};
+        FrameProfiler::StageId main_pass{};
+        FrameProfiler::StageId post{};
+        FrameProfiler::StageId ui{};
+    };
+
+    std::unique_ptr<MD2Instance> md2_;
+    std::optional<PendingModel> pending_;
     std::unique_ptr<GL::Mesh> md2_mesh_;
     std::unique_ptr<ModelSelector> model_selector_;
     std::shared_ptr<GL::Texture2D> texture_;
@@ -50,6 +85,7 @@ private:
     std::unique_ptr<GL::FrameBuffer> blur_fb_;
     std::unique_ptr<GL::FrameBuffer> main_fb_;
 
+    Stages stages_;
     Camera camera_;
     std::string models_dir_;
     bool vsync_enabled_ = true;
@@ -64,4 +100,10 @@ private:
     bool glow_ = false;
     glm::vec3 glow_color_{};
     GLint glow_loc_{};
+    GLint indexed_loc_{};
+    bool gpu_morph_ = true;
+    GLint morph_loc_{};
+    GLint current_frame_offset_loc_{};
+    GLint next_frame_offset_loc_{};
+    GLint blend_loc_{};
 };
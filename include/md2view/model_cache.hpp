@@ -0,0 +1,84 @@
+#pragma once
+
+#include "md2view/md2_model.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+class VFS;
+
+/// Directory of baked `.md2c` models (see `MD2Model::write_baked()`).
+///
+/// Each file is named after a hash of the path of the mount the entry
+/// resolves to, the entry name and the layout and storage it was built
+/// with, and records the `source_key()` of what the model was built from.
+/// `load()` memory-maps a matching file and constructs the model straight
+/// from it; a missing, stale or unreadable file is replaced by parsing the
+/// MD2 and baking it again. Cache failures never fail a load.
+///
+/// Holds no mutable state, so `load()` may run on several threads at once.
+/// Files are written under a temporary name and renamed into place, so a
+/// reader never sees a partial one.
+class ModelCache {
+public:
+    /// Cache file extension.
+    static constexpr char const* extension = ".md2c";
+
+    /// @param dir Directory the cache files live in; created on first write.
+    explicit ModelCache(std::filesystem::path dir);
+
+    [[nodiscard]] std::filesystem::path const& dir() const { return dir_; }
+
+    /// Path of the cache file for @p entry of @p vfs.
+    /// @throws gsl_lite::fail_fast if @p entry is not in @p vfs.
+    [[nodiscard]] std::filesystem::path path(VFS const& vfs,
+                                             std::string const& entry,
+                                             MD2Model::Layout layout,
+                                             MD2Model::Storage storage) const;
+
+    /// Cheap key that changes whenever the model for @p entry of @p vfs
+    /// would: the entry's position and size and the archive's modification
+    /// time for a PAK entry, or the file's size and modification time for a
+    /// loose file. A loose file's skins are looked up next to it, so its key
+    /// also covers the paths in its directory, as indexed by @p vfs, and
+    /// adding, removing or converting a skin makes the cache file stale.
+    /// Only file metadata is read, never the MD2 itself.
+    ///
+    /// @throws gsl_lite::fail_fast if @p entry is not in @p vfs.
+    [[nodiscard]] static uint64_t source_key(VFS const& vfs,
+                                             std::string const& entry);
+
+    /// Load @p entry of @p vfs, from its cache file if that is up to date,
+    /// otherwise by parsing it and baking the result.
+    ///
+    /// @throws std::runtime_error if the MD2 itself cannot be parsed.
+    [[nodiscard]] std::shared_ptr<MD2Model const>
+    load(VFS const& vfs,
+         std::string const& entry,
+         MD2Model::Layout layout,
+         MD2Model::Storage storage) const;
+
+    /// Make sure @p entry of @p vfs has an up to date cache file.
+    ///
+    /// @return True if a file was written, false if it was already current.
+    /// @throws std::runtime_error if the MD2 cannot be parsed or the file
+    ///         cannot be written.
+    bool bake(VFS const& vfs,
+              std::string const& entry,
+              MD2Model::Layout layout,
+              MD2Model::Storage storage) const;
+
+private:
+    [[nodiscard]] static std::shared_ptr<MD2Model const>
+    read(std::filesystem::path const& path,
+         uint64_t key,
+         MD2Model::Layout layout,
+         MD2Model::Storage storage);
+    void write(std::filesystem::path const& path,
+               MD2Model const& model,
+               uint64_t key) const;
+
+    std::filesystem::path dir_;
+};
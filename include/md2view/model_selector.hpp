@@ -1,17 +1,28 @@
 #pragma once
 
-#include <treehh/tree.hh>
+#include "md2view/model_tree.hpp"
 
-#include <filesystem>
+#include <array>
+#include <cstdint>
 #include <random>
+#include <string>
 
-class PAK;
+class VFS;
 
+/// ImGui browser over the models of a `VFS`.
+///
+/// The models are arranged in a `ModelTree` once, at construction. Each frame
+/// only the rows scrolled into view are submitted to ImGui (through
+/// `ImGuiListClipper`), and a filter box narrows the list to models whose
+/// path contains the typed text.
 class ModelSelector {
 public:
-    ModelSelector(PAK const& pak)
+    /// Height of the model list, in rows.
+    static constexpr int list_rows = 16;
+
+    ModelSelector(VFS const& vfs)
         : mt_(std::random_device{}()) {
-        init(pak);
+        init(vfs);
     }
 
     ~ModelSelector() = default;
@@ -29,15 +40,10 @@ public:
     void select_random_model();
 
 private:
-    struct Node {
-        std::string name;
-        std::string path;
-    };
-
-    void init(PAK const& pak);
-    void add_node(std::filesystem::path const& path);
+    void init(VFS const& vfs);
 
     std::mt19937 mt_;
-    tree<Node> tree_;
-    tree<Node>::iterator selected_;
+    ModelTree tree_;
+    uint32_t selected_{ModelTree::npos};
+    std::array<char, 128> filter_{};
 };
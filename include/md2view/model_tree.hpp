@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/// Directory tree of model paths behind `ModelSelector`, kept free of GL and
+/// ImGui so it can be tested on its own.
+///
+/// Nodes live in one flat vector and refer to each other by index. Adding a
+/// path looks each prefix up in a hash map of every node's path, so building
+/// the tree of N models is O(N) rather than a scan per path component.
+///
+/// The UI draws `rows()`, the nodes currently visible as a flat list: a
+/// depth-first walk that only descends into expanded directories, or, while
+/// a filter is set, every model whose path contains it. The list is rebuilt
+/// only when the expansion state or the filter changes, so a UI that draws
+/// just the rows in view costs the same whatever the tree size. Filtering is
+/// a case-insensitive substring match against lower-cased paths computed
+/// once as models are added.
+class ModelTree {
+public:
+    static constexpr uint32_t npos = UINT32_MAX;
+
+    /// Index of the root node.
+    static constexpr uint32_t root = 0;
+
+    struct Node {
+        std::string name; ///< Last path component, or the root's label.
+        std::string path; ///< Full `/` separated path; empty for the root.
+        uint32_t parent{npos};
+        uint32_t depth{};
+        std::vector<uint32_t> children; ///< In the order they were added.
+        bool expanded{false};
+    };
+
+    /// A tree holding only the root, labelled @p root_name and expanded.
+    explicit ModelTree(std::string root_name = {});
+
+    /// Add model @p path and any directories above it that are missing.
+    /// Adding a path already present does nothing.
+    ///
+    /// @return Index of the model's node.
+    uint32_t add(std::string_view path);
+
+    /// Number of nodes, the root and directories included.
+    [[nodiscard]] size_t size() const { return nodes_.size(); }
+
+    [[nodiscard]] Node const& node(uint32_t index) const {
+        return nodes_[index];
+    }
+
+    [[nodiscard]] bool is_leaf(uint32_t index) const {
+        return nodes_[index].children.empty();
+    }
+
+    /// Every model node, in the order added.
+    [[nodiscard]] std::span<uint32_t const> leaves() const { return leaves_; }
+
+    /// Index of the node at @p path, or `npos`.
+    [[nodiscard]] uint32_t find(std::string_view path) const;
+
+    /// Expand or collapse directory @p index.
+    void set_expanded(uint32_t index, bool expanded);
+
+    /// Expand every directory above @p index, so it shows in `rows()`.
+    void reveal(uint32_t index);
+
+    /// Show only models whose path contains @p filter, ignoring case. An
+    /// empty filter shows the tree again.
+    void set_filter(std::string_view filter);
+
+    [[nodiscard]] std::string const& filter() const { return filter_; }
+
+    /// Indices of the visible nodes, top to bottom. Valid until the next
+    /// call to a non-const member.
+    [[nodiscard]] std::span<uint32_t const> rows();
+
+private:
+    struct StringHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view str) const {
+            return std::hash<std::string_view>{}(str);
+        }
+    };
+
+    uint32_t add_child(uint32_t parent,
+                       std::string_view name,
+                       std::string_view path);
+    void build_rows();
+
+    std::vector<Node> nodes_;
+    /// Path → index into `nodes_`.
+    std::unordered_map<std::string, uint32_t, StringHash, std::equal_to<>>
+        by_path_;
+    std::vector<uint32_t> leaves_;
+    /// Lower-cased path of each of `leaves_`.
+    std::vector<std::string> search_paths_;
+    std::string filter_;
+    std::vector<uint32_t> rows_;
+    bool rows_dirty_{true};
+};
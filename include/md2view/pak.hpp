@@ -1,13 +1,22 @@
 #pragma once
 
-#include <boost/algorithm/string/predicate.hpp>
+#include "md2view/mapped_file.hpp"
+#include "md2view/span_stream.hpp"
 
+#include <cstddef>
 #include <cstdint>
 #include <filesystem>
-#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <ranges>
+#include <span>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 /// Quake II PAK archive reader.
 ///
@@ -17,26 +26,55 @@
 /// - **Directory mode**: treats a plain filesystem directory as though it were
 ///   a PAK file, enabling development without a real archive.
 ///
-/// Callers use the same `open_ifstream()` interface in both modes.
+/// Callers use the same `view()` / `open_ifstream()` interface in both modes.
+/// In archive mode the `.pak` is memory-mapped once at construction and every
+/// entry is a sub-span of that mapping. In directory mode a file is mapped
+/// when it is viewed and unmapped once the last view of it is dropped, so
+/// browsing a large tree does not pile up mappings; views of a file that
+/// overlap in time share one mapping.
+///
+/// The directory is indexed once at construction: every entry path is
+/// interned in one string arena and the entries are sorted by path, so
+/// `find()` is a binary search, `prefix()` and `directory()` are contiguous
+/// ranges, and `with_extension()` (and with it `models()`) reads a list
+/// built during indexing instead of scanning every entry.
+///
+/// A directory is walked breadth first, each level's directories listed in
+/// parallel on a thread pool, with file types taken from the directory
+/// entries rather than extra stat calls. Given an index cache directory, the
+/// finished index is saved there together with the modification time of
+/// every directory walked; the next PAK of the same directory loads it and
+/// only stats the directories. Adding, removing or renaming a file changes
+/// its directory's time and so forces a new walk. Rewriting a file in place
+/// does not, but entries are mapped whole when viewed, so only the recorded
+/// `filelen` goes stale.
 ///
 /// @see https://quakewiki.org/wiki/.pak
 class PAK {
 public:
-    /// A single entry in the archive directory.
+    /// A single entry in the archive directory. The views point into the
+    /// PAK and stay valid for its lifetime.
     struct Node {
-        std::string name;  ///< Entry name (key used for lookup).
-        std::string path;  ///< Full path or archive-relative path.
-        int32_t filepos{}; ///< Byte offset within the `.pak` file (archive mode
-                           ///< only).
+        std::string_view name; ///< File stem (e.g. `"tris"`).
+        std::string_view path; ///< Archive-relative path, `/` separated.
+        int32_t filepos{};   ///< Byte offset within the `.pak` file (archive
+                             ///< mode only).
         uintmax_t filelen{}; ///< Entry size in bytes.
     };
 
+    /// Extension of the saved directory indexes.
+    static constexpr char const* index_extension = ".pakidx";
+
     /// Construct a PAK from a file or directory path.
     ///
     /// @param fpath Path to a `.pak` file or a directory to treat as one.
+    /// @param index_cache_dir Directory to save and reuse directory-mode
+    ///        indexes in; created on first write. Ignored for `.pak` files.
     /// @throws std::runtime_error if @p fpath does not exist or the archive
     ///         header has an invalid magic number.
-    explicit PAK(std::filesystem::path fpath);
+    explicit PAK(std::filesystem::path fpath,
+                 std::optional<std::filesystem::path> const& index_cache_dir =
+                     std::nullopt);
 
     /// Path that was used to construct this PAK.
     std::filesystem::path const& fpath() const noexcept { return fpath_; }
@@ -46,35 +84,163 @@ public:
         return fpath_.extension() != ".pak";
     }
 
+    /// Number of indexed entries.
+    [[nodiscard]] size_t size() const noexcept { return records_.size(); }
+
+    /// Returns true if the index was loaded from the index cache instead of
+    /// walking the directory.
+    [[nodiscard]] bool index_cached() const noexcept { return index_cached_; }
+
+    /// Returns true if @p fpath names an entry of this PAK. In directory mode
+    /// files created after indexing count too.
+    [[nodiscard]] bool contains(std::filesystem::path const& fpath) const;
+
+    /// The indexed entry at @p fpath, found by binary search.
+    [[nodiscard]] std::optional<Node> find(std::string_view fpath) const;
+
+    /// The bytes of a named entry.
+    ///
+    /// Archive entries stay valid for the lifetime of the PAK; a directory
+    /// entry owns its mapping and stays valid for as long as the returned
+    /// object. Safe to call concurrently.
+    ///
+    /// @param fpath Archive-relative path of the entry (e.g.
+    /// `"models/player/tris.md2"`).
+    /// @throws gsl_lite::fail_fast if the entry does not exist.
+    [[nodiscard]] MappedBytes view(std::filesystem::path const& fpath) const;
+
     /// Open a read stream for a named entry.
     ///
-    /// In archive mode the stream is positioned at the entry's data. In
-    /// directory mode it opens the corresponding file from the filesystem.
+    /// The stream reads directly from `view()` and is bounded to the entry:
+    /// it reports end-of-file at the end of the entry rather than running on
+    /// into the rest of the archive.
     ///
     /// @param fpath Archive-relative path of the entry (e.g.
     /// `"models/player/tris.md2"`).
-    /// @return An open `std::ifstream` positioned at the start of the entry.
-    std::ifstream open_ifstream(std::filesystem::path const& fpath) const;
-
-    /// Lazy range of all `.md2` model entries in the archive.
-    auto models() const {
-        return entries() | std::ranges::views::values |
-               std::ranges::views::filter([](auto const& n) {
-                   return boost::algorithm::ends_with(n.path, ".md2");
-               });
-    }
+    /// @return A stream positioned at the start of the entry, or a stream
+    ///         that is not open if the entry does not exist.
+    SpanStream open_ifstream(std::filesystem::path const& fpath) const;
+
+    /// Every entry, sorted by path.
+    [[nodiscard]] auto entries() const;
+
+    /// Entries whose path starts with @p path_prefix, sorted by path.
+    [[nodiscard]] auto prefix(std::string_view path_prefix) const;
+
+    /// Entries directly inside directory @p dir (e.g. `"models/player"`),
+    /// not in its subdirectories, sorted by path. An empty @p dir lists the
+    /// top level.
+    [[nodiscard]] auto directory(std::string_view dir) const;
+
+    /// Entries whose file extension is exactly @p extension (e.g. `".pcx"`),
+    /// sorted by path.
+    [[nodiscard]] auto with_extension(std::string_view extension) const;
+
+    /// All `.md2` model entries, sorted by path.
+    [[nodiscard]] auto models() const;
 
     /// Returns true if the archive contains at least one `.md2` entry.
-    [[nodiscard]] bool has_models() const noexcept { return !models().empty(); }
+    [[nodiscard]] bool has_models() const noexcept;
 
 private:
-    [[nodiscard]] bool init();
+    /// An indexed entry. The path is `paths_[path_offset, +path_size)` and
+    /// the stem a sub-range of it.
+    struct Record {
+        uint32_t path_offset;
+        uint32_t path_size;
+        uint32_t name_offset; ///< Relative to the path.
+        uint32_t name_size;
+        int32_t filepos;
+        uintmax_t filelen;
+    };
+
+    /// A directory walked in directory mode and its modification time, in
+    /// `file_time_type` ticks. The root is the empty path.
+    struct DirStamp {
+        std::string path;
+        int64_t mtime;
+    };
+
+    [[nodiscard]] bool
+    init(std::optional<std::filesystem::path> const& index_cache_dir);
     [[nodiscard]] bool init_from_file();
-    void init_from_directory();
-    std::unordered_map<std::string, Node> const& entries() const {
-        return entries_;
+    void init_from_directory(
+        std::optional<std::filesystem::path> const& index_cache_dir);
+    [[nodiscard]] std::vector<DirStamp> walk_directory();
+    [[nodiscard]] std::filesystem::path
+    index_cache_path(std::filesystem::path const& dir) const;
+    [[nodiscard]] bool read_index_cache(std::filesystem::path const& path);
+    void write_index_cache(std::filesystem::path const& path,
+                           std::vector<DirStamp> const& dirs) const;
+    void add_entry(std::string_view path, int32_t filepos, uintmax_t filelen);
+    void build_index();
+    void index_extensions();
+
+    [[nodiscard]] std::string_view path(Record const& record) const {
+        return std::string_view{paths_}.substr(record.path_offset,
+                                               record.path_size);
     }
+    [[nodiscard]] Node node(Record const& record) const {
+        auto const full = path(record);
+        return {full.substr(record.name_offset, record.name_size), full,
+                record.filepos, record.filelen};
+    }
+    [[nodiscard]] auto nodes(std::span<Record const> records) const;
+    [[nodiscard]] std::span<Record const>
+    prefix_range(std::string_view path_prefix) const;
+    [[nodiscard]] std::span<Record const>
+    directory_range(std::string_view dir) const;
 
     std::filesystem::path fpath_;
-    std::unordered_map<std::string, Node> entries_;
+    /// Every entry path back to back.
+    std::string paths_;
+    /// Sorted by path, one per unique path.
+    std::vector<Record> records_;
+    /// Extension (with the dot) → indices into `records_`, in path order.
+    std::map<std::string, std::vector<uint32_t>, std::less<>> by_extension_;
+    bool index_cached_{false};
+    MappedFile archive_;
+    mutable std::mutex mapped_mutex_;
+    /// Directory-mode files with a view outstanding.
+    mutable std::unordered_map<std::string, std::weak_ptr<MappedFile const>>
+        mapped_;
 };
+
+// The range-returning queries are defined here, after the class, so their
+// deduced return types are known wherever they are used.
+
+inline auto PAK::nodes(std::span<Record const> records) const {
+    return records | std::views::transform([this](Record const& record) {
+               return node(record);
+           });
+}
+
+inline auto PAK::entries() const { return nodes(records_); }
+
+inline auto PAK::prefix(std::string_view path_prefix) const {
+    return nodes(prefix_range(path_prefix));
+}
+
+inline auto PAK::directory(std::string_view dir) const {
+    auto const start =
+        dir.empty() || dir.ends_with('/') ? dir.size() : dir.size() + 1;
+    return nodes(directory_range(dir)) |
+           std::views::filter([start](Node const& node) {
+               return node.path.find('/', start) == std::string_view::npos;
+           });
+}
+
+inline auto PAK::with_extension(std::string_view extension) const {
+    std::span<uint32_t const> indices;
+    if (auto const iter = by_extension_.find(extension);
+        iter != by_extension_.end()) {
+        indices = iter->second;
+    }
+    return indices | std::views::transform([this](uint32_t index) {
+               return node(records_[index]);
+           });
+}
+
+inline auto PAK::models() const { return with_extension(".md2"); }
+
+inline bool PAK::has_models() const noexcept { return !models().empty(); }
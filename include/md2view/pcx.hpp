@@ -1,19 +1,31 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <iosfwd>
+#include <span>
+#include <utility>
 #include <vector>
 
 /// PCX image decoder.
 ///
-/// Decodes a PCX image from a stream into a flat RGB pixel buffer. Only the
-/// 8-bit indexed variant (256-colour VGA palette) is supported, which covers
-/// all Quake II skin textures.
+/// Decodes a PCX image into a flat RGB pixel buffer. Only the 8-bit indexed
+/// variant (256-colour VGA palette) is supported, which covers all Quake II
+/// skin textures.
+///
+/// Decoding works on the whole file in memory, usually a span straight out
+/// of a `PAK`: the RLE scan lines are expanded in one pass into a
+/// width x height plane of palette indices, then every index is looked up in
+/// a 256-entry RGB table to produce `image()`. There is no per-row
+/// allocation and no per-byte stream call.
 ///
 /// After construction, `image()` contains the decoded pixels as packed RGB
-/// triples (3 bytes per pixel, row-major) and `colors()` contains the full
-/// 256-entry palette.
+/// triples (3 bytes per pixel, row-major), `indices()` the palette index of
+/// each pixel, and `colors()` the palette read from the file. Decoding with
+/// `Pixels::indexed` skips the RGB expansion and leaves `image()` empty, for
+/// callers that upload `indices()` and `palette()` and look colours up on
+/// the GPU.
 ///
 /// @see https://www.fileformat.info/format/pcx/egff.htm
 class PCX {
@@ -56,10 +68,31 @@ public:
             , b(_b) {}
     };
 
+    /// Which pixel planes a decode produces.
+    enum class Pixels : uint8_t {
+        rgb,     ///< `indices()` and the expanded RGB `image()`.
+        indexed, ///< `indices()` only; `image()` stays empty.
+    };
+
+    /// Number of entries in a VGA palette.
+    static constexpr size_t palette_size = 256;
+
     /// Construct an empty PCX with no image data.
     PCX() = default;
 
-    /// Decode a PCX image from a stream.
+    /// Decode a PCX image from an in-memory image of the file.
+    ///
+    /// Runs that overflow a scan line are clipped to it and truncated data
+    /// decodes as palette index 0, as a stream reader running out of input
+    /// would.
+    /// @param data   The whole PCX file.
+    /// @param pixels Whether to also expand the indices to RGB.
+    /// @throws gsl_lite::fail_fast if @p data is shorter than a header or
+    ///         the header has no pixels.
+    explicit PCX(std::span<std::byte const> data, Pixels pixels = Pixels::rgb);
+
+    /// Decode a PCX image from a stream by reading the rest of it into
+    /// memory first.
     ///
     /// @param is An open, readable stream positioned at the start of PCX data.
     /// @throws gsl_lite::fail_fast if the stream is not in a good state.
@@ -71,18 +104,37 @@ public:
         return image_;
     }
 
+    /// Move the RGB pixels out, leaving `image()` empty.
+    [[nodiscard]] std::vector<unsigned char> take_image() {
+        return std::move(image_);
+    }
+
+    /// Palette index of each pixel, row-major. Size is
+    /// `width() * height()` bytes.
+    [[nodiscard]] std::vector<uint8_t> const& indices() const {
+        return indices_;
+    }
+
+    /// Move the palette indices out, leaving `indices()` empty.
+    [[nodiscard]] std::vector<uint8_t> take_indices() {
+        return std::move(indices_);
+    }
+
     /// The 256-entry VGA palette decoded from the end of the file.
     [[nodiscard]] std::vector<Color> const& colors() const { return colors_; }
 
+    /// `colors()` as `palette_size` packed RGB triples, ready to upload as a
+    /// 256x1 texture. Entries missing from the file are black.
+    [[nodiscard]] std::vector<unsigned char> palette() const;
+
     [[nodiscard]] int height() const { return height_; }
     [[nodiscard]] int width() const { return width_; }
 
 private:
-    using ScanLine = std::vector<uint8_t>;
-    static ScanLine read_scan_line(std::istream& ds, int32_t length);
-    static std::vector<Color> read_palette(std::istream& is);
+    static std::vector<std::byte> read_all(std::istream& is);
 
     std::vector<unsigned char> image_;
+    std::vector<uint8_t> indices_;
     std::vector<Color> colors_;
     int width_{};
     int height_{};
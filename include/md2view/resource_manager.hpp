@@ -2,30 +2,66 @@
 
 #include "md2view/gl/shader.hpp"
 #include "md2view/gl/texture2d.hpp"
-#include "md2view/md2.hpp"
-#include "md2view/pak.hpp"
+#include "md2view/lru_cache.hpp"
+#include "md2view/md2_model.hpp"
+#include "md2view/model_cache.hpp"
+#include "md2view/vfs.hpp"
+#include "md2view/thread_pool.hpp"
 
+#include <chrono>
+#include <deque>
 #include <filesystem>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <vector>
 
-/// Cache and factory for GPU resources loaded from a PAK archive.
+/// Cache and factory for GPU resources loaded from the game data.
 ///
-/// Owns the active PAK and caches loaded shaders, textures, and models by
+/// Owns the `VFS` the data is read from and caches loaded shaders, textures, and models by
 /// their path strings. Repeated calls for the same path return the cached
 /// instance without re-reading from disk or re-uploading to the GPU.
+///
+/// The model and texture caches are `LruCache`s with separate byte budgets
+/// (`MD2Model::memory_usage()` and `GL::Texture2D::gpu_bytes()`), unlimited
+/// by default. Over budget, the least recently used entries nobody else
+/// holds a `shared_ptr` to are dropped. Shaders are few and never evicted.
+///
+/// Models and textures can also be loaded asynchronously. The `_async`
+/// loaders parse MD2 files and decode images on a small loader pool and hand
+/// back a `std::shared_future`; texture uploads, which need the GL context,
+/// are queued and run by `process_uploads()` on the GL thread within a
+/// per-call time budget. Finished loads join the same caches as synchronous
+/// ones.
+///
+/// With `set_baked_model_dir()`, models are read through a `ModelCache`, so
+/// each one is parsed once and loaded from its baked `.md2c` file after
+/// that.
 class ResourceManager {
 public:
-    /// @param rootdir  Project data root (shaders are expected at
+    template <typename T> using Future = std::shared_future<std::shared_ptr<T>>;
+
+    /// Threads in the loader pool.
+    static constexpr size_t loader_workers = 2;
+
+    /// Default time `process_uploads()` may spend per call.
+    static constexpr std::chrono::microseconds default_upload_budget{2000};
+
+    /// @param rootdir     Project data root (shaders are expected at
     /// `rootdir/shaders/`).
-    /// @param pak_path Path to a `.pak` file or directory. Defaults to
-    /// `rootdir/models`.
+    /// @param search_path `.pak` files and directories to mount, lowest
+    /// priority first. Defaults to `rootdir/models`.
+    /// @param index_cache_dir Directory to save directory mount indexes in;
+    /// see `PAK`.
     explicit ResourceManager(
         std::filesystem::path const& rootdir,
-        std::optional<std::filesystem::path> const& pak_path = std::nullopt);
+        std::vector<std::filesystem::path> const& search_path = {},
+        std::optional<std::filesystem::path> const& index_cache_dir =
+            std::nullopt);
 
     [[nodiscard]] std::filesystem::path const& root_dir() const {
         return root_dir_;
@@ -34,10 +70,7 @@ public:
         return shaders_dir_;
     }
 
-    PAK& pak() {
-        gsl_Assert(pak_);
-        return *pak_;
-    }
+    [[nodiscard]] VFS const& vfs() const { return vfs_; }
 
     /// Compile and cache a shader program.
     ///
@@ -60,28 +93,136 @@ public:
         return shaders_.at(name);
     }
 
-    /// Load and cache a texture from the active PAK.
+    /// Load and cache a texture from the search path.
     ///
     /// If @p name is provided it is used as the cache key; otherwise @p path
-    /// is. Returns the cached instance if already loaded.
+    /// is. Returns the cached instance if already loaded. PCX images are
+    /// kept palette-indexed if `set_indexed_skins()` is on.
     std::shared_ptr<GL::Texture2D>
     load_texture2D(std::string const& path,
                    std::optional<std::string> const& name = {});
 
+    /// Decode a texture on the loader pool and upload it in a later
+    /// `process_uploads()`.
+    ///
+    /// The future is ready once the texture is on the GPU, or holds the
+    /// decode error. A cached @p path gives a ready future, and a @p path
+    /// already in flight gives the pending one.
+    Future<GL::Texture2D> load_texture2D_async(std::string const& path);
+
+    /// A cached texture by key.
+    /// @throws std::out_of_range if @p name is not cached.
     std::shared_ptr<GL::Texture2D> texture2D(std::string const& name) {
         return textures2D_.at(name);
     }
 
-    /// Load and cache an MD2 model from the active PAK.
+    /// Load and cache an MD2 model from the search path.
+    ///
+    /// Models are loaded with the vertex layout set by `set_model_layout()`
+    /// and the keyframe storage set by `set_model_storage()`. Returns the
+    /// cached model if @p path was already loaded. The model is immutable;
+    /// callers animate it through their own `MD2Instance`s.
+    std::shared_ptr<MD2Model const> load_model(std::string const& path);
+
+    /// Parse a model on the loader pool, as `load_model()` would.
     ///
-    /// Returns the cached instance if @p path was already loaded.
-    std::shared_ptr<MD2> load_model(std::string const& path);
+    /// The future is ready as soon as the worker finishes, and the model
+    /// joins the cache on the next `process_uploads()`. A cached @p path
+    /// gives a ready future, and a @p path already in flight gives the
+    /// pending one.
+    Future<MD2Model const> load_model_async(std::string const& path);
+
+    /// Run queued texture uploads on the calling thread, which must own the
+    /// GL context, until @p budget is spent, and move finished async loads
+    /// into the caches. At least one upload runs per call so a single large
+    /// texture cannot stall the queue.
+    ///
+    /// @return The number of textures uploaded.
+    size_t
+    process_uploads(std::chrono::microseconds budget = default_upload_budget);
+
+    /// Byte budget for cached models, evicting at once if over it.
+    void set_model_budget(size_t bytes) { models_.set_budget(bytes); }
+
+    /// Byte budget for cached textures' GPU memory, evicting at once if over
+    /// it.
+    void set_texture_budget(size_t bytes) { textures2D_.set_budget(bytes); }
+
+    [[nodiscard]] LruCache<MD2Model const> const& model_cache() const {
+        return models_;
+    }
+    [[nodiscard]] LruCache<GL::Texture2D> const& texture_cache() const {
+        return textures2D_;
+    }
+
+    /// True while async loads are decoding or waiting for upload.
+    [[nodiscard]] bool loading() const {
+        return !pending_models_.empty() || !pending_textures_.empty();
+    }
+
+    /// Vertex layout used for models loaded after this call. Defaults to
+    /// `MD2Model::Layout::indexed`, drawn with `glDrawElements`;
+    /// `MD2Model::Layout::gl_commands` draws the models' own strips and fans
+    /// instead.
+    void set_model_layout(MD2Model::Layout layout) { model_layout_ = layout; }
+
+    /// Keyframe storage used for models loaded after this call. Defaults to
+    /// `MD2Model::Storage::unpacked`.
+    void set_model_storage(MD2Model::Storage storage) {
+        model_storage_ = storage;
+    }
+
+    /// Load PCX textures loaded after this call as an index texture plus
+    /// palette (see `GL::Texture2D`) instead of expanded RGB. Defaults to
+    /// off.
+    void set_indexed_skins(bool indexed) { indexed_skins_ = indexed; }
+
+    /// Load models loaded after this call through a `ModelCache` in @p dir,
+    /// or parse every model afresh if @p dir is empty. Defaults to empty.
+    void set_baked_model_dir(std::optional<std::filesystem::path> const& dir) {
+        baked_models_ = dir ? std::optional<ModelCache>{*dir} : std::nullopt;
+    }
 
 private:
+    /// A decoded texture waiting for `process_uploads()`.
+    struct Upload {
+        std::string key;
+        GL::Texture2D::Image image;
+        std::shared_ptr<std::promise<std::shared_ptr<GL::Texture2D>>> promise;
+    };
+
+    template <typename T> static void log_stats(LruCache<T> const& cache);
+
+    /// Parse @p path, or load it from @p baked if given. Called from the
+    /// loader pool, so it only uses its arguments.
+    static std::shared_ptr<MD2Model const>
+    read_model(VFS const& vfs,
+               std::string const& path,
+               MD2Model::Layout layout,
+               MD2Model::Storage storage,
+               std::optional<ModelCache> const& baked);
+
     std::filesystem::path root_dir_;
     std::filesystem::path shaders_dir_;
-    std::unique_ptr<PAK> pak_;
+    VFS vfs_;
+    MD2Model::Layout model_layout_{MD2Model::Layout::indexed};
+    MD2Model::Storage model_storage_{MD2Model::Storage::unpacked};
+    bool indexed_skins_{false};
+    std::optional<ModelCache> baked_models_;
     std::unordered_map<std::string, std::shared_ptr<GL::Shader>> shaders_;
-    std::unordered_map<std::string, std::shared_ptr<GL::Texture2D>> textures2D_;
-    std::unordered_map<std::string, std::shared_ptr<MD2>> models_;
+    LruCache<GL::Texture2D> textures2D_{"texture"};
+    LruCache<MD2Model const> models_{"model"};
+    std::unordered_map<std::string, Future<MD2Model const>> pending_models_;
+    std::unordered_map<std::string, Future<GL::Texture2D>> pending_textures_;
+    std::mutex uploads_mutex_;
+    std::deque<Upload> uploads_;
+    // last so it is joined before anything its tasks use is destroyed
+    std::unique_ptr<ThreadPool> loader_;
 };
+
+/// True if @p future holds a value or an exception, without blocking.
+template <typename T>
+[[nodiscard]] bool is_ready(std::shared_future<T> const& future) {
+    return future.wait_for(std::chrono::seconds{0}) ==
+           std::future_status::ready;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+/// Vectorised linear interpolation of float arrays.
+///
+/// The keyframe blend in `MD2Model::blend()` is a single
+/// `out[i] = a[i] * (1 - t) + b[i] * t` over every float of two frames, so it
+/// is written once here against flat arrays and dispatched at runtime to the
+/// widest instruction set the CPU supports. Every kernel evaluates the same
+/// expression as `glm::mix` (two multiplies and an add, no fused
+/// multiply-add) so they agree with each other and with the scalar
+/// `glm::lerp` path up to compiler contraction of the scalar tail.
+namespace SIMD {
+
+/// Instruction set used by a lerp kernel.
+enum class Kernel : std::uint8_t {
+    scalar, ///< Portable loop; always available.
+    sse,    ///< 4 floats per iteration (x86 only).
+    avx,    ///< 8 floats per iteration (x86 with AVX, checked at runtime).
+};
+
+/// True if @p kernel can run on this CPU.
+[[nodiscard]] bool supported(Kernel kernel);
+
+/// The widest supported kernel; this is what `lerp()` dispatches to.
+[[nodiscard]] Kernel best_kernel();
+
+/// Human readable kernel name for logging.
+[[nodiscard]] char const* name(Kernel kernel);
+
+/// `out[i] = a[i] * (1 - t) + b[i] * t` using `best_kernel()`.
+///
+/// @throws gsl_lite::fail_fast unless @p a, @p b and @p out are the same
+///         size.
+void lerp(std::span<float const> a,
+          std::span<float const> b,
+          float t,
+          std::span<float> out);
+
+/// As above but with an explicit kernel, used to test kernels against each
+/// other.
+///
+/// @throws gsl_lite::fail_fast if @p kernel is not `supported()`.
+void lerp(Kernel kernel,
+          std::span<float const> a,
+          std::span<float const> b,
+          float t,
+          std::span<float> out);
+
+} // namespace SIMD
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <memory>
+#include <span>
+#include <streambuf>
+#include <utility>
+
+/// Read-only `std::streambuf` over a contiguous byte range.
+///
+/// The get area points directly at the caller's bytes, so reads are plain
+/// `memcpy`s out of the underlying storage (e.g. a memory-mapped PAK) and the
+/// stream can never run past the end of the range.
+class SpanStreamBuf : public std::streambuf {
+public:
+    SpanStreamBuf() = default;
+
+    explicit SpanStreamBuf(std::span<std::byte const> bytes) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+        auto* begin = const_cast<char*>(
+            reinterpret_cast<char const*>(bytes.data()));
+        setg(begin, begin, begin + bytes.size());
+    }
+
+protected:
+    pos_type seekoff(off_type off,
+                     std::ios_base::seekdir dir,
+                     std::ios_base::openmode which) override {
+        if ((which & std::ios_base::in) == 0) {
+            return pos_type(off_type(-1));
+        }
+
+        off_type base{};
+        if (dir == std::ios_base::cur) {
+            base = gptr() - eback();
+        } else if (dir == std::ios_base::end) {
+            base = egptr() - eback();
+        }
+        return seekpos(pos_type(base + off), which);
+    }
+
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+        auto const off = off_type(pos);
+        if ((which & std::ios_base::in) == 0 || off < 0 ||
+            off > egptr() - eback()) {
+            return pos_type(off_type(-1));
+        }
+        setg(eback(), eback() + off, egptr());
+        return pos;
+    }
+};
+
+/// `std::istream` reading from a `SpanStreamBuf`.
+///
+/// A default-constructed stream is not open and has its failbit set, which
+/// mirrors an `std::ifstream` that failed to open.
+class SpanStream : public std::istream {
+public:
+    SpanStream()
+        : std::istream(nullptr) {
+        setstate(std::ios_base::failbit);
+    }
+
+    /// Read @p bytes, keeping @p owner (e.g. the file they are mapped
+    /// from) alive for as long as the stream.
+    explicit SpanStream(std::span<std::byte const> bytes,
+                        std::shared_ptr<void const> owner = {})
+        : std::istream(nullptr)
+        , buf_(bytes)
+        , owner_(std::move(owner))
+        , open_(true) {
+        rdbuf(&buf_);
+    }
+
+    SpanStream(SpanStream const&) = delete;
+    SpanStream& operator=(SpanStream const&) = delete;
+
+    SpanStream(SpanStream&& rhs) noexcept
+        : std::istream(std::move(rhs))
+        , buf_(rhs.buf_)
+        , owner_(std::move(rhs.owner_))
+        , open_(std::exchange(rhs.open_, false)) {
+        set_rdbuf(open_ ? &buf_ : nullptr);
+    }
+
+    SpanStream& operator=(SpanStream&& rhs) noexcept {
+        if (this != &rhs) {
+            std::istream::operator=(std::move(rhs));
+            buf_ = rhs.buf_;
+            owner_ = std::move(rhs.owner_);
+            open_ = std::exchange(rhs.open_, false);
+            set_rdbuf(open_ ? &buf_ : nullptr);
+        }
+        return *this;
+    }
+
+    ~SpanStream() override = default;
+
+    /// True if the stream was constructed over an entry's bytes.
+    [[nodiscard]] bool is_open() const noexcept { return open_; }
+
+private:
+    SpanStreamBuf buf_;
+    std::shared_ptr<void const> owner_;
+    bool open_{false};
+};
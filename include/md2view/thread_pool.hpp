@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// Fixed-size work-stealing thread pool.
+///
+/// Every worker owns a task deque. A worker pops its own newest task first
+/// (LIFO, cache friendly) and, when its deque is empty, steals the oldest
+/// task from another worker (FIFO), so an uneven split of work evens itself
+/// out without a shared central queue. Deques are guarded by per-worker
+/// mutexes which are only contended while stealing.
+///
+/// `parallel_for()` is blocking and the calling thread runs tasks too, so a
+/// pool of N workers puts N + 1 threads on a batch. A pool with zero workers
+/// is valid and runs everything on the caller.
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    /// Start @p workers threads.
+    explicit ThreadPool(size_t workers = default_worker_count());
+
+    /// Finishes queued tasks, then joins the workers.
+    ~ThreadPool();
+
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+    ThreadPool(ThreadPool&&) = delete;
+    ThreadPool& operator=(ThreadPool&&) = delete;
+
+    /// Number of worker threads, not counting callers of `parallel_for()`.
+    [[nodiscard]] size_t size() const { return workers_.size(); }
+
+    /// One worker per hardware thread, leaving one for the caller.
+    [[nodiscard]] static size_t default_worker_count();
+
+    /// Queue @p task to run on a worker.
+    void submit(Task task);
+
+    /// Call @p fn(begin, end) over [0, @p count) split into chunks of at most
+    /// @p grain elements, and wait for all of them. A @p grain of 0 picks a
+    /// chunk size giving each thread a few chunks to balance with.
+    ///
+    /// If any call throws, the first exception is rethrown here once every
+    /// chunk has finished.
+    void parallel_for(size_t count,
+                      size_t grain,
+                      std::function<void(size_t, size_t)> const& fn);
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void worker_loop(size_t index);
+    [[nodiscard]] bool run_one(size_t home);
+    [[nodiscard]] bool pop(size_t index, Task& task);
+    [[nodiscard]] bool steal(size_t thief, Task& task);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> next_queue_{0};
+    std::atomic<size_t> queued_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    bool stopping_{false};
+};
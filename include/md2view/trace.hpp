@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <filesystem>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <utility>
+
+/// Timeline tracing in the Chrome trace event format, for viewing in
+/// chrome://tracing or https://ui.perfetto.dev.
+///
+/// Code marks what it does with `MD2V_TRACE_SCOPE` and `MD2V_TRACE_COUNTER`.
+/// While tracing is on, each thread records events into a ring buffer of its
+/// own, which grows as it is used, so threads never contend except with
+/// `write_json()`. A thread that records more than the ring holds loses its
+/// oldest events, and the count of lost events is logged on save.
+///
+/// Built without `MD2VIEW_TRACE` the macros expand to nothing. Built with it
+/// but not started, a scope costs one relaxed atomic load. Event names and
+/// details are copied, truncated to `max_name` and `max_detail` bytes.
+namespace Trace {
+
+#ifdef MD2VIEW_TRACE
+inline constexpr bool compiled_in = true;
+#else
+inline constexpr bool compiled_in = false;
+#endif
+
+/// Events each thread's ring buffer holds by default; about 36 MiB once
+/// full, or several minutes of frames.
+inline constexpr size_t default_buffer_events = size_t{1} << 18;
+
+inline constexpr size_t max_name = 47;
+inline constexpr size_t max_detail = 63;
+
+using TimePoint = std::chrono::steady_clock::time_point;
+
+namespace detail {
+inline std::atomic<bool> enabled{false};
+} // namespace detail
+
+/// True between `start()` and `stop()`.
+[[nodiscard]] inline bool enabled() {
+    return detail::enabled.load(std::memory_order_relaxed);
+}
+
+/// Discard any recorded events and start recording, with rings of
+/// @p events_per_thread events.
+///
+/// @throws gsl_lite::fail_fast if @p events_per_thread is 0.
+void start(size_t events_per_thread = default_buffer_events);
+
+/// Stop recording; recorded events are kept for `write_json()`.
+void stop();
+
+/// Name the calling thread in traces. Can be called before tracing starts.
+void set_thread_name(std::string_view name);
+
+/// Record that @p name ran from @p begin to @p end on the calling thread.
+/// No-op unless `enabled()`.
+void complete(std::string_view name,
+              TimePoint begin,
+              TimePoint end,
+              std::string_view detail = {});
+
+/// Record @p value as the current value of counter @p name. No-op unless
+/// `enabled()`. JSON has no NaN or infinity, so such a sample is recorded
+/// but left out of `write_json()`.
+void counter(std::string_view name, double value);
+
+/// Write every recorded event as a Chrome trace event JSON object.
+/// @return The number of events written, not counting thread names.
+size_t write_json(std::ostream& os);
+
+/// `write_json()` to @p path.
+/// @throws std::runtime_error if the file cannot be written.
+void save(std::filesystem::path const& path);
+
+/// Records the enclosing block as one event when it ends; use through
+/// `MD2V_TRACE_SCOPE`.
+class Scope {
+public:
+    /// @param name Must outlive the scope; the macros pass literals.
+    explicit Scope(char const* name)
+        : name_(name) {
+        if (enabled()) {
+            begin_ = std::chrono::steady_clock::now();
+            active_ = true;
+        }
+    }
+
+    /// Also describe the event with the string @p detail returns, which is
+    /// only called while tracing.
+    template <std::invocable Detail>
+    Scope(char const* name, Detail&& detail)
+        : Scope(name) {
+        if (active_) {
+            detail_ = std::forward<Detail>(detail)();
+        }
+    }
+
+    ~Scope() {
+        if (active_) {
+            complete(name_, begin_, std::chrono::steady_clock::now(),
+                     detail_);
+        }
+    }
+
+    Scope(Scope const&) = delete;
+    Scope& operator=(Scope const&) = delete;
+    Scope(Scope&&) = delete;
+    Scope& operator=(Scope&&) = delete;
+
+private:
+    char const* name_;
+    TimePoint begin_{};
+    std::string detail_;
+    bool active_{false};
+};
+
+} // namespace Trace
+
+#define MD2V_TRACE_CONCAT_(a, b) a##b
+#define MD2V_TRACE_CONCAT(a, b) MD2V_TRACE_CONCAT_(a, b)
+
+#ifdef MD2VIEW_TRACE
+/// Record the rest of the enclosing block as event @p name.
+#define MD2V_TRACE_SCOPE(name)                                                 \
+    ::Trace::Scope const MD2V_TRACE_CONCAT(md2v_trace_scope_, __LINE__) {      \
+        name                                                                   \
+    }
+/// `MD2V_TRACE_SCOPE` with a detail string; @p detail is only evaluated
+/// while tracing.
+#define MD2V_TRACE_SCOPE_DETAIL(name, detail)                                  \
+    ::Trace::Scope const MD2V_TRACE_CONCAT(md2v_trace_scope_, __LINE__) {      \
+        name, [&]() -> std::string { return std::string{detail}; }             \
+    }
+/// Record counter @p name's value; @p value is only evaluated while
+/// tracing.
+#define MD2V_TRACE_COUNTER(name, value)                                        \
+    do {                                                                       \
+        if (::Trace::enabled()) {                                              \
+            ::Trace::counter(name, static_cast<double>(value));                \
+        }                                                                      \
+    } while (false)
+#else
+#define MD2V_TRACE_SCOPE(name) static_cast<void>(0)
+#define MD2V_TRACE_SCOPE_DETAIL(name, detail) static_cast<void>(0)
+#define MD2V_TRACE_COUNTER(name, value) static_cast<void>(0)
+#endif
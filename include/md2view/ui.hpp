@@ -1,7 +1,8 @@
 #pragma once
 
 class Camera;
-class MD2;
+class FrameProfiler;
+class MD2Instance;
 
 /// Backend-agnostic ImGui panels for domain objects.
 ///
@@ -17,6 +18,10 @@ void draw(Camera& camera);
 /// Draw an ImGui panel for selecting animations, skins, and playback speed.
 ///
 /// @return True if the active skin changed (caller should reload the texture).
-[[nodiscard]] bool draw(MD2& md2);
+[[nodiscard]] bool draw(MD2Instance& md2);
+
+/// Draw a table of per-stage CPU and GPU time percentiles and a rolling
+/// graph of each stage on the chosen clock.
+void draw(FrameProfiler const& profiler);
 
 } // namespace UI
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "md2view/pak.hpp"
+#include "md2view/span_stream.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/// Layered virtual filesystem over PAK archives and directories.
+///
+/// Mounts form an ordered search path, as in Quake II: a file in a later
+/// mount shadows the same path in every earlier one. `mount_game_dir()` adds
+/// a game directory the way the engine does, the loose files first and then
+/// its `pak0.pak`, `pak1.pak`, ... on top, so a mod directory mounted after
+/// `baseq2` overrides it.
+///
+/// Every mount's index is merged into one table on mounting: each visible
+/// path resolves in O(1) through a hash map to the mount that owns it, and
+/// sorted queries (`directory()`, `models()`) read a merged, sorted list. The
+/// lookup and stream API mirrors `PAK`, so callers see the whole game data
+/// through one object. Paths are views into the mounted PAKs' own indexes;
+/// nothing is copied.
+///
+/// Mounting is not thread-safe; everything else may be called concurrently
+/// once mounting is done.
+class VFS {
+public:
+    /// A visible entry and the mount it resolves to.
+    struct Entry {
+        PAK const* pak;
+        PAK::Node node;
+    };
+
+    VFS() = default;
+
+    /// Mount each of @p search_path in order, directories with
+    /// `mount_game_dir()` and files with `mount()`, saving and reusing
+    /// directory indexes in @p index_cache_dir if given.
+    explicit VFS(std::vector<std::filesystem::path> const& search_path,
+                 std::optional<std::filesystem::path> index_cache_dir =
+                     std::nullopt);
+
+    VFS(VFS const&) = delete;
+    VFS& operator=(VFS const&) = delete;
+    VFS(VFS&&) = default;
+    VFS& operator=(VFS&&) = default;
+
+    /// Directory that later directory mounts save their index in and load
+    /// it from; see `PAK`. Unset, every directory mount is walked.
+    void set_index_cache_dir(std::optional<std::filesystem::path> dir) {
+        index_cache_dir_ = std::move(dir);
+    }
+
+    /// Mount a `.pak` file or a directory on top of the search path.
+    ///
+    /// @throws std::runtime_error if @p fpath cannot be opened as a PAK.
+    void mount(std::filesystem::path const& fpath);
+
+    /// Mount game directory @p dir, then `dir/pakN.pak` for N = 0, 1, ...
+    /// while those files exist.
+    ///
+    /// @throws std::runtime_error if @p dir or one of its PAKs cannot be
+    ///         opened.
+    void mount_game_dir(std::filesystem::path const& dir);
+
+    /// The mounted PAKs, lowest priority first.
+    [[nodiscard]] std::vector<std::unique_ptr<PAK>> const& mounts() const {
+        return mounts_;
+    }
+
+    /// Number of visible entries.
+    [[nodiscard]] size_t size() const { return entries_.size(); }
+
+    /// The entry that @p fpath resolves to, or null.
+    [[nodiscard]] Entry const* resolve(std::string_view fpath) const;
+
+    /// The node @p fpath resolves to.
+    [[nodiscard]] std::optional<PAK::Node> find(std::string_view fpath) const;
+
+    /// True if @p fpath resolves to an entry. Files created in a directory
+    /// mount after it was mounted count too.
+    [[nodiscard]] bool contains(std::filesystem::path const& fpath) const;
+
+    /// The bytes @p fpath resolves to; see `PAK::view()`.
+    /// @throws gsl_lite::fail_fast if no mount has the entry.
+    [[nodiscard]] MappedBytes view(std::filesystem::path const& fpath) const;
+
+    /// A bounded stream over `view()`, or a stream that is not open if no
+    /// mount has @p fpath.
+    SpanStream open_ifstream(std::filesystem::path const& fpath) const;
+
+    /// Visible entries directly inside @p dir, sorted by path; see
+    /// `PAK::directory()`.
+    [[nodiscard]] auto directory(std::string_view dir) const;
+
+    /// Visible `.md2` entries, sorted by path.
+    [[nodiscard]] auto models() const;
+
+    [[nodiscard]] bool has_models() const { return !models_.empty(); }
+
+private:
+    void build_index();
+    [[nodiscard]] std::span<Entry const>
+    directory_range(std::string_view dir) const;
+
+    std::optional<std::filesystem::path> index_cache_dir_;
+    std::vector<std::unique_ptr<PAK>> mounts_;
+    /// Visible entries sorted by path.
+    std::vector<Entry> entries_;
+    /// Path → index into `entries_`.
+    std::unordered_map<std::string_view, uint32_t> index_;
+    /// Indices into `entries_` of the `.md2` entries.
+    std::vector<uint32_t> models_;
+};
+
+inline auto VFS::directory(std::string_view dir) const {
+    auto const start =
+        dir.empty() || dir.ends_with('/') ? dir.size() : dir.size() + 1;
+    auto const to_node = [](Entry const& entry) { return entry.node; };
+    return directory_range(dir) | std::views::transform(to_node) |
+           std::views::filter([start](PAK::Node const& node) {
+               return node.path.find('/', start) == std::string_view::npos;
+           });
+}
+
+inline auto VFS::models() const {
+    return std::span<uint32_t const>{models_} |
+           std::views::transform(
+               [this](uint32_t index) { return entries_[index].node; });
+}
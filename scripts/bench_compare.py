@@ -0,0 +1,49 @@
+#!/usr/bin/env python3
+"""Compare two bench_md2v JSON results.
+
+Usage: scripts/bench_compare.py baseline.json candidate.json [--threshold 5]
+
+Prints ns/item for every benchmark in both runs and the relative change.
+Exits with status 1 if any benchmark got slower by more than the threshold
+percentage, so it can gate a CI job.
+"""
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        return {b["name"]: b for b in json.load(f)["benchmarks"]}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline")
+    parser.add_argument("candidate")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="regression threshold in percent (default 5)")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    candidate = load(args.candidate)
+
+    regressed = False
+    print(f"{'benchmark':<28} {'baseline':>14} {'candidate':>14} {'change':>9}")
+    for name, new in candidate.items():
+        old = baseline.get(name)
+        if old is None:
+            print(f"{name:<28} {'-':>14} {new['ns_per_item']:>14.1f}")
+            continue
+        change = (new["ns_per_item"] / old["ns_per_item"] - 1.0) * 100.0
+        flag = ""
+        if change > args.threshold:
+            flag = "  slower"
+            regressed = True
+        print(f"{name:<28} {old['ns_per_item']:>14.1f} "
+              f"{new['ns_per_item']:>14.1f} {change:>+8.1f}%{flag}")
+    return 1 if regressed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,11 +1,25 @@
 #include "md2view/engine.hpp"
+#include "md2view/trace.hpp"
 
 #include <gsl-lite/gsl-lite.hpp>
 #include <spdlog/spdlog.h>
 
+#include <exception>
 #include <iostream>
 #include <map>
 
+Engine::~Engine() {
+    if (trace_path_.empty() || !Trace::enabled()) {
+        return;
+    }
+    Trace::stop();
+    try {
+        Trace::save(trace_path_);
+    } catch (std::exception const& e) {
+        spdlog::error("{}", e.what());
+    }
+}
+
 bool Engine::check_key_pressed(unsigned int key) {
     gsl_Expects(key < max_keys);
 
@@ -24,9 +38,55 @@ bool Engine::parse_args(std::span<char const*> args) {
         "Screen width")(
         "height,H",
         boost::program_options::value<int>(&height_)->default_value(800),
-        "Screen height")("pak,p",
-                         boost::program_options::value<std::string>(&pak_path_),
-                         "PAK file or directory to emulate as a PAK")(
+        "Screen height")(
+        "pak,p",
+        boost::program_options::value<std::vector<std::string>>(&pak_paths_)
+            ->composing(),
+        "PAK file or game directory to mount; repeat to layer them, later "
+        "ones overriding earlier ones")(
+        "compact-frames",
+        boost::program_options::bool_switch(&compact_frames_),
+        "Keep MD2 keyframes quantized and decode them while animating")(
+        "gl-commands",
+        boost::program_options::bool_switch(&gl_commands_),
+        "Draw MD2 models from their triangle strips and fans")(
+        "indexed-skins",
+        boost::program_options::bool_switch(&indexed_skins_),
+        "Keep PCX skins palette-indexed and look colours up on the GPU")(
+        "model-cache-mib",
+        boost::program_options::value<size_t>(&model_cache_mib_)
+            ->default_value(256),
+        "Memory budget for cached models, in MiB")(
+        "texture-cache-mib",
+        boost::program_options::value<size_t>(&texture_cache_mib_)
+            ->default_value(256),
+        "Estimated GPU memory budget for cached textures, in MiB")(
+        "baked-models",
+        boost::program_options::value<std::string>(&baked_model_dir_)
+            ->default_value("data/cache"),
+        "Directory of baked .md2c models; empty to always parse MD2 files")(
+        "pak-index",
+        boost::program_options::value<std::string>(&pak_index_dir_)
+            ->default_value("data/cache"),
+        "Directory to save game directory indexes in; empty to walk them "
+        "on every start")(
+        "update-hz",
+        boost::program_options::value<double>(&pacing_.update_hz)
+            ->default_value(0.0),
+        "Fixed rate to update the game at, independent of the frame rate; "
+        "0 to update once per frame")(
+        "max-fps",
+        boost::program_options::value<double>(&pacing_.max_fps)
+            ->default_value(0.0),
+        "Frame rate cap; 0 for none")(
+        "on-demand",
+        boost::program_options::bool_switch(&pacing_.on_demand),
+        "Only draw frames while something changes and wait for input "
+        "otherwise")(
+        "trace",
+        boost::program_options::value<std::string>(&trace_path_),
+        "Record loading and frame timings and write them to this file on "
+        "exit, in Chrome trace event format for ui.perfetto.dev")(
         "log-level,l",
         boost::program_options::value<std::string>()->default_value("info"),
         "Log level: debug, info, warn, error, off");
@@ -58,5 +118,19 @@ bool Engine::parse_args(std::span<char const*> args) {
     }
     spdlog::set_level(it->second);
 
+    if (pacing_.update_hz < 0.0 || pacing_.max_fps < 0.0) {
+        std::cerr << "--update-hz and --max-fps must not be negative\n";
+        return false;
+    }
+
+    if (!trace_path_.empty()) {
+        if (Trace::compiled_in) {
+            Trace::set_thread_name("main");
+            Trace::start();
+        } else {
+            spdlog::warn("--trace ignored: built without MD2VIEW_TRACE");
+        }
+    }
+
     return true;
 }
@@ -0,0 +1,76 @@
+#include "md2view/frame_pacer.hpp"
+
+#include <gsl-lite/gsl-lite.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+FramePacer::FramePacer()
+    : FramePacer(Config{}) {}
+
+FramePacer::FramePacer(Config config)
+    : config_(config) {
+    gsl_Expects(config_.update_hz >= 0.0 && config_.max_fps >= 0.0);
+}
+
+FramePacer::Frame FramePacer::begin_frame(double now) {
+    auto const dt =
+        last_ ? std::clamp(now - *last_, 0.0, max_frame_time) : 0.0;
+    last_ = now;
+    if (config_.update_hz <= 0.0) {
+        return {.dt = dt, .steps = 1, .step_dt = dt};
+    }
+
+    auto const step = 1.0 / config_.update_hz;
+    accumulator_ += dt;
+    auto const due = std::floor(accumulator_ / step);
+    auto const steps = static_cast<int>(
+        std::min(due, static_cast<double>(max_steps)));
+    accumulator_ -= static_cast<double>(steps) * step;
+    if (accumulator_ >= step) {
+        // more was owed than max_steps; drop the whole steps and keep only
+        // the fraction that carries into the next frame
+        accumulator_ = std::fmod(accumulator_, step);
+    }
+    return {.dt = dt, .steps = steps, .step_dt = step};
+}
+
+double FramePacer::end_frame(double now) {
+    if (config_.max_fps <= 0.0) {
+        return 0.0;
+    }
+    // schedule from the previous deadline so each sleep's overshoot is
+    // taken out of the next one; a frame that ran long starts a new
+    // schedule rather than being followed by a burst of catch up frames
+    deadline_ = std::max(deadline_ + (1.0 / config_.max_fps), now);
+    return deadline_ - now;
+}
+
+void FramePacer::reset(double now) {
+    last_ = now;
+    accumulator_ = 0.0;
+    deadline_ = now;
+}
+
+void FramePacer::sleep_for(double seconds) {
+    using clock = std::chrono::steady_clock;
+    if (seconds <= 0.0) {
+        return;
+    }
+    auto const deadline =
+        clock::now() + std::chrono::duration_cast<clock::duration>(
+                           std::chrono::duration<double>(seconds));
+
+    // sleeps commonly overshoot by up to a scheduler tick, so stop short
+    // and yield through the rest
+    constexpr auto margin = std::chrono::milliseconds{2};
+    for (auto left = deadline - clock::now(); left > margin;
+         left = deadline - clock::now()) {
+        std::this_thread::sleep_for(left - margin);
+    }
+    while (clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
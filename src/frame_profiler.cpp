@@ -0,0 +1,116 @@
+#include "md2view/frame_profiler.hpp"
+#include "md2view/trace.hpp"
+
+#include <gsl-lite/gsl-lite.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+FrameProfiler::Scope::Scope(FrameProfiler& profiler, StageId stage)
+    : profiler_(profiler)
+    , stage_(stage)
+    , start_(std::chrono::steady_clock::now()) {}
+
+FrameProfiler::Scope::~Scope() {
+    auto const end = std::chrono::steady_clock::now();
+    std::chrono::duration<float, std::milli> const elapsed = end - start_;
+    profiler_.record(stage_, Clock::cpu, elapsed.count());
+    if constexpr (Trace::compiled_in) {
+        // stages show up on the trace timeline without a scope of their own
+        Trace::complete(profiler_.stage_name(stage_), start_, end);
+    }
+}
+
+FrameProfiler::StageId FrameProfiler::stage(std::string_view name) {
+    auto const iter = std::ranges::find(stages_, name, &Stage::name);
+    if (iter != stages_.end()) {
+        return static_cast<StageId>(iter - stages_.begin());
+    }
+
+    auto& added = stages_.emplace_back();
+    added.name = name;
+    for (auto& series : added.series) {
+        series.frames.fill(no_frame);
+    }
+    return stages_.size() - 1;
+}
+
+std::string const& FrameProfiler::stage_name(StageId stage) const {
+    return gsl_lite::at(stages_, stage).name;
+}
+
+void FrameProfiler::record(StageId stage,
+                           Clock clock,
+                           std::uint64_t frame,
+                           float ms) {
+    gsl_Expects(stage < stages_.size() && clock != Clock::num_clocks);
+    gsl_Expects(frame <= frame_);
+    if (!in_window(frame)) {
+        return;
+    }
+
+    auto& series =
+        gsl_lite::at(stages_[stage].series, static_cast<size_t>(clock));
+    auto const slot = frame % history_size;
+    if (series.frames[slot] != frame) {
+        series.frames[slot] = frame;
+        series.ms[slot] = 0.0f;
+    }
+    series.ms[slot] += ms;
+}
+
+std::vector<float> FrameProfiler::history(StageId stage, Clock clock) const {
+    auto const& samples = series(stage, clock);
+    std::vector<float> out;
+    out.reserve(history_size);
+    // the oldest frame in the window is the one after the current frame's
+    // slot, wrapping round; before the window fills it starts at frame 0
+    auto const first = frame_ + 1 >= history_size ? frame_ + 1 - history_size
+                                                  : std::uint64_t{0};
+    for (auto frame = first; frame <= frame_; ++frame) {
+        auto const slot = frame % history_size;
+        out.push_back(samples.frames[slot] == frame ? samples.ms[slot] : 0.0f);
+    }
+    return out;
+}
+
+FrameProfiler::Percentiles FrameProfiler::percentiles(StageId stage,
+                                                      Clock clock) const {
+    auto const& samples = series(stage, clock);
+    std::vector<float> sorted;
+    sorted.reserve(history_size);
+    for (size_t slot = 0; slot < history_size; ++slot) {
+        if (samples.frames[slot] != no_frame &&
+            in_window(samples.frames[slot])) {
+            sorted.push_back(samples.ms[slot]);
+        }
+    }
+    if (sorted.empty()) {
+        return {};
+    }
+
+    std::ranges::sort(sorted);
+    // nearest rank: the smallest sample at least p of the samples are at or
+    // below
+    auto const rank = [&sorted](float p) {
+        auto const n = static_cast<float>(sorted.size());
+        auto const index = static_cast<size_t>(std::ceil(p * n)) - 1;
+        return sorted[std::min(index, sorted.size() - 1)];
+    };
+    return {.p50 = rank(0.50f),
+            .p95 = rank(0.95f),
+            .p99 = rank(0.99f),
+            .max = sorted.back(),
+            .samples = sorted.size()};
+}
+
+FrameProfiler::Series const& FrameProfiler::series(StageId stage,
+                                                   Clock clock) const {
+    gsl_Expects(clock != Clock::num_clocks);
+    return gsl_lite::at(gsl_lite::at(stages_, stage).series,
+                        static_cast<size_t>(clock));
+}
+
+bool FrameProfiler::in_window(std::uint64_t frame) const {
+    return frame <= frame_ && frame_ - frame < history_size;
+}
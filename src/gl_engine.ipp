@@ -1,15 +1,20 @@
 #include "md2view/gl/engine.hpp"
+#include "md2view/trace.hpp"
 
 #include <gsl-lite/gsl-lite.hpp>
 #include <spdlog/spdlog.h>
 
+#include <filesystem>
+#include <optional>
 #include <utility>
+#include <vector>
 
 template <typename Game>
 bool GL::Engine<Game>::init(std::span<char const*> args) {
     if (!parse_args(args)) {
         return false;
     }
+    MD2V_TRACE_SCOPE("GL::Engine::init");
 
     int width = width_;
     int height = height_;
@@ -17,11 +22,27 @@ bool GL::Engine<Game>::init(std::span<char const*> args) {
     screen_width_ = width;
     screen_height_ = height;
 
-    std::optional<std::filesystem::path> pak;
-    if (!pak_path_.empty()) {
-        pak = pak_path_;
+    std::vector<std::filesystem::path> const search_path(pak_paths_.begin(),
+                                                         pak_paths_.end());
+    auto const index_cache_dir =
+        pak_index_dir_.empty()
+            ? std::nullopt
+            : std::optional<std::filesystem::path>{pak_index_dir_};
+    resource_manager_ = std::make_unique<ResourceManager>("data", search_path,
+                                                          index_cache_dir);
+    if (compact_frames_) {
+        resource_manager_->set_model_storage(MD2Model::Storage::compact);
+    }
+    resource_manager_->set_indexed_skins(indexed_skins_);
+    resource_manager_->set_model_layout(gl_commands_
+                                            ? MD2Model::Layout::gl_commands
+                                            : MD2Model::Layout::indexed);
+    constexpr size_t bytes_per_mib = 1024 * 1024;
+    resource_manager_->set_model_budget(model_cache_mib_ * bytes_per_mib);
+    resource_manager_->set_texture_budget(texture_cache_mib_ * bytes_per_mib);
+    if (!baked_model_dir_.empty()) {
+        resource_manager_->set_baked_model_dir(baked_model_dir_);
     }
-    resource_manager_ = std::make_unique<ResourceManager>("data", pak);
 
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
@@ -71,6 +92,17 @@ bool GL::Engine<Game>::init(std::span<char const*> args) {
 
     glfwSetScrollCallback(window_, scroll_callback);
 
+    auto mouse_button_callback = [](GLFWwindow* window, int /* button */,
+                                    int /* action */, int /* mods */) {
+        using EngineType = GL::Engine<Game>;
+        auto* engine =
+            static_cast<EngineType*>(glfwGetWindowUserPointer(window));
+        gsl_Assert(engine);
+        engine->mouse_button_callback();
+    };
+
+    glfwSetMouseButtonCallback(window_, mouse_button_callback);
+
     auto win_resize_callback = [](GLFWwindow* window, int width, int height) {
         using EngineType = GL::Engine<Game>;
         auto* engine =
@@ -118,6 +150,9 @@ bool GL::Engine<Game>::init(std::span<char const*> args) {
     glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &nrAttributes);
     spdlog::info("Maximum # of vertex attributes supported: {}", nrAttributes);
 
+    pacer_ = FramePacer{pacing_};
+    gpu_timer_ = std::make_unique<GpuTimer>(profiler_);
+
     if (!game_.on_engine_initialized(*this)) {
         spdlog::error("failed to initialize game");
         return false;
@@ -130,21 +165,35 @@ bool GL::Engine<Game>::init(std::span<char const*> args) {
     gui_ = std::make_unique<GL::Gui>(*this, *resource_manager_,
                                      gsl_lite::not_null{window_});
     glCheckError();
+    gui_stage_ = profiler_.stage("imgui");
 
     return true;
 }
 
 template <typename Game> void GL::Engine<Game>::run_game() {
-    last_frame_ = gsl_lite::narrow_cast<GLfloat>(glfwGetTime());
+    pacer_.reset(glfwGetTime());
     // glfwSwapInterval(1);
 
     while (glfwWindowShouldClose(window_) == 0) {
-        auto const current_frame =
-            gsl_lite::narrow_cast<GLfloat>(glfwGetTime());
-        delta_time_ = current_frame - last_frame_;
-        last_frame_ = current_frame;
+        if (pacer_.config().on_demand && idle()) {
+            // nothing would change on screen; block until input arrives or
+            // the timeout lets the game check on background work
+            glfwWaitEventsTimeout(FramePacer::idle_timeout);
+            pacer_.reset(glfwGetTime());
+            if (idle()) {
+                continue;
+            }
+        } else {
+            glfwPollEvents();
+        }
 
-        glfwPollEvents();
+        MD2V_TRACE_SCOPE("frame");
+        profiler_.begin_frame();
+        gpu_timer_->begin_frame();
+        auto const current_frame = glfwGetTime();
+        auto const frame = pacer_.begin_frame(current_frame);
+        delta_time_ = gsl_lite::narrow_cast<GLfloat>(frame.dt);
+        MD2V_TRACE_COUNTER("frame ms", frame.dt * 1000.0);
 
         if (input_goes_to_game_) {
             game_.process_input(*this, delta_time_);
@@ -152,21 +201,42 @@ template <typename Game> void GL::Engine<Game>::run_game() {
 
         gui_->update(current_frame, !input_goes_to_game_);
         glCheckError();
-        game_.update(*this, delta_time_);
+        FramePacer::run(
+            frame,
+            [this](double step_dt) {
+                game_.advance(*this, gsl_lite::narrow_cast<GLfloat>(step_dt));
+            },
+            [this] { game_.update(*this); });
         glCheckError();
         game_.render(*this);
         glCheckError();
-        gui_->render();
+        {
+            GpuTimer::Scope const timer{*gpu_timer_, gui_stage_};
+            gui_->render();
+        }
         glCheckError();
 
-        glfwSwapBuffers(window_);
+        {
+            MD2V_TRACE_SCOPE("swap buffers");
+            glfwSwapBuffers(window_);
+        }
+
+        if (redraw_frames_ > 0) {
+            --redraw_frames_;
+        }
+        FramePacer::sleep_for(pacer_.end_frame(glfwGetTime()));
     }
 
     glCheckError();
 }
 
+template <typename Game> bool GL::Engine<Game>::idle() const {
+    return redraw_frames_ == 0 && keys_.none() && game_.idle();
+}
+
 template <typename Game>
 void GL::Engine<Game>::key_callback(int key, int action) {
+    wake();
     if (action == GLFW_PRESS) {
         if (key == GLFW_KEY_ESCAPE) {
             glfwSetWindowShouldClose(window_, GL_TRUE);
@@ -185,6 +255,7 @@ void GL::Engine<Game>::key_callback(int key, int action) {
 
 template <typename Game>
 void GL::Engine<Game>::mouse_callback(double xpos, double ypos) {
+    wake();
     GLfloat xoffset = xpos - mouse_.xpos.value_or(xpos);
     GLfloat yoffset = mouse_.ypos.value_or(ypos) -
                       ypos; // reversed since y-coords go from bottom to top
@@ -198,6 +269,7 @@ void GL::Engine<Game>::mouse_callback(double xpos, double ypos) {
 
 template <typename Game>
 void GL::Engine<Game>::scroll_callback(double xoffset, double yoffset) {
+    wake();
     mouse_.scroll_xoffset = xoffset;
     mouse_.scroll_yoffset = yoffset;
 
@@ -206,8 +278,15 @@ void GL::Engine<Game>::scroll_callback(double xoffset, double yoffset) {
     }
 }
 
+template <typename Game> void GL::Engine<Game>::mouse_button_callback() {
+    // ImGui polls the buttons itself; the callback only keeps an on-demand
+    // loop drawing while they change
+    wake();
+}
+
 template <typename Game>
 void GL::Engine<Game>::window_resize_callback(int x, int y) {
+    wake();
     spdlog::info("window resize x={} y={}", x, y);
     screen_width_ = x;
     screen_height_ = y;
@@ -215,6 +294,7 @@ void GL::Engine<Game>::window_resize_callback(int x, int y) {
 
 template <typename Game>
 void GL::Engine<Game>::framebuffer_resize_callback(int x, int y) {
+    wake();
     spdlog::info("framebuffer resize x={} y={}", x, y);
     width_ = x;
     height_ = y;
@@ -0,0 +1,80 @@
+#include "md2view/gl/gpu_timer.hpp"
+
+#include <gsl-lite/gsl-lite.hpp>
+
+namespace GL {
+
+GpuTimer::Scope::Scope(GpuTimer& timer, FrameProfiler::StageId stage)
+    : timer_(timer)
+    , cpu_(timer.profiler(), stage) {
+    timer_.begin(stage);
+}
+
+GpuTimer::Scope::~Scope() { timer_.end(); }
+
+GpuTimer::GpuTimer(FrameProfiler& profiler)
+    : profiler_(profiler) {}
+
+GpuTimer::~GpuTimer() {
+    if (active_) {
+        glEndQuery(GL_TIME_ELAPSED);
+    }
+    glDeleteQueries(gsl_lite::narrow_cast<GLsizei>(queries_.size()),
+                    queries_.data());
+}
+
+void GpuTimer::begin_frame() {
+    // queries finish in the order they were issued, so stop at the first
+    // one that is still running
+    while (!pending_.empty()) {
+        auto const& oldest = pending_.front();
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(oldest.query, GL_QUERY_RESULT_AVAILABLE,
+                           &available);
+        if (available == GL_FALSE) {
+            break;
+        }
+
+        GLuint64 ns{};
+        glGetQueryObjectui64v(oldest.query, GL_QUERY_RESULT, &ns);
+        constexpr float ns_per_ms = 1.0e6f;
+        profiler_.record(oldest.stage, FrameProfiler::Clock::gpu, oldest.frame,
+                         static_cast<float>(ns) / ns_per_ms);
+        free_.push_back(oldest.query);
+        pending_.pop_front();
+    }
+}
+
+void GpuTimer::begin(FrameProfiler::StageId stage) {
+    gsl_Expects(!active_ && !skipped_);
+
+    if (free_.empty()) {
+        if (queries_.size() == max_queries) {
+            skipped_ = true;
+            return;
+        }
+        GLuint query{};
+        glGenQueries(1, &query);
+        queries_.push_back(query);
+        free_.push_back(query);
+    }
+
+    active_ = Pending{
+        .query = free_.back(), .stage = stage, .frame = profiler_.frame()};
+    free_.pop_back();
+    glBeginQuery(GL_TIME_ELAPSED, active_->query);
+}
+
+void GpuTimer::end() {
+    if (skipped_) {
+        skipped_ = false;
+        return;
+    }
+    gsl_Expects(active_);
+
+    glEndQuery(GL_TIME_ELAPSED);
+    pending_.push_back(*active_);
+    active_.reset();
+}
+
+} // namespace GL
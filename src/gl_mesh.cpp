@@ -4,31 +4,67 @@
 #include <gsl-lite/gsl-lite.hpp>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+
 namespace GL {
 
+Mesh::Streaming Mesh::preferred_streaming() {
+    return GLEW_ARB_buffer_storage != 0 ? Streaming::persistent
+                                        : Streaming::sub_data;
+}
+
 Mesh::Mesh(std::span<glm::vec3 const> vertices,
-           std::span<glm::vec2 const> texcoords) {
+           std::span<glm::vec2 const> texcoords,
+           std::span<uint16_t const> indices,
+           Streaming streaming)
+    : streaming_(streaming) {
+    gsl_Expects(streaming_ == Streaming::sub_data ||
+                GLEW_ARB_buffer_storage != 0);
     vertex_count_ = gsl_lite::narrow_cast<GLsizei>(vertices.size());
+    index_count_ = gsl_lite::narrow_cast<GLsizei>(indices.size());
 
     glGenVertexArrays(1, &vao_);
-    glGenBuffers(2, vbo_.data());
+    glGenBuffers(gsl_lite::narrow_cast<GLsizei>(vbo_.size()), vbo_.data());
 
     glBindVertexArray(vao_);
-    spdlog::debug("GL::Mesh vao={} vbo={},{}", vao_, vbo_[0], vbo_[1]);
+    spdlog::debug("GL::Mesh vao={} vbo={},{},{}", vao_, vbo_[position_vbo],
+                  vbo_[texcoord_vbo], vbo_[element_vbo]);
 
     static_assert(sizeof(glm::vec3) == 12, "bad vec3 size");
 
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_[0]);
-    glBufferData(
-        GL_ARRAY_BUFFER,
-        gsl_lite::narrow_cast<GLsizeiptr>(vertices.size() * sizeof(glm::vec3)),
-        vertices.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_[position_vbo]);
+    if (streaming_ == Streaming::persistent) {
+        // every region starts out holding the initial positions, so draw()
+        // is valid before the first next_vertices()
+        GLbitfield const flags =
+            GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        auto const size = gsl_lite::narrow_cast<GLsizeiptr>(
+            stream_regions * vertices.size() * sizeof(glm::vec3));
+        glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags);
+        mapped_ = static_cast<glm::vec3*>(
+            glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags));
+        if (mapped_ == nullptr) {
+            throw std::runtime_error("failed to map vertex stream buffer");
+        }
+        for (size_t region = 0; region < stream_regions; ++region) {
+            std::copy(vertices.begin(), vertices.end(),
+                      mapped_ + (region * vertices.size()));
+        }
+    } else {
+        glBufferData(GL_ARRAY_BUFFER,
+                     gsl_lite::narrow_cast<GLsizeiptr>(vertices.size() *
+                                                       sizeof(glm::vec3)),
+                     vertices.data(), GL_DYNAMIC_DRAW);
+    }
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
 
     static_assert(sizeof(glm::vec2) == 8, "bad vec2 size");
 
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_[1]);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_[texcoord_vbo]);
     glBufferData(
         GL_ARRAY_BUFFER,
         gsl_lite::narrow_cast<GLsizeiptr>(texcoords.size() * sizeof(glm::vec2)),
@@ -36,27 +72,175 @@ Mesh::Mesh(std::span<glm::vec3 const> vertices,
     glEnableVertexAttribArray(1);
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
 
+    if (!indices.empty()) {
+        // element buffer binding is recorded in the VAO
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo_[element_vbo]);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                     gsl_lite::narrow_cast<GLsizeiptr>(indices.size() *
+                                                       sizeof(uint16_t)),
+                     indices.data(), GL_STATIC_DRAW);
+    }
+
     glBindVertexArray(0);
 
     glCheckError();
 }
 
 Mesh::~Mesh() {
+    for (auto* fence : fences_) {
+        glDeleteSync(fence);
+    }
+    // deleting the buffer also unmaps it
+    glDeleteTextures(1, &key_frame_texture_);
+    glDeleteBuffers(1, &key_frame_buffer_);
     glDeleteVertexArrays(1, &vao_);
-    glDeleteBuffers(2, vbo_.data());
+    glDeleteBuffers(gsl_lite::narrow_cast<GLsizei>(vbo_.size()), vbo_.data());
+}
+
+bool Mesh::upload_key_frames(std::span<glm::vec3 const> key_frames) {
+    auto const frame_size = static_cast<size_t>(vertex_count_);
+    gsl_Expects(!key_frames.empty() && frame_size > 0 &&
+                key_frames.size() % frame_size == 0);
+
+    // one texel per vertex per frame; GL only promises 65536 texels, which a
+    // long animation of a detailed model easily passes, and texelFetch past
+    // the limit reads undefined values
+    GLint max_texels{};
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &max_texels);
+    if (std::cmp_greater(key_frames.size(), max_texels)) {
+        spdlog::warn("GL::Mesh {} key frames need {} texels, over the "
+                     "texture buffer limit of {}; blending on the cpu",
+                     key_frames.size() / frame_size, key_frames.size(),
+                     max_texels);
+        glDeleteTextures(1, &key_frame_texture_);
+        glDeleteBuffers(1, &key_frame_buffer_);
+        key_frame_texture_ = 0;
+        key_frame_buffer_ = 0;
+        return false;
+    }
+
+    if (key_frame_buffer_ == 0) {
+        glGenBuffers(1, &key_frame_buffer_);
+        glGenTextures(1, &key_frame_texture_);
+    }
+
+    glBindBuffer(GL_TEXTURE_BUFFER, key_frame_buffer_);
+    glBufferData(GL_TEXTURE_BUFFER,
+                 gsl_lite::narrow_cast<GLsizeiptr>(key_frames.size() *
+                                                   sizeof(glm::vec3)),
+                 key_frames.data(), GL_STATIC_DRAW);
+
+    // RGB32F buffer textures are core since GL 4.0
+    glBindTexture(GL_TEXTURE_BUFFER, key_frame_texture_);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGB32F, key_frame_buffer_);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    spdlog::debug("GL::Mesh uploaded {} key frames ({} bytes)",
+                  key_frames.size() / frame_size,
+                  key_frames.size() * sizeof(glm::vec3));
+    glCheckError();
+    return true;
+}
+
+void Mesh::set_batches(std::span<Batch const> batches) {
+    gsl_Expects(index_count_ == 0);
+    multi_draws_.clear();
+    for (auto const& batch : batches) {
+        gsl_Expects(batch.first >= 0 && batch.count > 0 &&
+                    batch.count <= vertex_count_ - batch.first);
+        auto iter = std::ranges::find(multi_draws_, batch.mode,
+                                      &MultiDraw::mode);
+        if (iter == multi_draws_.end()) {
+            iter = multi_draws_.insert(
+                iter,
+                MultiDraw{.mode = batch.mode, .firsts = {}, .counts = {}});
+        }
+        iter->firsts.push_back(batch.first);
+        iter->counts.push_back(batch.count);
+    }
+    spdlog::debug("GL::Mesh {} batches in {} draws", batches.size(),
+                  multi_draws_.size());
 }
 
 void Mesh::sync(std::span<glm::vec3 const> vertices) {
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_[0]);
+    if (streaming_ == Streaming::persistent) {
+        auto const out = next_vertices();
+        gsl_Expects(vertices.size() == out.size());
+        std::copy(vertices.begin(), vertices.end(), out.begin());
+        return;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_[position_vbo]);
     glBufferSubData(
         GL_ARRAY_BUFFER, 0,
         gsl_lite::narrow_cast<GLsizeiptr>(vertices.size() * sizeof(glm::vec3)),
         vertices.data());
 }
 
+std::span<glm::vec3> Mesh::next_vertices() {
+    gsl_Expects(streaming_ == Streaming::persistent);
+
+    // everything issued so far, including the draws that read the current
+    // region, completes before this fence signals
+    glDeleteSync(fences_[region_]);
+    fences_[region_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    region_ = (region_ + 1) % stream_regions;
+    if (auto* fence = std::exchange(fences_[region_], nullptr)) {
+        constexpr GLuint64 timeout_ns = 1'000'000'000;
+        for (;;) {
+            auto const status =
+                glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout_ns);
+            if (status == GL_ALREADY_SIGNALED ||
+                status == GL_CONDITION_SATISFIED) {
+                break;
+            }
+            if (status == GL_WAIT_FAILED) {
+                spdlog::error("GL::Mesh fence wait failed");
+                break;
+            }
+            spdlog::warn("GL::Mesh waited over 1s for vertex region {}",
+                         region_);
+        }
+        glDeleteSync(fence);
+    }
+
+    auto const count = static_cast<size_t>(vertex_count_);
+    return {mapped_ + (region_ * count), count};
+}
+
 void Mesh::draw(Shader& /* shader */) const {
+    if (key_frame_texture_ != 0) {
+        glActiveTexture(GL_TEXTURE0 + key_frame_texture_unit);
+        glBindTexture(GL_TEXTURE_BUFFER, key_frame_texture_);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
     glBindVertexArray(vao_);
-    glDrawArrays(GL_TRIANGLES, 0, vertex_count_);
+    if (streaming_ == Streaming::persistent) {
+        // point the position attribute at the current ring region; a first
+        // vertex or base vertex would also offset gl_VertexID, which the
+        // vertex shader uses to index key frames
+        auto const offset =
+            region_ * static_cast<size_t>(vertex_count_) * sizeof(glm::vec3);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo_[position_vbo]);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0,
+                              reinterpret_cast<void const*>(offset));
+    }
+    if (!multi_draws_.empty()) {
+        // gl_VertexID is first + i, so key frame lookups stay correct
+        for (auto const& draw : multi_draws_) {
+            glMultiDrawArrays(draw.mode, draw.firsts.data(),
+                              draw.counts.data(),
+                              gsl_lite::narrow_cast<GLsizei>(
+                                  draw.firsts.size()));
+        }
+    } else if (index_count_ > 0) {
+        glDrawElements(GL_TRIANGLES, index_count_, GL_UNSIGNED_SHORT, nullptr);
+    } else {
+        glDrawArrays(GL_TRIANGLES, 0, vertex_count_);
+    }
     glCheckError();
 }
 
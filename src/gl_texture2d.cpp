@@ -1,5 +1,5 @@
 #include "md2view/gl/texture2d.hpp"
-#include "md2view/pak.hpp"
+#include "md2view/vfs.hpp"
 #include "md2view/pcx.hpp"
 
 #include <gsl-lite/gsl-lite.hpp>
@@ -9,6 +9,7 @@
 
 #include <stdexcept>
 #include <utility>
+#include <vector>
 
 namespace GL {
 
@@ -21,6 +22,50 @@ Texture2D::Texture2D(GLuint width,
     }
 }
 
+Texture2D::Texture2D(GLuint width,
+                     GLuint height,
+                     std::span<uint8_t const> indices,
+                     std::span<unsigned char const> palette)
+    : width_{width}
+    , height_{height} {
+    gsl_Expects(indices.size() == size_t{width} * height);
+    gsl_Expects(palette.size() == size_t{palette_size} * 3);
+
+    // indices must not be filtered or mipmapped: blending two indices gives
+    // an unrelated palette entry. The fragment shader filters the resolved
+    // colours instead.
+    attr_.internal_format = GL_R8;
+    attr_.image_format = GL_RED;
+    attr_.filter_min = GL_NEAREST;
+    attr_.filter_max = GL_NEAREST;
+
+    // rows of one byte per texel are not 4-byte aligned for most widths
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    glGenTextures(1, &id_);
+    glBindTexture(GL_TEXTURE_2D, id_);
+    glTexImage2D(GL_TEXTURE_2D, 0, attr_.internal_format,
+                 gsl_lite::narrow_cast<GLsizei>(width_),
+                 gsl_lite::narrow_cast<GLsizei>(height_), 0, attr_.image_format,
+                 GL_UNSIGNED_BYTE, indices.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, attr_.filter_min);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, attr_.filter_max);
+
+    glGenTextures(1, &palette_id_);
+    glBindTexture(GL_TEXTURE_2D, palette_id_);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, palette_size, 1, 0, GL_RGB,
+                 GL_UNSIGNED_BYTE, palette.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    unbind();
+    glCheckError();
+    spdlog::info("initialized indexed 2D texture {}x{}", width_, height_);
+}
+
 Texture2D::~Texture2D() { cleanup(); }
 
 Texture2D::Texture2D(Texture2D&& rhs) noexcept
@@ -28,6 +73,7 @@ Texture2D::Texture2D(Texture2D&& rhs) noexcept
     , width_{rhs.width_}
     , height_{rhs.height_} {
     id_ = std::exchange(rhs.id_, 0U);
+    palette_id_ = std::exchange(rhs.palette_id_, 0U);
 }
 
 Texture2D& Texture2D::operator=(Texture2D&& rhs) noexcept {
@@ -35,6 +81,7 @@ Texture2D& Texture2D::operator=(Texture2D&& rhs) noexcept {
         cleanup();
         attr_ = rhs.attr_;
         id_ = std::exchange(rhs.id_, 0U);
+        palette_id_ = std::exchange(rhs.palette_id_, 0U);
         width_ = rhs.width_;
         height_ = rhs.height_;
     }
@@ -47,6 +94,10 @@ void Texture2D::cleanup() {
         glDeleteTextures(1, &id_);
         id_ = 0U;
     }
+    if (palette_id_ != 0U) {
+        glDeleteTextures(1, &palette_id_);
+        palette_id_ = 0U;
+    }
 }
 
 bool Texture2D::init(GLuint width,
@@ -88,35 +139,90 @@ bool Texture2D::init(GLuint width,
     return true;
 }
 
-void Texture2D::bind() const { glBindTexture(GL_TEXTURE_2D, id_); }
+void Texture2D::bind() const {
+    if (palette_id_ != 0U) {
+        glActiveTexture(GL_TEXTURE0 + palette_texture_unit);
+        glBindTexture(GL_TEXTURE_2D, palette_id_);
+        glActiveTexture(GL_TEXTURE0);
+    }
+    glBindTexture(GL_TEXTURE_2D, id_);
+}
+
+size_t Texture2D::gpu_bytes() const {
+    auto const texels = size_t{width_} * height_;
+    if (indexed()) {
+        return texels + (size_t{palette_size} * 4);
+    }
+    // a full mip chain adds a third
+    return texels * 4 * 4 / 3;
+}
 
-std::shared_ptr<Texture2D> Texture2D::load(PAK const& pak,
-                                           std::string const& path) {
-    spdlog::info("load texture {} from {}", path, pak.fpath().string());
+void Texture2D::set_palette(std::span<unsigned char const> palette) {
+    gsl_Expects(indexed());
+    gsl_Expects(palette.size() == size_t{palette_size} * 3);
+    glBindTexture(GL_TEXTURE_2D, palette_id_);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, palette_size, 1, GL_RGB,
+                    GL_UNSIGNED_BYTE, palette.data());
+    unbind();
+    glCheckError();
+}
+
+Texture2D::Image
+Texture2D::decode(VFS const& vfs, std::string const& path, bool indexed) {
+    spdlog::info("decode texture {}", path);
     auto const is_pcx = std::filesystem::path(path).extension() == ".pcx";
 
     if (is_pcx) {
-        auto inf = pak.open_ifstream(path);
-        gsl_Assert(inf.is_open());
-        PCX pcx(inf);
-        return std::make_shared<Texture2D>(pcx.width(), pcx.height(),
-                                           std::span{pcx.image()});
+        auto const pixels = indexed ? PCX::Pixels::indexed : PCX::Pixels::rgb;
+        PCX pcx(vfs.view(path).bytes(), pixels);
+        Image image{gsl_lite::narrow<GLuint>(pcx.width()),
+                    gsl_lite::narrow<GLuint>(pcx.height()), {}, {}};
+        if (indexed) {
+            image.pixels = pcx.take_indices();
+            image.palette = pcx.palette();
+        } else {
+            image.pixels = pcx.take_image();
+        }
+        return image;
     }
 
-    auto const abspath = (pak.fpath() / path).make_preferred();
-    gsl_Assert(std::filesystem::exists(abspath));
+    // decode straight from the entry bytes so archive-mode PAKs work
+    // without unpacking to disk
+    auto const bytes = vfs.view(path);
     int width{};
     int height{};
     int n{};
-    unsigned char* image =
-        stbi_load(abspath.string().c_str(), &width, &height, &n, 3);
-    gsl_Assert(image);
-    auto texture = std::make_shared<Texture2D>(
-        width, height, std::span{image, static_cast<size_t>(width * height)});
-    spdlog::info("loaded 2D texture {} width: {} height: {}", path, width,
-                 height);
-    stbi_image_free(image);
+    std::unique_ptr<unsigned char, decltype(&stbi_image_free)> const pixels{
+        stbi_load_from_memory(
+            reinterpret_cast<stbi_uc const*>(bytes.data()),
+            gsl_lite::narrow<int>(bytes.size()), &width, &height, &n, 3),
+        &stbi_image_free};
+    if (!pixels) {
+        spdlog::error("failed to decode texture {}: {}", path,
+                      stbi_failure_reason());
+    }
+    gsl_Assert(pixels);
+    auto const size = static_cast<size_t>(width) * height * 3;
+    return {gsl_lite::narrow<GLuint>(width), gsl_lite::narrow<GLuint>(height),
+            std::vector<unsigned char>(pixels.get(), pixels.get() + size),
+            {}};
+}
+
+std::shared_ptr<Texture2D> Texture2D::upload(Image const& image) {
+    auto texture = image.palette.empty()
+                       ? std::make_shared<Texture2D>(image.width, image.height,
+                                                     std::span{image.pixels})
+                       : std::make_shared<Texture2D>(
+                             image.width, image.height,
+                             std::span{image.pixels}, std::span{image.palette});
+    spdlog::info("loaded 2D texture width: {} height: {}", image.width,
+                 image.height);
     return texture;
 }
 
+std::shared_ptr<Texture2D>
+Texture2D::load(VFS const& vfs, std::string const& path, bool indexed) {
+    return upload(decode(vfs, path, indexed));
+}
+
 } // namespace GL
@@ -0,0 +1,143 @@
+#include "md2view/mapped_file.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(std::filesystem::path const& fpath) {
+    file_ = CreateFileW(fpath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) {
+        file_ = nullptr;
+        throw std::runtime_error("failed to open " + fpath.string());
+    }
+
+    LARGE_INTEGER size{};
+    if (GetFileSizeEx(file_, &size) == 0) {
+        cleanup();
+        throw std::runtime_error("failed to stat " + fpath.string());
+    }
+    size_ = static_cast<std::size_t>(size.QuadPart);
+
+    if (size_ == 0U) {
+        return;
+    }
+
+    mapping_ =
+        CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_ == nullptr) {
+        cleanup();
+        throw std::runtime_error("failed to map " + fpath.string());
+    }
+
+    data_ = static_cast<std::byte const*>(
+        MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    if (data_ == nullptr) {
+        cleanup();
+        throw std::runtime_error("failed to map " + fpath.string());
+    }
+    spdlog::debug("mapped {} ({} bytes)", fpath.string(), size_);
+}
+
+void MappedFile::cleanup() noexcept {
+    if (data_ != nullptr) {
+        UnmapViewOfFile(data_);
+    }
+    if (mapping_ != nullptr) {
+        CloseHandle(mapping_);
+    }
+    if (file_ != nullptr) {
+        CloseHandle(file_);
+    }
+    data_ = nullptr;
+    size_ = 0U;
+    mapping_ = nullptr;
+    file_ = nullptr;
+}
+
+MappedFile::MappedFile(MappedFile&& rhs) noexcept
+    : data_(std::exchange(rhs.data_, nullptr))
+    , size_(std::exchange(rhs.size_, 0U))
+    , file_(std::exchange(rhs.file_, nullptr))
+    , mapping_(std::exchange(rhs.mapping_, nullptr)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& rhs) noexcept {
+    if (this != &rhs) {
+        cleanup();
+        data_ = std::exchange(rhs.data_, nullptr);
+        size_ = std::exchange(rhs.size_, 0U);
+        file_ = std::exchange(rhs.file_, nullptr);
+        mapping_ = std::exchange(rhs.mapping_, nullptr);
+    }
+    return *this;
+}
+
+#else
+
+MappedFile::MappedFile(std::filesystem::path const& fpath) {
+    int const fd = ::open(fpath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("failed to open " + fpath.string());
+    }
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("failed to stat " + fpath.string());
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+
+    if (size_ > 0U) {
+        void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            ::close(fd);
+            size_ = 0U;
+            throw std::runtime_error("failed to map " + fpath.string());
+        }
+        data_ = static_cast<std::byte const*>(addr);
+    }
+
+    // the mapping keeps its own reference to the file
+    ::close(fd);
+    spdlog::debug("mapped {} ({} bytes)", fpath.string(), size_);
+}
+
+void MappedFile::cleanup() noexcept {
+    if (data_ != nullptr) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+        ::munmap(const_cast<std::byte*>(data_), size_);
+    }
+    data_ = nullptr;
+    size_ = 0U;
+}
+
+MappedFile::MappedFile(MappedFile&& rhs) noexcept
+    : data_(std::exchange(rhs.data_, nullptr))
+    , size_(std::exchange(rhs.size_, 0U)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& rhs) noexcept {
+    if (this != &rhs) {
+        cleanup();
+        data_ = std::exchange(rhs.data_, nullptr);
+        size_ = std::exchange(rhs.size_, 0U);
+    }
+    return *this;
+}
+
+#endif
+
+MappedFile::~MappedFile() { cleanup(); }
@@ -0,0 +1,254 @@
+// Reading and writing the baked .md2c form of an MD2Model.
+#include "md2view/md2_model.hpp"
+#include "md2view/trace.hpp"
+
+#include <gsl-lite/gsl-lite.hpp>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+static_assert(sizeof(MD2Model::BakedHeader) == 112,
+              "baked header has padding");
+static_assert(sizeof(glm::vec2) == 2 * sizeof(float));
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float));
+static_assert(sizeof(MD2Model::Batch) == 12, "baked batch has padding");
+
+constexpr size_t alignment = 4;
+
+/// Sequential writer that keeps every section 4 byte aligned.
+class Writer {
+public:
+    explicit Writer(std::ostream& os)
+        : os_{os} {}
+
+    template <typename T> void value(T const& v) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        bytes(&v, sizeof(T));
+    }
+
+    template <typename T> void array(std::vector<T> const& v) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        bytes(v.data(), v.size() * sizeof(T));
+        align();
+    }
+
+    void string(std::string const& s) {
+        value(gsl_lite::narrow<uint32_t>(s.size()));
+        bytes(s.data(), s.size());
+        align();
+    }
+
+private:
+    void bytes(void const* data, size_t size) {
+        os_.write(static_cast<char const*>(data),
+                  gsl_lite::narrow<std::streamsize>(size));
+        written_ += size;
+    }
+
+    void align() {
+        static constexpr std::array<char, alignment> zeros{};
+        bytes(zeros.data(), (alignment - (written_ % alignment)) % alignment);
+    }
+
+    std::ostream& os_;
+    size_t written_{};
+};
+
+/// Bounds-checked sequential reader mirroring `Writer`. Every read throws on
+/// running past the end, so a truncated file can never be half loaded.
+class Reader {
+public:
+    explicit Reader(std::span<std::byte const> data)
+        : data_{data} {}
+
+    template <typename T> T value() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T v{};
+        std::memcpy(&v, take(sizeof(T)).data(), sizeof(T));
+        return v;
+    }
+
+    template <typename T> void array(std::vector<T>& out, size_t count) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        auto const src = take(count * sizeof(T));
+        out.resize(count);
+        if (count > 0) {
+            std::memcpy(out.data(), src.data(), src.size());
+        }
+        align();
+    }
+
+    std::string string() {
+        auto const size = value<uint32_t>();
+        auto const src = take(size);
+        std::string s(reinterpret_cast<char const*>(src.data()), src.size());
+        align();
+        return s;
+    }
+
+    [[nodiscard]] bool at_end() const { return pos_ == data_.size(); }
+
+private:
+    std::span<std::byte const> take(size_t size) {
+        if (size > data_.size() - pos_) {
+            throw std::runtime_error("truncated baked md2");
+        }
+        auto const span = data_.subspan(pos_, size);
+        pos_ += size;
+        return span;
+    }
+
+    void align() { take((alignment - (pos_ % alignment)) % alignment); }
+
+    std::span<std::byte const> data_;
+    size_t pos_{};
+};
+
+} // namespace
+
+MD2Model::MD2Model(Baked /* tag */, std::span<std::byte const> data) {
+    if (!load_baked(data)) {
+        throw std::runtime_error("failed to load baked MD2 model");
+    }
+}
+
+void MD2Model::write_baked(std::ostream& os, uint64_t source_key) const {
+    auto const frame_count = storage_ == Storage::compact
+                                 ? frames_.size()
+                                 : key_frames_.size() / vertex_count();
+    BakedHeader const header{
+        .magic = baked_magic,
+        .version = baked_version,
+        .source_key = source_key,
+        .md2 = hdr_,
+        .layout = static_cast<uint8_t>(layout_),
+        .storage = static_cast<uint8_t>(storage_),
+        .reserved = 0,
+        .vertex_count = gsl_lite::narrow<uint32_t>(vertex_map_.size()),
+        .index_count = gsl_lite::narrow<uint32_t>(indices_.size()),
+        .frame_count = gsl_lite::narrow<uint32_t>(frame_count),
+        .skin_count = gsl_lite::narrow<uint32_t>(skins_.size()),
+        .animation_count = gsl_lite::narrow<uint32_t>(animations_.size()),
+        .batch_count = gsl_lite::narrow<uint32_t>(batches_.size()),
+    };
+
+    Writer out{os};
+    out.value(header);
+    out.array(vertex_map_);
+    out.array(indices_);
+    out.array(batches_);
+    out.array(scaled_texcoords_);
+    if (storage_ == Storage::compact) {
+        for (auto const& frame : frames_) {
+            out.value(frame.scale);
+            out.value(frame.translate);
+            out.value(frame.name);
+            out.array(frame.vertices);
+        }
+    } else {
+        out.array(key_frames_);
+    }
+    for (auto const& skin : skins_) {
+        out.string(skin.fpath);
+        out.string(skin.name);
+    }
+    for (auto const& anim : animations_) {
+        out.value(int32_t{anim.start_frame});
+        out.value(int32_t{anim.end_frame});
+        out.value(uint32_t{anim.loop ? 1U : 0U});
+        out.string(anim.name);
+    }
+}
+
+bool MD2Model::load_baked(std::span<std::byte const> data) {
+    MD2V_TRACE_SCOPE("MD2Model::load_baked");
+    Reader in{data};
+    auto const header = in.value<BakedHeader>();
+    if (header.magic != baked_magic || header.version != baked_version) {
+        spdlog::error("not a version {} baked md2", baked_version);
+        return false;
+    }
+    if (header.layout > static_cast<uint8_t>(Layout::gl_commands) ||
+        header.storage > static_cast<uint8_t>(Storage::compact) ||
+        header.vertex_count == 0 || header.md2.num_xyz <= 0 ||
+        header.md2.num_xyz > max_vertices || header.md2.num_frames <= 0 ||
+        header.md2.num_frames > max_frames ||
+        std::cmp_not_equal(header.frame_count, header.md2.num_frames)) {
+        spdlog::error("invalid baked md2 header");
+        return false;
+    }
+
+    hdr_ = header.md2;
+    layout_ = static_cast<Layout>(header.layout);
+    storage_ = static_cast<Storage>(header.storage);
+
+    in.array(vertex_map_, header.vertex_count);
+    in.array(indices_, header.index_count);
+    in.array(batches_, header.batch_count);
+    in.array(scaled_texcoords_, header.vertex_count);
+    if (storage_ == Storage::compact) {
+        frames_.resize(header.frame_count);
+        for (auto& frame : frames_) {
+            frame.scale = in.value<decltype(frame.scale)>();
+            frame.translate = in.value<decltype(frame.translate)>();
+            frame.name = in.value<decltype(frame.name)>();
+            in.array(frame.vertices, static_cast<size_t>(hdr_.num_xyz));
+        }
+    } else {
+        in.array(key_frames_,
+                 size_t{header.frame_count} * header.vertex_count);
+    }
+
+    skins_.reserve(header.skin_count);
+    for (uint32_t i = 0; i < header.skin_count; ++i) {
+        auto fpath = in.string();
+        auto name = in.string();
+        skins_.emplace_back(std::move(fpath), std::move(name));
+    }
+    animations_.reserve(header.animation_count);
+    for (uint32_t i = 0; i < header.animation_count; ++i) {
+        Animation anim;
+        anim.start_frame = in.value<int32_t>();
+        anim.end_frame = in.value<int32_t>();
+        anim.loop = in.value<uint32_t>() != 0;
+        anim.name = in.string();
+        animation_index_map_[anim.name] = animations_.size();
+        animations_.push_back(std::move(anim));
+    }
+
+    // everything the renderer indexes with must stay in range, as it would
+    // for a freshly parsed model
+    auto const in_frame = [this](uint16_t v) { return v < hdr_.num_xyz; };
+    auto const in_vertices = [this](uint16_t i) {
+        return i < vertex_map_.size();
+    };
+    auto const in_batches = [this](Batch const& batch) {
+        return batch.count >= 3 && batch.first <= vertex_map_.size() &&
+               batch.count <= vertex_map_.size() - batch.first &&
+               batch.primitive <= Primitive::triangle_fan;
+    };
+    auto const in_frames = [&header](Animation const& anim) {
+        return anim.start_frame >= 0 && anim.start_frame <= anim.end_frame &&
+               std::cmp_less(anim.end_frame, header.frame_count);
+    };
+    if (!in.at_end() || !std::ranges::all_of(vertex_map_, in_frame) ||
+        !std::ranges::all_of(indices_, in_vertices) ||
+        !std::ranges::all_of(batches_, in_batches) ||
+        !std::ranges::all_of(animations_, in_frames)) {
+        spdlog::error("inconsistent baked md2");
+        return false;
+    }
+
+    spdlog::info("baked md2 resident size {} bytes", memory_usage());
+    return true;
+}
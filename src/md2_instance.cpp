@@ -0,0 +1,96 @@
+#include "md2view/md2_instance.hpp"
+#include "md2view/thread_pool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+MD2Instance::MD2Instance(std::shared_ptr<MD2Model const> model)
+    : model_(std::move(model)) {
+    gsl_Expects(model_);
+    // start on the first frame; a single frame model blends with itself
+    next_frame_ = std::min(1, model_->header().num_frames - 1);
+    interpolated_vertices_.resize(model_->vertex_count());
+    model_->blend(frame_blend(), interpolated_vertices_);
+}
+
+void MD2Instance::set_animation(std::string const& id) {
+    if (auto const index = model_->find_animation(id)) {
+        set_animation(*index);
+    }
+}
+
+void MD2Instance::set_animation(size_t index) {
+    auto const& animations = model_->animations();
+    gsl_Expects(index < animations.size());
+
+    if (std::cmp_not_equal(current_animation_index_, index)) {
+        auto const& anim = animations[index];
+        next_frame_ = anim.start_frame;
+        current_animation_index_ = index;
+        interpolation_ = 0.0;
+    }
+}
+
+void MD2Instance::set_skin_index(size_t index) {
+    gsl_Expects(index < model_->skins().size());
+    current_skin_index_ = index;
+}
+
+void MD2Instance::blend() {
+    model_->blend(frame_blend(), interpolated_vertices_);
+}
+
+void MD2Instance::blend(std::span<glm::vec3> out) const {
+    model_->blend(frame_blend(), out);
+}
+
+void MD2Instance::update(float dt) {
+    advance(dt);
+    blend();
+}
+
+void MD2Instance::update(float dt, std::span<glm::vec3> out) {
+    advance(dt);
+    blend(out);
+}
+
+bool MD2Instance::animating() const {
+    auto const& anim =
+        gsl_lite::at(model_->animations(), current_animation_index_);
+    auto const paused = frames_per_second_ == 0.0f;
+    auto const single_frame = anim.start_frame == anim.end_frame;
+    auto const done = !anim.loop && current_frame_ == anim.end_frame;
+    return !paused && !single_frame && !done;
+}
+
+void MD2Instance::advance(float dt) {
+    if (!animating()) {
+        return;
+    }
+
+    auto const& anim =
+        gsl_lite::at(model_->animations(), current_animation_index_);
+    interpolation_ += dt * frames_per_second_;
+
+    if (interpolation_ >= 1.0f) {
+        current_frame_ = next_frame_;
+        ++next_frame_;
+        interpolation_ = 0.0f;
+
+        if (next_frame_ > anim.end_frame) {
+            next_frame_ = anim.start_frame;
+        }
+    }
+}
+
+void update_all(std::span<MD2Instance> instances, float dt) {
+    for (auto& instance : instances) {
+        instance.update(dt);
+    }
+}
+
+void update_all(std::span<MD2Instance> instances, float dt, ThreadPool& pool) {
+    pool.parallel_for(instances.size(), 0, [&](size_t begin, size_t end) {
+        update_all(instances.subspan(begin, end - begin), dt);
+    });
+}
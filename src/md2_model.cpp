@@ -0,0 +1,674 @@
+#include "md2view/md2_model.hpp"
+#include "md2view/pak.hpp"
+#include "md2view/simd_lerp.hpp"
+#include "md2view/trace.hpp"
+#include "md2view/vertex_cache.hpp"
+#include "md2view/vfs.hpp"
+
+#include <fmt/ostream.h>
+#include <glm/gtc/type_ptr.hpp>
+#include <gsl-lite/gsl-lite.hpp>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <istream>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template <> struct fmt::formatter<MD2Model::Header> : ostream_formatter {};
+template <> struct fmt::formatter<MD2Model::Animation> : ostream_formatter {};
+
+namespace {
+
+/// Bytes of @p count consecutive elements of @p element_size starting at
+/// @p offset, or nullopt if that range is not entirely within @p data.
+std::optional<std::span<std::byte const>>
+section(std::span<std::byte const> data,
+        int32_t offset,
+        int32_t count,
+        size_t element_size) {
+    if (offset < 0 || count < 0) {
+        return std::nullopt;
+    }
+    auto const begin = static_cast<size_t>(offset);
+    auto const length = static_cast<size_t>(count) * element_size;
+    if (begin > data.size() || length > data.size() - begin) {
+        return std::nullopt;
+    }
+    return data.subspan(begin, length);
+}
+
+/// Copy a bounds-checked section into a vector of trivially copyable records.
+template <typename T>
+void copy_section(std::span<std::byte const> bytes, std::vector<T>& out) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    out.resize(bytes.size() / sizeof(T));
+    std::memcpy(out.data(), bytes.data(), out.size() * sizeof(T));
+}
+
+/// A null-padded fixed-size string which may not be null terminated.
+template <size_t N> std::string fixed_string(std::array<char, N> const& str) {
+    auto const end = std::ranges::find(str, '\0');
+    return {str.begin(), end};
+}
+
+bool valid_header(MD2Model::Header const& hdr) {
+    return hdr.ident == MD2Model::ident && hdr.version == MD2Model::version &&
+           hdr.skinwidth > 0 && hdr.skinheight > 0 && hdr.num_skins >= 0 &&
+           hdr.num_skins <= MD2Model::max_skins && hdr.num_xyz > 0 &&
+           hdr.num_xyz <= MD2Model::max_vertices && hdr.num_st > 0 &&
+           hdr.num_st <= MD2Model::max_texcoords && hdr.num_tris > 0 &&
+           hdr.num_tris <= MD2Model::max_tris && hdr.num_frames > 0 &&
+           hdr.num_frames <= MD2Model::max_frames;
+}
+
+/// World-space position of @p vertex in @p frame, with Y and Z swapped.
+glm::vec3 dequantize(MD2Model::Frame const& frame,
+                     MD2Model::Vertex const& vertex) {
+    auto const x =
+        (frame.scale[0] * gsl_lite::narrow_cast<float>(vertex.v[0])) +
+        frame.translate[0];
+    auto const z =
+        (frame.scale[1] * gsl_lite::narrow_cast<float>(vertex.v[1])) +
+        frame.translate[1];
+    auto const y =
+        (frame.scale[2] * gsl_lite::narrow_cast<float>(vertex.v[2])) +
+        frame.translate[2];
+    return {x, y, z};
+}
+
+// the lerp kernel works on flat float arrays; vec3 must be tightly packed
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float));
+
+std::span<float const> as_floats(std::span<glm::vec3 const> v) {
+    return {v.empty() ? nullptr : glm::value_ptr(v.front()), v.size() * 3};
+}
+
+std::span<float> as_floats(std::span<glm::vec3> v) {
+    return {v.empty() ? nullptr : glm::value_ptr(v.front()), v.size() * 3};
+}
+
+template <typename T> size_t capacity_bytes(std::vector<T> const& v) {
+    return v.capacity() * sizeof(T);
+}
+
+/// True if @p filename is a loose file rather than a PAK archive entry, in
+/// which case its skins are looked up next to it.
+bool is_loose_file(PAK const& pak, std::string const& /* filename */) {
+    return pak.is_directory();
+}
+
+bool is_loose_file(VFS const& vfs, std::string const& filename) {
+    auto const* entry = vfs.resolve(filename);
+    return entry != nullptr && entry->pak->is_directory();
+}
+
+} // namespace
+
+std::string animation_id_from_frame_name(std::string const& name) {
+    std::string id;
+
+    for (auto const& ch : name) {
+        if (isdigit(ch) != 0) {
+            break;
+        }
+
+        id += ch;
+    }
+
+    return id;
+}
+
+MD2Model::MD2Model(std::string const& filename,
+                   PAK const& pak,
+                   Layout layout,
+                   Storage storage)
+    : layout_(layout)
+    , storage_(storage) {
+    if (!load(pak, filename)) {
+        throw std::runtime_error("failed to load MD2 model " + filename);
+    }
+}
+
+MD2Model::MD2Model(std::string const& filename,
+                   VFS const& vfs,
+                   Layout layout,
+                   Storage storage)
+    : layout_(layout)
+    , storage_(storage) {
+    if (!load(vfs, filename)) {
+        throw std::runtime_error("failed to load MD2 model " + filename);
+    }
+}
+
+MD2Model::MD2Model(std::span<std::byte const> data,
+                   Layout layout,
+                   Storage storage)
+    : layout_(layout)
+    , storage_(storage) {
+    if (!load(data)) {
+        throw std::runtime_error("failed to load MD2 model from memory");
+    }
+}
+
+MD2Model::MD2Model(std::istream& is, Layout layout, Storage storage)
+    : layout_(layout)
+    , storage_(storage) {
+    if (!load(is)) {
+        throw std::runtime_error("failed to load MD2 model from stream");
+    }
+}
+
+template <typename Source>
+bool MD2Model::load(Source const& pf, std::string const& filename) {
+    gsl_Expects(!filename.empty());
+    MD2V_TRACE_SCOPE_DETAIL("MD2Model::load", filename);
+    auto ispak = !is_loose_file(pf, filename);
+    spdlog::info("loading model {} from {}", filename,
+                 ispak ? "archive" : "directory");
+
+    if (!load(pf.view(filename).bytes())) {
+        return false;
+    }
+
+    if (!ispak) {
+        load_skins_from_directory(
+            pf, std::filesystem::path{filename}.parent_path().generic_string());
+    }
+    return true;
+}
+
+template <typename Source>
+void MD2Model::load_skins_from_directory(Source const& pak,
+                                         std::string const& dir) {
+    static constexpr std::array extensions = {".pcx", ".png", ".jpg"};
+
+    spdlog::info("load skins from {}", dir);
+    std::vector<SkinData> found_skins;
+    for (auto const& skin : skins_) {
+        auto path = std::filesystem::path{dir} / skin.name;
+        for (auto const& ext : extensions) {
+            path = path.replace_extension(ext);
+            if (auto const node = pak.find(path.generic_string())) {
+                found_skins.emplace_back(std::string{node->path},
+                                         std::string{node->name});
+                break;
+            }
+        }
+    }
+
+    if (found_skins.empty()) { // drfreak model has no skins specified
+        for (auto const& node : pak.directory(dir)) {
+            if (node.path.ends_with(".png")) {
+                found_skins.emplace_back(std::string{node.path},
+                                         std::string{node.name});
+            }
+        }
+    }
+    skins_ = std::move(found_skins);
+}
+
+bool MD2Model::load(std::istream& infile) {
+    // the header tells us the size of the whole model so pull it into a
+    // single buffer and parse that like any other byte span
+    Header hdr{};
+    infile.read(reinterpret_cast<char*>(&hdr), sizeof(hdr));
+    if (std::cmp_not_equal(infile.gcount(), sizeof(hdr)) ||
+        !valid_header(hdr) || std::cmp_less(hdr.offset_end, sizeof(hdr))) {
+        spdlog::error("invalid md2 header");
+        return false;
+    }
+
+    std::vector<std::byte> buffer(static_cast<size_t>(hdr.offset_end));
+    std::memcpy(buffer.data(), &hdr, sizeof(hdr));
+    auto const remaining =
+        gsl_lite::narrow<std::streamsize>(buffer.size() - sizeof(hdr));
+    infile.read(reinterpret_cast<char*>(buffer.data() + sizeof(hdr)),
+                remaining);
+    if (infile.gcount() != remaining) {
+        spdlog::error("md2 truncated: expected {} bytes", buffer.size());
+        return false;
+    }
+
+    return load(std::span<std::byte const>{buffer});
+}
+
+bool MD2Model::load(std::span<std::byte const> data) {
+    MD2V_TRACE_SCOPE("MD2Model::parse");
+    static_assert(sizeof(hdr_) == (17 * sizeof(int32_t)),
+                  "md2 header has padding");
+
+    if (data.size() < sizeof(hdr_)) {
+        spdlog::error("md2 data too small for header ({} bytes)", data.size());
+        return false;
+    }
+
+    std::memcpy(&hdr_, data.data(), sizeof(hdr_));
+    spdlog::debug("md2 header: {}", hdr_);
+
+    if (!valid_header(hdr_)) {
+        spdlog::error("invalid md2 header");
+        return false;
+    }
+
+    if (!load_skins(data) || !load_triangles(data) || !load_texcoords(data)) {
+        return false;
+    }
+
+    if (layout_ == Layout::gl_commands && hdr_.num_glcmds <= 1) {
+        // no commands beyond the terminator; plenty of tools never wrote any
+        spdlog::info("md2 has no gl commands, using a triangle list");
+        layout_ = Layout::triangle_list;
+    }
+    if (layout_ == Layout::gl_commands) {
+        if (!load_gl_commands(data)) {
+            return false;
+        }
+    } else {
+        build_layout();
+    }
+    if (!load_frames(data)) {
+        return false;
+    }
+
+    spdlog::info("md2 resident size {} bytes ({} storage)", memory_usage(),
+                 storage_ == Storage::compact ? "compact" : "unpacked");
+    return true;
+}
+
+bool MD2Model::load_skins(std::span<std::byte const> data) {
+    static_assert(sizeof(Skin) == 64, "md2 skin has padding");
+    auto const bytes =
+        section(data, hdr_.offset_skins, hdr_.num_skins, sizeof(Skin));
+    if (!bytes) {
+        spdlog::error("md2 skin section out of bounds");
+        return false;
+    }
+
+    std::vector<Skin> skins;
+    copy_section(*bytes, skins);
+    assert(skins.size() == static_cast<size_t>(hdr_.num_skins));
+    spdlog::info("num skins={}", skins.size());
+
+    for (auto const& skin : skins) {
+        auto const name = fixed_string(skin.name);
+        spdlog::info("skin: '{}'", name);
+        std::filesystem::path f(name);
+        skins_.emplace_back(f.string(), f.stem().string());
+        spdlog::debug("{}", skins_.back().fpath);
+    }
+
+    return true;
+}
+
+bool MD2Model::load_triangles(std::span<std::byte const> data) {
+    static_assert(sizeof(Triangle) == 6 * sizeof(uint16_t),
+                  "md2 triangle has padding");
+    auto const bytes =
+        section(data, hdr_.offset_tris, hdr_.num_tris, sizeof(Triangle));
+    if (!bytes) {
+        spdlog::error("md2 triangle section out of bounds");
+        return false;
+    }
+
+    copy_section(*bytes, triangles_);
+
+    auto const in_range = [this](Triangle const& tri) {
+        return std::ranges::all_of(tri.vertex,
+                                   [this](auto index) {
+                                       return index < hdr_.num_xyz;
+                                   }) &&
+               std::ranges::all_of(tri.st, [this](auto index) {
+                   return index < hdr_.num_st;
+               });
+    };
+
+    if (!std::ranges::all_of(triangles_, in_range)) {
+        spdlog::error("md2 triangle index out of range");
+        return false;
+    }
+
+    return true;
+}
+
+bool MD2Model::load_texcoords(std::span<std::byte const> data) {
+    gsl_Expects(!triangles_.empty());
+
+    // read texcoords
+    static_assert(sizeof(TexCoord) == 2 * sizeof(int16_t),
+                  "md2 texcoord has padding");
+    auto const bytes =
+        section(data, hdr_.offset_st, hdr_.num_st, sizeof(TexCoord));
+    if (!bytes) {
+        spdlog::error("md2 texcoord section out of bounds");
+        return false;
+    }
+
+    copy_section(*bytes, texcoords_);
+    return true;
+}
+
+void MD2Model::build_layout() {
+    // md2 allows the same vertex to have a different tex coord in two
+    // different triangles, so an output vertex is an (xyz, st) pair rather
+    // than an xyz index. the triangle list layout emits one per triangle
+    // corner; the indexed layout welds identical pairs and references them
+    // from indices_
+    auto const num_corners = triangles_.size() * 3;
+    vertex_map_.clear();
+    indices_.clear();
+    scaled_texcoords_.clear();
+    vertex_map_.reserve(num_corners);
+    scaled_texcoords_.reserve(num_corners);
+
+    auto const emit = [this](uint16_t xyz_index, uint16_t st_index) {
+        assert(st_index < texcoords_.size());
+        auto const& st = texcoords_[st_index];
+        auto const s =
+            static_cast<float>(st.s) / static_cast<float>(hdr_.skinwidth);
+        auto const t =
+            static_cast<float>(st.t) / static_cast<float>(hdr_.skinheight);
+        vertex_map_.push_back(xyz_index);
+        scaled_texcoords_.emplace_back(s, t);
+    };
+
+    if (layout_ == Layout::triangle_list) {
+        for (auto const& triangle : triangles_) {
+            for (size_t i = 0; i < 3; ++i) {
+                emit(gsl_lite::at(triangle.vertex, i),
+                     gsl_lite::at(triangle.st, i));
+            }
+        }
+        return;
+    }
+
+    // num_tris * 3 <= 12288 so the unique vertex count always fits a uint16
+    static_assert(MD2Model::max_tris * 3 <=
+                  std::numeric_limits<uint16_t>::max());
+    std::unordered_map<uint32_t, uint16_t> welded;
+    welded.reserve(num_corners);
+    indices_.reserve(num_corners);
+
+    for (auto const& triangle : triangles_) {
+        for (size_t i = 0; i < 3; ++i) {
+            auto const xyz_index = gsl_lite::at(triangle.vertex, i);
+            auto const st_index = gsl_lite::at(triangle.st, i);
+            auto const key = (static_cast<uint32_t>(xyz_index) << 16U) |
+                             static_cast<uint32_t>(st_index);
+            auto const next =
+                gsl_lite::narrow_cast<uint16_t>(vertex_map_.size());
+            auto const [iter, inserted] = welded.try_emplace(key, next);
+            if (inserted) {
+                emit(xyz_index, st_index);
+            }
+            indices_.push_back(iter->second);
+        }
+    }
+
+    spdlog::debug("welded {} triangle corners into {} vertices", num_corners,
+                  vertex_map_.size());
+    optimize_vertex_cache();
+}
+
+void MD2Model::optimize_vertex_cache() {
+    // the file's triangle order is whatever the modelling tool left, so
+    // reorder triangles for the post-transform cache, then renumber the
+    // vertices so the blend and the GPU read them in order. key frames are
+    // built from vertex_map_ afterwards and follow along
+    auto const before = VertexCache::analyze(indices_, vertex_map_.size());
+    VertexCache::optimize_triangles(indices_, vertex_map_.size());
+    auto const order =
+        VertexCache::optimize_fetch(indices_, vertex_map_.size());
+    VertexCache::remap(vertex_map_, order);
+    VertexCache::remap(scaled_texcoords_, order);
+    auto const after = VertexCache::analyze(indices_, vertex_map_.size());
+    spdlog::info("vertex cache: acmr {:.3f} -> {:.3f}, atvr {:.3f} -> {:.3f}",
+                 before.acmr, after.acmr, before.atvr, after.atvr);
+}
+
+bool MD2Model::load_gl_commands(std::span<std::byte const> data) {
+    // a command is an int32 vertex count, positive for a strip and negative
+    // for a fan, followed by that many {float s, float t, int32 xyz index}
+    // records; a count of 0 ends the list. the texcoords are already
+    // normalised, so unlike build_layout nothing is divided by the skin size
+    static_assert(sizeof(float) == sizeof(int32_t));
+    auto const bytes = section(data, hdr_.offset_glcmds, hdr_.num_glcmds,
+                               sizeof(int32_t));
+    if (!bytes) {
+        spdlog::error("md2 gl command section out of bounds");
+        return false;
+    }
+
+    std::vector<int32_t> words;
+    copy_section(*bytes, words);
+    vertex_map_.clear();
+    scaled_texcoords_.clear();
+    batches_.clear();
+
+    static constexpr size_t words_per_vertex = 3;
+    size_t pos = 0;
+    while (pos < words.size() && words[pos] != 0) {
+        auto const count = words[pos++];
+        auto const primitive =
+            count < 0 ? Primitive::triangle_fan : Primitive::triangle_strip;
+        auto const length = count < 0 ? -static_cast<int64_t>(count)
+                                      : static_cast<int64_t>(count);
+        if (length < 3 || std::cmp_greater(length * words_per_vertex,
+                                           words.size() - pos)) {
+            spdlog::error("md2 gl command of {} vertices out of bounds", count);
+            return false;
+        }
+
+        batches_.push_back({.first = gsl_lite::narrow<uint32_t>(
+                                vertex_map_.size()),
+                            .count = static_cast<uint32_t>(length),
+                            .primitive = primitive});
+        for (int64_t i = 0; i < length; ++i, pos += words_per_vertex) {
+            float s{};
+            float t{};
+            std::memcpy(&s, &words[pos], sizeof(s));
+            std::memcpy(&t, &words[pos + 1], sizeof(t));
+            auto const xyz_index = words[pos + 2];
+            if (xyz_index < 0 || xyz_index >= hdr_.num_xyz) {
+                spdlog::error("md2 gl command index out of range");
+                return false;
+            }
+            vertex_map_.push_back(static_cast<uint16_t>(xyz_index));
+            scaled_texcoords_.emplace_back(s, t);
+        }
+    }
+
+    if (batches_.empty()) {
+        spdlog::error("md2 gl command section is empty");
+        return false;
+    }
+
+    spdlog::debug("{} gl commands over {} vertices", batches_.size(),
+                  vertex_map_.size());
+    return true;
+}
+
+bool MD2Model::load_frames(std::span<std::byte const> data) {
+    // each frame is a fixed 40 byte preamble followed by num_xyz vertices
+    static constexpr size_t frame_preamble = 40;
+    auto const frame_size = static_cast<size_t>(hdr_.framesize);
+    if (frame_size < frame_preamble + (sizeof(Vertex) * hdr_.num_xyz)) {
+        spdlog::error("md2 framesize {} too small", hdr_.framesize);
+        return false;
+    }
+
+    auto const bytes =
+        section(data, hdr_.offset_frames, hdr_.num_frames, frame_size);
+    if (!bytes) {
+        spdlog::error("md2 frame section out of bounds");
+        return false;
+    }
+
+    // compact storage keeps the quantized frames; unpacked storage decodes
+    // each one straight out of the file into the key frames instead
+    auto const compact = storage_ == Storage::compact;
+    if (compact) {
+        frames_.resize(hdr_.num_frames);
+    } else {
+        key_frames_.clear();
+        key_frames_.reserve(static_cast<size_t>(hdr_.num_frames) *
+                            vertex_map_.size());
+    }
+    Frame header;
+
+    Animation current_anim;
+    current_anim.start_frame = -1;
+
+    for (auto i = 0; i < hdr_.num_frames; ++i) {
+        auto& frame = compact ? frames_[i] : header;
+        auto const src = bytes->subspan(i * frame_size, frame_size);
+        auto const vertices = src.subspan(
+            frame_preamble, sizeof(Vertex) * static_cast<size_t>(hdr_.num_xyz));
+
+        std::memcpy(frame.scale.data(), src.data(), sizeof(frame.scale));
+        std::memcpy(frame.translate.data(), src.data() + 12,
+                    sizeof(frame.translate));
+        std::memcpy(frame.name.data(), src.data() + 24, sizeof(frame.name));
+        if (compact) {
+            // same # of vertices for each keyframe
+            copy_section(vertices, frame.vertices);
+        } else {
+            // the scaled vertices for each output vertex of the layout (see
+            // build_layout), paired with the texcoords shared by all frames
+            for (auto const vertex_index : vertex_map_) {
+                assert(vertex_index < static_cast<size_t>(hdr_.num_xyz));
+                Vertex vertex{};
+                std::memcpy(&vertex,
+                            vertices.data() + (vertex_index * sizeof(Vertex)),
+                            sizeof(vertex));
+                key_frames_.push_back(dequantize(frame, vertex));
+            }
+        }
+
+        std::string anim_id =
+            animation_id_from_frame_name(fixed_string(frame.name));
+
+        if (current_anim.name == anim_id) {
+            current_anim.end_frame = i;
+        } else {
+            if (current_anim.start_frame != -1) {
+                animation_index_map_[current_anim.name] = animations_.size();
+                animations_.push_back(current_anim);
+            }
+
+            current_anim.start_frame = i;
+            current_anim.end_frame = i;
+            current_anim.name = anim_id;
+        }
+    }
+
+    assert(compact ? frames_.size() == static_cast<size_t>(hdr_.num_frames)
+                   : key_frames_.size() ==
+                         static_cast<size_t>(hdr_.num_frames) *
+                             vertex_map_.size());
+
+    if (current_anim.start_frame != -1) {
+        animation_index_map_[current_anim.name] = animations_.size();
+        animations_.push_back(current_anim);
+    }
+
+    for (auto const& anim : animations_) {
+        spdlog::debug("animation: {}", anim);
+    }
+
+    return true;
+}
+
+size_t MD2Model::memory_usage() const {
+    auto bytes = sizeof(*this) + capacity_bytes(triangles_) +
+                 capacity_bytes(texcoords_) + capacity_bytes(frames_) +
+                 capacity_bytes(key_frames_) +
+                 capacity_bytes(scaled_texcoords_) +
+                 capacity_bytes(vertex_map_) + capacity_bytes(indices_) +
+                 capacity_bytes(batches_) + capacity_bytes(skins_) +
+                 capacity_bytes(animations_);
+
+    for (auto const& frame : frames_) {
+        bytes += capacity_bytes(frame.vertices);
+    }
+    return bytes;
+}
+
+std::optional<size_t> MD2Model::find_animation(std::string const& id) const {
+    auto const iter = animation_index_map_.find(id);
+    if (iter == animation_index_map_.end()) {
+        return std::nullopt;
+    }
+    return iter->second;
+}
+
+std::span<glm::vec3 const> MD2Model::key_frame(int index) const {
+    auto const count = vertex_map_.size();
+    auto const offset = gsl_lite::narrow<size_t>(index) * count;
+    gsl_Expects(offset + count <= key_frames_.size());
+    return std::span<glm::vec3 const>{key_frames_}.subspan(offset, count);
+}
+
+void MD2Model::blend(FrameBlend const& frames,
+                     std::span<glm::vec3> out) const {
+    auto const count = vertex_map_.size();
+    auto const t = frames.t;
+    gsl_Expects(out.size() == count);
+
+    if (storage_ == Storage::compact) {
+        // decode just the two frames being blended straight into the output
+        // so no float frame is ever held; same expression as the lerp kernel
+        auto const& f1 = gsl_lite::at(frames_, frames.current);
+        auto const& f2 = gsl_lite::at(frames_, frames.next);
+        auto const s = 1.0f - t;
+        for (size_t i = 0; i < count; ++i) {
+            auto const xyz = vertex_map_[i];
+            out[i] = (dequantize(f1, f1.vertices[xyz]) * s) +
+                     (dequantize(f2, f2.vertices[xyz]) * t);
+        }
+        return;
+    }
+
+    SIMD::lerp(as_floats(key_frame(frames.current)),
+               as_floats(key_frame(frames.next)), t, as_floats(out));
+}
+
+std::ostream& operator<<(std::ostream& os, MD2Model::Animation const& anim) {
+    os << '\n'
+       << "id:    " << anim.name << '\n'
+       << "start: " << anim.start_frame << '\n'
+       << "end:   " << anim.end_frame << '\n'
+       << "loop:  " << std::boolalpha << anim.loop << '\n';
+
+    return os;
+}
+
+std::ostream& operator<<(std::ostream& os, MD2Model::Header const& hdr) {
+    os << '\n'
+       << "ident:         " << hdr.ident << '\n'
+       << "version:       " << hdr.version << '\n'
+       << "skinwidth:     " << hdr.skinwidth << '\n'
+       << "skinheight:    " << hdr.skinheight << '\n'
+       << "framesize:     " << hdr.framesize << '\n'
+       << "num_skins:     " << hdr.num_skins << '\n'
+       << "num_xyz:       " << hdr.num_xyz << '\n'
+       << "num_st:        " << hdr.num_st << '\n'
+       << "num_tris:      " << hdr.num_tris << '\n'
+       << "num_glcmds:    " << hdr.num_glcmds << '\n'
+       << "num_frames:    " << hdr.num_frames << '\n'
+       << "offset_skins:  " << hdr.offset_skins << '\n'
+       << "offset_st:     " << hdr.offset_st << '\n'
+       << "offset_tris:   " << hdr.offset_tris << '\n'
+       << "offset_frames: " << hdr.offset_frames << '\n'
+       << "offset_glcmds: " << hdr.offset_glcmds << '\n'
+       << "offset_end:    " << hdr.offset_end;
+
+    return os;
+}
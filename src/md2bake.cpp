@@ -0,0 +1,100 @@
+// Prebuild the baked model cache for every model in a PAK.
+//
+// Usage: md2bake [--cache dir] [--compact-frames] [--gl-commands] <pak>...
+//
+// Mounts the PAKs and game directories in order, as the viewer's --pak does,
+// and bakes each visible .md2 entry the way the viewer loads it (indexed
+// layout, or GL commands with --gl-commands), so the first launch reads .md2c
+// files instead of parsing models.
+// Entries whose cache file is already current are skipped.
+#include "md2view/md2_model.hpp"
+#include "md2view/model_cache.hpp"
+#include "md2view/vfs.hpp"
+#include "md2view/thread_pool.hpp"
+
+#include <boost/program_options.hpp>
+#include <fmt/core.h>
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char* argv[]) try {
+    namespace po = boost::program_options;
+
+    std::vector<std::string> pak_paths;
+    std::string cache_dir = "data/cache";
+    bool compact_frames = false;
+    bool gl_commands = false;
+
+    po::options_description options("md2bake options");
+    options.add_options()("help,h", "Show help")(
+        "cache", po::value<std::string>(&cache_dir),
+        "Directory to write .md2c files to")(
+        "compact-frames", po::bool_switch(&compact_frames),
+        "Bake for a viewer run with --compact-frames")(
+        "gl-commands", po::bool_switch(&gl_commands),
+        "Bake for a viewer run with --gl-commands")(
+        "pak", po::value<std::vector<std::string>>(&pak_paths)->required(),
+        "PAK files or game directories to mount and bake");
+    po::positional_options_description positional;
+    positional.add("pak", -1);
+
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc, argv)
+                  .options(options)
+                  .positional(positional)
+                  .run(),
+              vm);
+    if (vm.count("help") != 0U) {
+        std::cout << options << '\n';
+        return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+
+    // the loaders log at info level for every model
+    spdlog::set_level(spdlog::level::warn);
+
+    // game directories reuse the viewer's saved indexes
+    VFS const vfs{std::vector<std::filesystem::path>(pak_paths.begin(),
+                                                     pak_paths.end()),
+                  std::filesystem::path{cache_dir}};
+    ModelCache const cache{cache_dir};
+    auto const storage = compact_frames ? MD2Model::Storage::compact
+                                        : MD2Model::Storage::unpacked;
+    auto const layout = gl_commands ? MD2Model::Layout::gl_commands
+                                    : MD2Model::Layout::indexed;
+
+    std::vector<std::string> entries;
+    for (auto const& node : vfs.models()) {
+        entries.emplace_back(node.path);
+    }
+
+    std::atomic<size_t> baked{0};
+    std::atomic<size_t> failed{0};
+    ThreadPool pool;
+    pool.parallel_for(entries.size(), 1, [&](size_t begin, size_t end) {
+        for (auto i = begin; i < end; ++i) {
+            try {
+                if (cache.bake(vfs, entries[i], layout, storage)) {
+                    ++baked;
+                }
+            } catch (std::exception const& e) {
+                spdlog::error("{}: {}", entries[i], e.what());
+                ++failed;
+            }
+        }
+    });
+
+    fmt::print("{} models: {} baked, {} current, {} failed\n", entries.size(),
+               baked.load(), entries.size() - baked - failed, failed.load());
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+} catch (std::exception const& e) {
+    fmt::print(stderr, "md2bake: {}\n", e.what());
+    return EXIT_FAILURE;
+}
@@ -10,13 +10,64 @@
 #include <algorithm>
 #include <array>
 #include <cstdint>
+#include <exception>
+#include <optional>
+#include <utility>
+#include <vector>
 
 MD2View::MD2View() { reset_model_matrix(); }
 
 void MD2View::load_model(GL::Engine<MD2View>& engine) {
-    md2_ = engine.resource_manager().load_model(model_selector_->model_path());
+    install_model(
+        engine.resource_manager().load_model(model_selector_->model_path()));
+}
+
+void MD2View::install_model(std::shared_ptr<MD2Model const> model_data) {
+    md2_ = std::make_unique<MD2Instance>(std::move(model_data));
+    auto const& model = md2_->model();
     md2_mesh_ = std::make_unique<GL::Mesh>(md2_->interpolated_vertices(),
-                                           md2_->scaled_texcoords());
+                                           model.scaled_texcoords(),
+                                           model.indices());
+    if (!model.batches().empty()) {
+        std::vector<GL::Mesh::Batch> batches;
+        batches.reserve(model.batches().size());
+        for (auto const& batch : model.batches()) {
+            batches.push_back(
+                {.mode = batch.primitive == MD2Model::Primitive::triangle_fan
+                             ? GLenum{GL_TRIANGLE_FAN}
+                             : GLenum{GL_TRIANGLE_STRIP},
+                 .first = gsl_lite::narrow<GLint>(batch.first),
+                 .count = gsl_lite::narrow<GLsizei>(batch.count)});
+        }
+        md2_mesh_->set_batches(batches);
+    }
+    // compact models have no unpacked key frames and always blend on the
+    // cpu, as do models with more key frame data than a texture buffer holds
+    if (!model.key_frames().empty()) {
+        md2_mesh_->upload_key_frames(model.key_frames());
+    }
+}
+
+bool MD2View::gpu_morph_active() const {
+    return gpu_morph_ && md2_mesh_->has_key_frames();
+}
+
+void MD2View::set_morph_uniforms() const {
+    shader_->use();
+    auto const active = gpu_morph_active();
+    GL::Shader::set_uniform(morph_loc_, GLint{active ? 1 : 0});
+    if (!active) {
+        return;
+    }
+
+    auto const blend = md2_->frame_blend();
+    auto const frame_size =
+        gsl_lite::narrow<GLint>(md2_->model().vertex_count());
+    GL::Shader::set_uniform(current_frame_offset_loc_,
+                            GLint{blend.current * frame_size});
+    GL::Shader::set_uniform(next_frame_offset_loc_,
+                            GLint{blend.next * frame_size});
+    GL::Shader::set_uniform(blend_loc_, blend.t);
 }
 
 void MD2View::reset_model_matrix() {
@@ -32,21 +83,37 @@ void MD2View::reset_camera() { camera_.reset(glm::vec3(0.0f, 0.0f, 3.0f)); }
 
 void MD2View::load_current_texture(GL::Engine<MD2View>& engine) {
     auto const& path = md2_->current_skin().fpath;
-    texture_ = engine.resource_manager().load_texture2D(path);
+    set_texture(engine.resource_manager().load_texture2D(path));
+}
+
+void MD2View::set_texture(std::shared_ptr<GL::Texture2D> texture) {
+    texture_ = std::move(texture);
+    shader_->use();
+    GL::Shader::set_uniform(indexed_loc_, GLint{texture_->indexed() ? 1 : 0});
 }
 
 bool MD2View::on_engine_initialized(GL::Engine<MD2View>& engine) {
-    if (!engine.resource_manager().pak().has_models()) {
+    if (!engine.resource_manager().vfs().has_models()) {
         // NB: converting filesystem path to string in format arg
         // to work-around clang-tidy issue from libfmt:
         // https://github.com/fmtlib/fmt/issues/4552
-        spdlog::error("PAK '{}' has no MD2 models to view",
-                      engine.resource_manager().pak().fpath().string());
+        for (auto const& pak : engine.resource_manager().vfs().mounts()) {
+            spdlog::error("no MD2 models to view in '{}'",
+                          pak->fpath().string());
+        }
         return false;
     }
+    auto& profiler = engine.profiler();
+    stages_ = {.uploads = profiler.stage("uploads"),
+               .animate = profiler.stage("animate"),
+               .sync = profiler.stage("sync"),
+               .main_pass = profiler.stage("main pass"),
+               .post = profiler.stage("post"),
+               .ui = profiler.stage("ui")};
+
     // init objects which needed an opengl context to initialize
     model_selector_ =
-        std::make_unique<ModelSelector>(engine.resource_manager().pak());
+        std::make_unique<ModelSelector>(engine.resource_manager().vfs());
     load_model(engine);
     blur_fb_ = std::make_unique<GL::FrameBuffer>(engine.width(),
                                                  engine.height(), 1, false);
@@ -61,10 +128,22 @@ bool MD2View::on_engine_initialized(GL::Engine<MD2View>& engine) {
     shader_ = engine.resource_manager().load_shader("md2");
     shader_->use();
     update_model();
+    indexed_loc_ = shader_->uniform_location("indexed");
+    GL::Shader::set_uniform(
+        shader_->uniform_location("palette"),
+        gsl_lite::narrow_cast<GLint>(GL::Texture2D::palette_texture_unit));
     load_current_texture(engine);
     glow_loc_ = shader_->uniform_location("glow_color");
     glow_color_ = glm::vec3(0.0f, 1.0f, 0.0f);
     GL::Shader::set_uniform(glow_loc_, glow_color_);
+    morph_loc_ = shader_->uniform_location("morph");
+    current_frame_offset_loc_ =
+        shader_->uniform_location("current_frame_offset");
+    next_frame_offset_loc_ = shader_->uniform_location("next_frame_offset");
+    blend_loc_ = shader_->uniform_location("blend");
+    GL::Shader::set_uniform(
+        shader_->uniform_location("key_frames"),
+        gsl_lite::narrow_cast<GLint>(GL::Mesh::key_frame_texture_unit));
 
     blur_shader_ = engine.resource_manager().load_shader("blur", "screen");
     blur_shader_->use();
@@ -150,6 +229,8 @@ void MD2View::render(GL::Engine<MD2View>& engine) {
     texture_->bind();
 
     // render normal frame
+    std::optional<GL::GpuTimer::Scope> timer;
+    timer.emplace(engine.gpu_timer(), stages_.main_pass);
     main_fb_->bind();
     std::array<GLenum, 2> draw_buffers{GL_COLOR_ATTACHMENT0,
                                        GL_COLOR_ATTACHMENT1};
@@ -162,10 +243,13 @@ void MD2View::render(GL::Engine<MD2View>& engine) {
     glCheckError();
 
     glClear(GL_DEPTH_BUFFER_BIT);
+    set_morph_uniforms();
     md2_mesh_->draw(*shader_);
 
     glCheckError();
 
+    // emplace ends the main pass query before the post one starts
+    timer.emplace(engine.gpu_timer(), stages_.post);
     if (glow_) {
         // blur solid image
         blur_fb_->bind();
@@ -197,8 +281,13 @@ void MD2View::render(GL::Engine<MD2View>& engine) {
         screen_quad_->draw(*blur_shader_);
     }
 
+    timer.reset();
+
     glCheckError();
-    draw_ui(engine);
+    {
+        FrameProfiler::Scope const ui_timer{engine.profiler(), stages_.ui};
+        draw_ui(engine);
+    }
     glCheckError();
 }
 
@@ -266,6 +355,16 @@ void MD2View::draw_ui(GL::Engine<MD2View>& engine) {
             load_current_texture(engine);
         }
 
+        if (md2_mesh_->has_key_frames()) {
+            ImGui::Checkbox("GPU morph", &gpu_morph_);
+        } else {
+            ImGui::TextDisabled("GPU morph unavailable (compact keyframes)");
+        }
+        ImGui::Text("Vertex streaming: %s",
+                    md2_mesh_->streaming() == GL::Mesh::Streaming::persistent
+                        ? "persistent mapped ring"
+                        : "glBufferSubData");
+
         ImGui::Text("Model");
         ImGui::PushItemWidth(vec4width);
         static std::array model_ids = {"model##00", "model##1", "model##2",
@@ -321,21 +420,114 @@ void MD2View::draw_ui(GL::Engine<MD2View>& engine) {
 
     if (ImGui::TreeNodeEx("Select Model", ImGuiTreeNodeFlags_DefaultOpen)) {
         if (model_selector_->draw_ui()) {
-            load_model(engine);
-            load_current_texture(engine); // skin may have changed
+            // keep drawing the current model until the new one and its skin
+            // are ready; see poll_pending_model()
+            pending_ = PendingModel{engine.resource_manager().load_model_async(
+                                        model_selector_->model_path()),
+                                    {}};
+        }
+        if (pending_) {
+            ImGui::TextDisabled("Loading...");
         }
         ImGui::TreePop();
     }
+
+    if (ImGui::TreeNodeEx("Profiler")) {
+        UI::draw(engine.profiler());
+        ImGui::TreePop();
+    }
+
+    if (ImGui::TreeNodeEx("Resources")) {
+        auto const& resources = engine.resource_manager();
+        draw_cache_ui(resources.model_cache());
+        draw_cache_ui(resources.texture_cache());
+        ImGui::TreePop();
+    }
     ImGui::End();
 }
 
+template <typename T> void MD2View::draw_cache_ui(LruCache<T> const& cache) {
+    constexpr float bytes_per_mib = 1024.0f * 1024.0f;
+    auto const& stats = cache.stats();
+    ImGui::Text("%s cache: %zu entries, %.1f MiB", cache.name().c_str(),
+                cache.size(),
+                static_cast<float>(cache.bytes()) / bytes_per_mib);
+    if (cache.budget() != LruCache<T>::unlimited) {
+        ImGui::SameLine();
+        ImGui::Text("of %.1f MiB",
+                    static_cast<float>(cache.budget()) / bytes_per_mib);
+    }
+    ImGui::Text("  hits %zu, misses %zu, evictions %zu", stats.hits,
+                stats.misses, stats.evictions);
+}
+
 void MD2View::set_vsync() const { glfwSwapInterval(vsync_enabled_ ? 1 : 0); }
 
-void MD2View::update(GL::Engine<MD2View>& /* engine */, GLfloat delta_time) {
-    md2_->update(delta_time);
+void MD2View::poll_pending_model(GL::Engine<MD2View>& engine) {
+    if (!pending_) {
+        return;
+    }
+
+    try {
+        if (!pending_->texture.valid()) {
+            if (!is_ready(pending_->model)) {
+                return;
+            }
+            auto const& model = pending_->model.get();
+            pending_->texture = engine.resource_manager().load_texture2D_async(
+                gsl_lite::at(model->skins(), 0).fpath);
+        }
+        if (!is_ready(pending_->texture)) {
+            return;
+        }
+        install_model(pending_->model.get());
+        set_texture(pending_->texture.get());
+    } catch (std::exception const& e) {
+        spdlog::error("failed to load {}: {}", model_selector_->model_path(),
+                      e.what());
+    }
+    pending_.reset();
+}
+
+void MD2View::advance(GL::Engine<MD2View>& engine, GLfloat delta_time) {
+    FrameProfiler::Scope const timer{engine.profiler(), stages_.animate};
+    md2_->advance(delta_time);
+}
+
+void MD2View::update(GL::Engine<MD2View>& engine) {
+    auto& profiler = engine.profiler();
+    {
+        GL::GpuTimer::Scope const timer{engine.gpu_timer(), stages_.uploads};
+        engine.resource_manager().process_uploads();
+        poll_pending_model(engine);
+    }
+
+    if (gpu_morph_active()) {
+        // the vertex shader blends the key frames from the frame pair and
+        // blend factor set in render()
+        return;
+    }
+
+    if (md2_mesh_->streaming() == GL::Mesh::Streaming::persistent) {
+        // blend straight into the mapped ring region the next draw reads
+        FrameProfiler::Scope const timer{profiler, stages_.animate};
+        md2_->blend(md2_mesh_->next_vertices());
+        return;
+    }
+
+    {
+        FrameProfiler::Scope const timer{profiler, stages_.animate};
+        md2_->blend();
+    }
+    GL::GpuTimer::Scope const timer{engine.gpu_timer(), stages_.sync};
     md2_mesh_->sync(md2_->interpolated_vertices());
 }
 
+bool MD2View::idle() const {
+    return !pending_ && !camera_.view_dirty() && !camera_.fov_dirty() &&
+           !md2_->animating();
+}
+
 void MD2View::process_input(GL::Engine<MD2View>& engine, GLfloat delta_time) {
     if (engine.keys()[GLFW_KEY_W]) {
         camera_.move(Camera::Direction::FORWARD, delta_time);
@@ -0,0 +1,198 @@
+#include "md2view/model_cache.hpp"
+
+#include "md2view/hash.hpp"
+#include "md2view/mapped_file.hpp"
+#include "md2view/vfs.hpp"
+
+#include <fmt/format.h>
+#include <gsl-lite/gsl-lite.hpp>
+#include <spdlog/spdlog.h>
+
+#include <array>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+namespace {
+
+/// True if @p bytes starts with a baked header for @p source_key built with
+/// @p layout and @p storage. The rest of the file is checked when loaded.
+/// A model without GL commands falls back to a triangle list, so that is
+/// what its `Layout::gl_commands` bake holds.
+bool is_current(std::span<std::byte const> bytes,
+                uint64_t source_key,
+                MD2Model::Layout layout,
+                MD2Model::Storage storage) {
+    MD2Model::BakedHeader header{};
+    if (bytes.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    return header.magic == MD2Model::baked_magic &&
+           header.version == MD2Model::baked_version &&
+           header.source_key == source_key &&
+           (header.layout == static_cast<uint8_t>(layout) ||
+            (layout == MD2Model::Layout::gl_commands &&
+             header.layout ==
+                 static_cast<uint8_t>(MD2Model::Layout::triangle_list))) &&
+           header.storage == static_cast<uint8_t>(storage);
+}
+
+} // namespace
+
+ModelCache::ModelCache(std::filesystem::path dir)
+    : dir_{std::move(dir)} {}
+
+std::filesystem::path ModelCache::path(VFS const& vfs,
+                                       std::string const& entry,
+                                       MD2Model::Layout layout,
+                                       MD2Model::Storage storage) const {
+    auto const* resolved = vfs.resolve(entry);
+    gsl_Expects(resolved != nullptr);
+    auto const pak_path = std::filesystem::absolute(resolved->pak->fpath())
+                              .lexically_normal()
+                              .generic_string();
+    auto key = Hash::fnv1a_64(pak_path);
+    key = Hash::fnv1a_64(std::string_view{"\0", 1}, key);
+    key = Hash::fnv1a_64(entry, key);
+    std::array const build = {static_cast<std::byte>(layout),
+                              static_cast<std::byte>(storage)};
+    key = Hash::fnv1a_64(build, key);
+    return dir_ / fmt::format("{:016x}{}", key, extension);
+}
+
+uint64_t ModelCache::source_key(VFS const& vfs, std::string const& entry) {
+    auto const* resolved = vfs.resolve(entry);
+    gsl_Expects(resolved != nullptr);
+    auto const& pak = *resolved->pak;
+
+    // a failed stat leaves its field at -1; the load that follows fails
+    // on the missing file anyway
+    std::error_code ec;
+    auto const mtime = [&ec](std::filesystem::path const& path) {
+        auto const time = std::filesystem::last_write_time(path, ec);
+        return ec ? int64_t{-1}
+                  : static_cast<int64_t>(time.time_since_epoch().count());
+    };
+    if (!pak.is_directory()) {
+        // an entry only changes when the archive is rewritten, and skins in
+        // an archive are taken verbatim from the skin table
+        std::array const fields = {
+            static_cast<int64_t>(resolved->node.filepos),
+            static_cast<int64_t>(resolved->node.filelen), mtime(pak.fpath())};
+        return Hash::fnv1a_64(std::as_bytes(std::span{fields}));
+    }
+
+    auto const path = pak.fpath() / entry;
+    auto const size = std::filesystem::file_size(path, ec);
+    std::array const fields = {
+        ec ? int64_t{-1} : static_cast<int64_t>(size), mtime(path)};
+    auto key = Hash::fnv1a_64(std::as_bytes(std::span{fields}));
+    // MD2Model resolves the skins of a loose file from its directory
+    auto const dir =
+        std::filesystem::path{entry}.parent_path().generic_string();
+    for (auto const& node : vfs.directory(dir)) {
+        key = Hash::fnv1a_64(node.path, key);
+        key = Hash::fnv1a_64(std::string_view{"\0", 1}, key);
+    }
+    return key;
+}
+
+std::shared_ptr<MD2Model const>
+ModelCache::load(VFS const& vfs,
+                 std::string const& entry,
+                 MD2Model::Layout layout,
+                 MD2Model::Storage storage) const {
+    auto const key = source_key(vfs, entry);
+    auto const cache_path = path(vfs, entry, layout, storage);
+    if (auto model = read(cache_path, key, layout, storage)) {
+        spdlog::info("loaded model {} from {}", entry, cache_path.string());
+        return model;
+    }
+
+    auto model = std::make_shared<MD2Model const>(entry, vfs, layout, storage);
+    try {
+        write(cache_path, *model, key);
+    } catch (std::exception const& e) {
+        spdlog::warn("failed to cache model {}: {}", entry, e.what());
+    }
+    return model;
+}
+
+bool ModelCache::bake(VFS const& vfs,
+                      std::string const& entry,
+                      MD2Model::Layout layout,
+                      MD2Model::Storage storage) const {
+    auto const key = source_key(vfs, entry);
+    auto const cache_path = path(vfs, entry, layout, storage);
+    if (std::filesystem::exists(cache_path) &&
+        is_current(MappedFile{cache_path}.bytes(), key, layout, storage)) {
+        return false;
+    }
+
+    MD2Model const model{entry, vfs, layout, storage};
+    write(cache_path, model, key);
+    return true;
+}
+
+std::shared_ptr<MD2Model const>
+ModelCache::read(std::filesystem::path const& path,
+                 uint64_t key,
+                 MD2Model::Layout layout,
+                 MD2Model::Storage storage) {
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) {
+        return {};
+    }
+
+    try {
+        MappedFile const file{path};
+        if (!is_current(file.bytes(), key, layout, storage)) {
+            spdlog::info("cached model {} is stale", path.string());
+            return {};
+        }
+        return std::make_shared<MD2Model const>(MD2Model::Baked{},
+                                                file.bytes());
+    } catch (std::exception const& e) {
+        spdlog::warn("ignoring cached model {}: {}", path.string(), e.what());
+        return {};
+    }
+}
+
+void ModelCache::write(std::filesystem::path const& path,
+                       MD2Model const& model,
+                       uint64_t key) const {
+    std::filesystem::create_directories(dir_);
+
+    // unique per thread so concurrent bakes of one model never interleave;
+    // whichever rename lands last wins with an identical file
+    auto tmp_path = path;
+    tmp_path += fmt::format(
+        ".{:x}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    {
+        std::ofstream os{tmp_path, std::ios::binary | std::ios::trunc};
+        model.write_baked(os, key);
+        os.close();
+        if (!os) {
+            std::filesystem::remove(tmp_path);
+            throw std::runtime_error("failed to write " + tmp_path.string());
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec) {
+        std::filesystem::remove(tmp_path);
+        throw std::runtime_error(
+            fmt::format("failed to rename {}: {}", tmp_path.string(),
+                        ec.message()));
+    }
+    spdlog::info("baked model to {}", path.string());
+}
@@ -1,85 +1,52 @@
 #include "md2view/model_selector.hpp"
-#include "md2view/pak.hpp"
+#include "md2view/vfs.hpp"
 
 #include <gsl-lite/gsl-lite.hpp>
 #include <imgui.h>
 #include <spdlog/spdlog.h>
 
-#include <algorithm>
-#include <stack>
+#include <optional>
+#include <span>
+#include <utility>
 
-void ModelSelector::add_node(std::filesystem::path const& path) {
-    auto parent = tree_.begin();
-    spdlog::debug("add node for {}", path.string());
-    gsl_Assert(path.extension() == ".md2");
-    // pak seperator is always '/'
-    auto const* const sep = "/";
-
-    std::string curr;
-    for (auto const& part : path) {
-        if (!curr.empty()) {
-            curr.append(sep);
-        }
-        curr += part.string();
-        auto fullpath = curr;
-        auto child = std::find_if(parent, tree_.end(), [&](auto const& node) {
-            return node.path == fullpath;
-        });
-
-        if (child == tree_.end()) {
-            Node newNode;
-            newNode.name = part.string();
-            newNode.path = fullpath;
-            spdlog::debug("new model node {} {} {}", newNode.name, newNode.path,
-                          parent->name);
-            child = tree_.append_child(parent, std::move(newNode));
-        }
-        parent = child;
-    }
-}
-
-void ModelSelector::init(PAK const& pak) {
-    selected_ = tree_.end();
-
-    Node node;
-    node.path = pak.fpath().string();
-    node.name = node.path;
-    tree_.insert(tree_.begin(), std::move(node));
-
-    for (auto const& pak_entry : pak.models()) {
-        add_node(pak_entry.path);
+void ModelSelector::init(VFS const& vfs) {
+    tree_ = ModelTree{vfs.mounts().back()->fpath().string()};
+    for (auto const& model : vfs.models()) {
+        tree_.add(model.path);
     }
+    spdlog::info("model selector: {} models, {} nodes", tree_.leaves().size(),
+                 tree_.size());
 
     select_random_model();
 }
 
 std::string ModelSelector::model_path() const {
-    if (selected_ == tree_.end()) {
+    if (selected_ == ModelTree::npos) {
         return {};
     }
-    return selected_->path;
+    return tree_.node(selected_).path;
 }
 
 void ModelSelector::select_random_model() {
     spdlog::info("selecting random model");
 
-    std::vector<tree<Node>::iterator> iters;
-    for (auto i = tree_.begin_leaf(); i != tree_.end_leaf(); ++i) {
-        if (i != selected_) {
-            iters.emplace_back(i);
-        }
-    }
-
-    if (iters.empty()) {
+    auto const leaves = tree_.leaves();
+    auto const skip_selected = selected_ != ModelTree::npos;
+    if (leaves.size() <= (skip_selected ? 1U : 0U)) {
         return;
     }
 
-    std::uniform_int_distribution<> dist(
-        0, gsl_lite::narrow_cast<int>(iters.size()) - 1);
+    // pick among the others by drawing from one fewer and stepping over the
+    // current selection
+    std::uniform_int_distribution<size_t> dist(
+        0, leaves.size() - (skip_selected ? 2 : 1));
     auto idx = dist(mt_);
-    auto iter = iters[idx];
-    spdlog::info("selected random model='{}' '{}'", iter->path, iter->name);
-    selected_ = iter;
+    if (skip_selected && leaves[idx] == selected_) {
+        idx = leaves.size() - 1;
+    }
+    selected_ = leaves[idx];
+    auto const& node = tree_.node(selected_);
+    spdlog::info("selected random model='{}' '{}'", node.path, node.name);
 }
 
 bool ModelSelector::draw_ui() {
@@ -88,60 +55,76 @@ bool ModelSelector::draw_ui() {
         select_random_model();
         ret = true;
     }
+    ImGui::SameLine();
+    ImGui::TextDisabled("%zu models", tree_.leaves().size());
 
-    using TreeT = tree<Node>;
-
-    // NB: treehh end_fixed does not seem to be working yet
-    // https://github.com/kpeeters/tree.hh/blob/master/src/tree.hh#L854
-    // we need to go down level be level but only push nodes to the stack
-    // if they are expanded in the UI
-    std::stack<TreeT::iterator> stack;
-    stack.push(tree_.begin());
-
-    int lastDepth{0};
-    while (!stack.empty()) {
-        auto curr = stack.top();
-        stack.pop();
-        auto depth = TreeT::depth(curr);
-
-        while (depth < lastDepth) {
-            ImGui::TreePop();
-            --lastDepth;
-        }
-        lastDepth = depth;
-
-        // if curr has no children it is selectable leafat
-        ImGuiTreeNodeFlags flags{0};
-        auto const is_leaf = TreeT::number_of_children(curr) == 0U;
-
-        if (is_leaf) {
-            flags =
-                ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen;
-            if (curr == selected_) {
-                flags |= ImGuiTreeNodeFlags_Selected;
-            }
-        }
+    if (ImGui::InputTextWithHint("##filter", "Filter", filter_.data(),
+                                 filter_.size())) {
+        tree_.set_filter(filter_.data());
+    }
+    auto const filtered = !tree_.filter().empty();
+
+    // expanding or collapsing rebuilds the rows, so wait until they have
+    // all been drawn
+    std::optional<std::pair<uint32_t, bool>> toggle;
+    auto const rows = tree_.rows();
+    auto const height = ImGui::GetTextLineHeightWithSpacing() * list_rows;
+    if (ImGui::BeginChild("##models", ImVec2(0, height),
+                          ImGuiChildFlags_Borders)) {
+        ImGuiListClipper clipper;
+        clipper.Begin(gsl_lite::narrow<int>(rows.size()));
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd;
+                 ++row) {
+                auto const index = rows[static_cast<size_t>(row)];
+                auto const& node = tree_.node(index);
+                // filtered rows are a flat list of full paths
+                auto const indent =
+                    filtered ? 0.0f
+                             : ImGui::GetStyle().IndentSpacing *
+                                   static_cast<float>(node.depth);
+                ImGui::PushID(static_cast<int>(index));
+                if (indent > 0.0f) {
+                    ImGui::Indent(indent);
+                }
 
-        if (depth == 0) {
-            ImGui::SetNextItemOpen(true);
-        }
+                ImGuiTreeNodeFlags flags =
+                    ImGuiTreeNodeFlags_NoTreePushOnOpen |
+                    ImGuiTreeNodeFlags_SpanAvailWidth;
+                if (tree_.is_leaf(index)) {
+                    flags |= ImGuiTreeNodeFlags_Leaf;
+                    if (index == selected_) {
+                        flags |= ImGuiTreeNodeFlags_Selected;
+                    }
+                    ImGui::TreeNodeEx("##node", flags, "%s",
+                                      filtered ? node.path.c_str()
+                                               : node.name.c_str());
+                    if (ImGui::IsItemClicked()) {
+                        spdlog::info("selected model={} {}", node.name,
+                                     node.path);
+                        selected_ = index;
+                        ret = true;
+                    }
+                } else {
+                    ImGui::SetNextItemOpen(node.expanded);
+                    auto const open = ImGui::TreeNodeEx("##node", flags, "%s",
+                                                        node.name.c_str());
+                    if (open != node.expanded) {
+                        toggle.emplace(index, open);
+                    }
+                }
 
-        if (ImGui::TreeNodeEx(curr->name.c_str(), flags)) {
-            if (!is_leaf) {
-                for (auto iter = TreeT::begin(curr); iter != TreeT::end(curr);
-                     ++iter) {
-                    stack.emplace(iter);
+                if (indent > 0.0f) {
+                    ImGui::Unindent(indent);
                 }
-            } else if (ImGui::IsItemClicked()) {
-                spdlog::info("selected model={} {}", curr->name, curr->path);
-                selected_ = curr;
-                ret = true;
+                ImGui::PopID();
             }
         }
     }
-    while (lastDepth > 0) {
-        ImGui::TreePop();
-        --lastDepth;
+    ImGui::EndChild();
+
+    if (toggle) {
+        tree_.set_expanded(toggle->first, toggle->second);
     }
     return ret;
 }
@@ -0,0 +1,136 @@
+#include "md2view/model_tree.hpp"
+
+#include <gsl-lite/gsl-lite.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <utility>
+
+namespace {
+
+std::string to_lower(std::string_view str) {
+    std::string out(str.size(), '\0');
+    std::ranges::transform(str, out.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return out;
+}
+
+} // namespace
+
+ModelTree::ModelTree(std::string root_name) {
+    nodes_.push_back({.name = std::move(root_name),
+                      .path = {},
+                      .parent = npos,
+                      .depth = 0,
+                      .children = {},
+                      .expanded = true});
+}
+
+uint32_t ModelTree::add(std::string_view path) {
+    if (auto const existing = find(path); existing != npos) {
+        return existing;
+    }
+
+    // walk down from the deepest directory that already exists
+    auto slash = path.rfind('/');
+    auto parent = root;
+    while (slash != std::string_view::npos) {
+        if (auto const dir = find(path.substr(0, slash)); dir != npos) {
+            parent = dir;
+            break;
+        }
+        slash = slash == 0 ? std::string_view::npos
+                           : path.rfind('/', slash - 1);
+    }
+    auto start = slash == std::string_view::npos ? 0 : slash + 1;
+    for (auto next = path.find('/', start); next != std::string_view::npos;
+         next = path.find('/', start)) {
+        parent = add_child(parent, path.substr(start, next - start),
+                           path.substr(0, next));
+        start = next + 1;
+    }
+
+    auto const leaf = add_child(parent, path.substr(start), path);
+    leaves_.push_back(leaf);
+    search_paths_.push_back(to_lower(path));
+    return leaf;
+}
+
+uint32_t ModelTree::add_child(uint32_t parent,
+                              std::string_view name,
+                              std::string_view path) {
+    auto const index = gsl_lite::narrow<uint32_t>(nodes_.size());
+    nodes_.push_back({.name = std::string{name},
+                      .path = std::string{path},
+                      .parent = parent,
+                      .depth = nodes_[parent].depth + 1,
+                      .children = {},
+                      .expanded = false});
+    nodes_[parent].children.push_back(index);
+    by_path_.emplace(path, index);
+    rows_dirty_ = true;
+    return index;
+}
+
+uint32_t ModelTree::find(std::string_view path) const {
+    auto const iter = by_path_.find(path);
+    return iter == by_path_.end() ? npos : iter->second;
+}
+
+void ModelTree::set_expanded(uint32_t index, bool expanded) {
+    gsl_Expects(index < nodes_.size());
+    if (nodes_[index].expanded != expanded) {
+        nodes_[index].expanded = expanded;
+        rows_dirty_ = rows_dirty_ || filter_.empty();
+    }
+}
+
+void ModelTree::reveal(uint32_t index) {
+    gsl_Expects(index < nodes_.size());
+    for (auto dir = nodes_[index].parent; dir != npos;
+         dir = nodes_[dir].parent) {
+        set_expanded(dir, true);
+    }
+}
+
+void ModelTree::set_filter(std::string_view filter) {
+    auto lower = to_lower(filter);
+    if (lower != filter_) {
+        filter_ = std::move(lower);
+        rows_dirty_ = true;
+    }
+}
+
+std::span<uint32_t const> ModelTree::rows() {
+    if (rows_dirty_) {
+        build_rows();
+        rows_dirty_ = false;
+    }
+    return rows_;
+}
+
+void ModelTree::build_rows() {
+    rows_.clear();
+    if (!filter_.empty()) {
+        for (size_t i = 0; i < leaves_.size(); ++i) {
+            if (search_paths_[i].find(filter_) != std::string::npos) {
+                rows_.push_back(leaves_[i]);
+            }
+        }
+        return;
+    }
+
+    // depth first, children pushed in reverse so they come off in order
+    std::vector<uint32_t> stack{root};
+    while (!stack.empty()) {
+        auto const index = stack.back();
+        stack.pop_back();
+        rows_.push_back(index);
+        auto const& node = nodes_[index];
+        if (node.expanded) {
+            stack.insert(stack.end(), node.children.rbegin(),
+                         node.children.rend());
+        }
+    }
+}
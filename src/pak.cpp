@@ -1,12 +1,29 @@
 #include "md2view/pak.hpp"
 
+#include "md2view/hash.hpp"
+#include "md2view/thread_pool.hpp"
+#include "md2view/trace.hpp"
+
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
+#include <fmt/format.h>
 #include <gsl-lite/gsl-lite.hpp>
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
+#include <cstring>
+#include <exception>
 #include <fstream>
+#include <functional>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
 
 #pragma pack(push, 1)
 struct Header {
@@ -25,14 +42,79 @@ struct Entry {
 static_assert(sizeof(Header) == 12, "unexpected PackHeader size");
 static_assert(sizeof(Entry) == 64, "unexpected PackFile size");
 
-PAK::PAK(std::filesystem::path fpath)
+namespace {
+
+constexpr uint32_t index_magic = 0x58444950; // "PIDX"
+constexpr uint32_t index_version = 1;
+
+struct IndexHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t dir_count;
+    uint32_t record_count;
+    uint32_t paths_size;
+};
+
+int64_t mtime_ticks(std::filesystem::file_time_type time) {
+    return static_cast<int64_t>(time.time_since_epoch().count());
+}
+
+/// Files and subdirectories of one directory.
+struct Listing {
+    std::vector<std::pair<std::string, uintmax_t>> files;
+    std::vector<std::filesystem::path> subdirs;
+    std::vector<int64_t> mtimes; ///< Of `subdirs`.
+};
+
+/// Bounds-checked reader over a saved index. Throws on running past the end.
+class IndexReader {
+public:
+    explicit IndexReader(std::span<std::byte const> data)
+        : data_{data} {}
+
+    template <typename T> T value() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T v{};
+        std::memcpy(&v, take(sizeof(T)).data(), sizeof(T));
+        return v;
+    }
+
+    std::string_view string(size_t size) {
+        auto const bytes = take(size);
+        return {reinterpret_cast<char const*>(bytes.data()), bytes.size()};
+    }
+
+private:
+    std::span<std::byte const> take(size_t size) {
+        if (size > data_.size() - offset_) {
+            throw std::runtime_error("truncated pak index");
+        }
+        auto const out = data_.subspan(offset_, size);
+        offset_ += size;
+        return out;
+    }
+
+    std::span<std::byte const> data_;
+    size_t offset_{};
+};
+
+template <typename T> void write_value(std::ostream& os, T const& v) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    os.write(reinterpret_cast<char const*>(&v), sizeof(T));
+}
+
+} // namespace
+
+PAK::PAK(std::filesystem::path fpath,
+         std::optional<std::filesystem::path> const& index_cache_dir)
     : fpath_(std::move(fpath)) {
-    if (!init()) {
+    if (!init(index_cache_dir)) {
         throw std::runtime_error("failed to load PAK file");
     }
 }
 
-bool PAK::init() {
+bool PAK::init(std::optional<std::filesystem::path> const& index_cache_dir) {
+    MD2V_TRACE_SCOPE_DETAIL("PAK::init", fpath_.string());
     if (!std::filesystem::exists(fpath_)) {
         spdlog::error("'{}' does not exist!", fpath_.string());
         return false;
@@ -41,37 +123,244 @@ bool PAK::init() {
     if (std::filesystem::is_regular_file(fpath_)) {
         return init_from_file();
     }
-    init_from_directory();
+    init_from_directory(index_cache_dir);
     return true;
 }
 
-void PAK::init_from_directory() {
-    for (auto const& dir_entry :
-         std::filesystem::recursive_directory_iterator(fpath_)) {
-        if (std::filesystem::is_regular_file(dir_entry.path())) {
-            auto path = dir_entry.path().lexically_relative(fpath_).string();
-            std::ranges::replace(path, '\\', '/');
-            Node node;
-            node.name = dir_entry.path().stem().string();
-            node.path = path;
-            node.filepos = 0;
-            node.filelen = std::filesystem::file_size(dir_entry.path());
-            spdlog::info("{} {} {}", node.name, node.path, node.filelen);
-            entries_.emplace(path, std::move(node));
+void PAK::init_from_directory(
+    std::optional<std::filesystem::path> const& index_cache_dir) {
+    std::optional<std::filesystem::path> cache_path;
+    if (index_cache_dir) {
+        cache_path = index_cache_path(*index_cache_dir);
+        if (read_index_cache(*cache_path)) {
+            index_cached_ = true;
+            index_extensions();
+            spdlog::info("loaded index of {} from {}: {} entries",
+                         fpath_.string(), cache_path->string(),
+                         records_.size());
+            return;
+        }
+    }
+
+    auto const dirs = walk_directory();
+    build_index();
+    if (cache_path) {
+        try {
+            write_index_cache(*cache_path, dirs);
+        } catch (std::exception const& e) {
+            spdlog::warn("failed to save index of {}: {}", fpath_.string(),
+                         e.what());
+        }
+    }
+}
+
+std::vector<PAK::DirStamp> PAK::walk_directory() {
+    MD2V_TRACE_SCOPE("PAK::walk_directory");
+    // paths are made relative by cutting off the root, which is cheaper than
+    // lexically_relative() per file
+    auto const root = (fpath_ / "").generic_string();
+    auto const relative = [&](std::filesystem::path const& path) {
+        return path.generic_string().substr(root.size());
+    };
+
+    // breadth first: the directories of each level are listed in parallel
+    // and their subdirectories make up the next level, so a tree with one
+    // huge subdirectory (models/) still spreads over the pool
+    std::vector<std::filesystem::path> level{fpath_};
+    std::vector<Listing> listings;
+    auto const list = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            auto& out = listings[i];
+            for (auto const& dir_entry :
+                 std::filesystem::directory_iterator(level[i])) {
+                // the type comes from the listing; only sizes and directory
+                // times need a stat, and only where the listing lacks them
+                std::error_code ec;
+                if (dir_entry.is_regular_file(ec)) {
+                    auto const size = dir_entry.file_size(ec);
+                    if (!ec) {
+                        out.files.emplace_back(relative(dir_entry.path()),
+                                               size);
+                    }
+                } else if (dir_entry.is_directory(ec)) {
+                    // like recursive_directory_iterator, do not follow
+                    // directory links; one pointing up the tree would walk
+                    // forever
+                    if (dir_entry.is_symlink(ec) || ec) {
+                        continue;
+                    }
+                    auto const mtime = dir_entry.last_write_time(ec);
+                    if (!ec) {
+                        out.subdirs.push_back(dir_entry.path());
+                        out.mtimes.push_back(mtime_ticks(mtime));
+                    }
+                }
+            }
+        }
+    };
+
+    std::vector<DirStamp> dirs;
+    dirs.push_back(
+        {"", mtime_ticks(std::filesystem::last_write_time(fpath_))});
+    std::optional<ThreadPool> pool;
+    while (!level.empty()) {
+        listings.assign(level.size(), {});
+        if (level.size() > 1) {
+            if (!pool) {
+                pool.emplace();
+            }
+            pool->parallel_for(level.size(), 0, list);
+        } else {
+            list(0, level.size());
         }
+
+        std::vector<std::filesystem::path> next;
+        for (auto& listing : listings) {
+            for (auto const& [path, size] : listing.files) {
+                add_entry(path, 0, size);
+            }
+            for (size_t i = 0; i < listing.subdirs.size(); ++i) {
+                dirs.push_back(
+                    {relative(listing.subdirs[i]), listing.mtimes[i]});
+                next.push_back(std::move(listing.subdirs[i]));
+            }
+        }
+        level = std::move(next);
     }
+    spdlog::info("walked {}: {} files in {} directories", fpath_.string(),
+                 records_.size(), dirs.size());
+    return dirs;
 }
 
-bool PAK::init_from_file() {
-    std::ifstream inf(fpath_, std::ios_base::in | std::ios_base::binary);
+std::filesystem::path
+PAK::index_cache_path(std::filesystem::path const& dir) const {
+    auto const root = std::filesystem::absolute(fpath_)
+                          .lexically_normal()
+                          .generic_string();
+    return dir / fmt::format("{:016x}{}", Hash::fnv1a_64(root),
+                             index_extension);
+}
 
-    if (!inf) {
-        spdlog::info("failed to open pak file: {}", fpath_.string());
+bool PAK::read_index_cache(std::filesystem::path const& path) {
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) {
         return false;
     }
 
+    try {
+        MappedFile const file{path};
+        IndexReader reader{file.bytes()};
+        auto const header = reader.value<IndexHeader>();
+        if (header.magic != index_magic || header.version != index_version) {
+            spdlog::info("pak index {} is from another version",
+                         path.string());
+            return false;
+        }
+
+        // every directory must be untouched since the index was saved
+        for (uint32_t i = 0; i < header.dir_count; ++i) {
+            auto const dir = reader.string(reader.value<uint32_t>());
+            auto const mtime = reader.value<int64_t>();
+            auto const now = std::filesystem::last_write_time(fpath_ / dir, ec);
+            if (ec || mtime_ticks(now) != mtime) {
+                spdlog::info("pak index {} is stale", path.string());
+                return false;
+            }
+        }
+
+        std::vector<Record> records(header.record_count);
+        for (auto& record : records) {
+            record.path_offset = reader.value<uint32_t>();
+            record.path_size = reader.value<uint32_t>();
+            record.name_offset = reader.value<uint32_t>();
+            record.name_size = reader.value<uint32_t>();
+            record.filepos = reader.value<int32_t>();
+            record.filelen = reader.value<uint64_t>();
+            if (record.path_offset > header.paths_size ||
+                record.path_size > header.paths_size - record.path_offset ||
+                record.name_offset > record.path_size ||
+                record.name_size > record.path_size - record.name_offset) {
+                throw std::runtime_error("pak index entry out of bounds");
+            }
+        }
+        std::string paths{reader.string(header.paths_size)};
+
+        auto const by_path = [&](Record const& record) {
+            return std::string_view{paths}.substr(record.path_offset,
+                                                  record.path_size);
+        };
+        if (std::ranges::adjacent_find(records, std::ranges::greater_equal{},
+                                       by_path) != records.end()) {
+            throw std::runtime_error("pak index is not sorted");
+        }
+
+        records_ = std::move(records);
+        paths_ = std::move(paths);
+        return true;
+    } catch (std::exception const& e) {
+        spdlog::warn("ignoring pak index {}: {}", path.string(), e.what());
+        return false;
+    }
+}
+
+void PAK::write_index_cache(std::filesystem::path const& path,
+                            std::vector<DirStamp> const& dirs) const {
+    std::filesystem::create_directories(path.parent_path());
+
+    // see ModelCache::write(): a reader never sees a partial file
+    auto tmp_path = path;
+    tmp_path += fmt::format(
+        ".{:x}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    {
+        std::ofstream os{tmp_path, std::ios::binary | std::ios::trunc};
+        IndexHeader const header{
+            .magic = index_magic,
+            .version = index_version,
+            .dir_count = gsl_lite::narrow<uint32_t>(dirs.size()),
+            .record_count = gsl_lite::narrow<uint32_t>(records_.size()),
+            .paths_size = gsl_lite::narrow<uint32_t>(paths_.size()),
+        };
+        write_value(os, header);
+        for (auto const& dir : dirs) {
+            write_value(os, gsl_lite::narrow<uint32_t>(dir.path.size()));
+            os << dir.path;
+            write_value(os, dir.mtime);
+        }
+        for (auto const& record : records_) {
+            write_value(os, record.path_offset);
+            write_value(os, record.path_size);
+            write_value(os, record.name_offset);
+            write_value(os, record.name_size);
+            write_value(os, record.filepos);
+            write_value(os, static_cast<uint64_t>(record.filelen));
+        }
+        os << paths_;
+        os.close();
+        if (!os) {
+            std::filesystem::remove(tmp_path);
+            throw std::runtime_error("failed to write " + tmp_path.string());
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec) {
+        std::filesystem::remove(tmp_path);
+        throw std::runtime_error(fmt::format(
+            "failed to rename {}: {}", tmp_path.string(), ec.message()));
+    }
+    spdlog::info("saved index of {} to {}", fpath_.string(), path.string());
+}
+
+bool PAK::init_from_file() {
+    archive_ = MappedFile{fpath_};
+    auto const bytes = archive_.bytes();
+
     Header hdr{};
-    inf.read(reinterpret_cast<char*>(&hdr), sizeof(hdr));
+    if (bytes.size() < sizeof(hdr)) {
+        throw std::runtime_error("not a valid pak file");
+    }
+    std::memcpy(&hdr, bytes.data(), sizeof(hdr));
 
     spdlog::info("{}{}{}{} {} {}", hdr.id[0], hdr.id[1], hdr.id[2], hdr.id[3],
                  hdr.dirofs, hdr.dirlen);
@@ -83,45 +372,174 @@ bool PAK::init_from_file() {
     }
 
     // TODO: ensure dirofs/dirlen converted from little endian to host
+    if (hdr.dirofs < 0 || hdr.dirlen < 0 ||
+        std::cmp_greater(hdr.dirofs, bytes.size()) ||
+        std::cmp_greater(hdr.dirlen, bytes.size() - hdr.dirofs)) {
+        throw std::runtime_error("pak directory out of bounds");
+    }
+
     auto num_entries = static_cast<size_t>(hdr.dirlen) / sizeof(Entry);
 
     spdlog::info("loaded pak file: {} {} {} {}", fpath_.string(), hdr.dirofs,
                  hdr.dirlen, num_entries);
 
-    inf.seekg(hdr.dirofs);
+    auto const directory = bytes.subspan(hdr.dirofs, hdr.dirlen);
+    records_.reserve(num_entries);
+    paths_.reserve(num_entries * 32);
 
     for (size_t i = 0; i < num_entries; ++i) {
-        gsl_Assert(inf);
         Entry entry{};
-        inf.read(reinterpret_cast<char*>(&entry), sizeof(entry));
+        std::memcpy(&entry, directory.data() + (i * sizeof(Entry)),
+                    sizeof(entry));
         // TODO: ensure filepos/filelen converted from little endian to host
 
-        auto const fullname = std::string(entry.name.data());
-        auto const path = std::filesystem::path(fullname);
+        auto const fullname = std::string_view(
+            entry.name.begin(), std::ranges::find(entry.name, '\0'));
 
         spdlog::debug("file: {} {} {}", fullname, entry.filepos, entry.filelen);
 
-        Node node;
-        node.name = path.stem().string();
-        node.path = fullname;
-        node.filepos = entry.filepos;
-        node.filelen = entry.filelen;
-        entries_.emplace(fullname, std::move(node));
+        if (entry.filepos < 0 || entry.filelen < 0 ||
+            std::cmp_greater(entry.filepos, bytes.size()) ||
+            std::cmp_greater(entry.filelen, bytes.size() - entry.filepos)) {
+            spdlog::warn("skipping out of bounds pak entry {}", fullname);
+            continue;
+        }
+
+        add_entry(fullname, entry.filepos,
+                  static_cast<uintmax_t>(entry.filelen));
     }
+    build_index();
     return true;
 }
 
-std::ifstream PAK::open_ifstream(std::filesystem::path const& fpath) const {
-    auto const flags = std::ios_base::in | std::ios_base::binary;
+void PAK::add_entry(std::string_view path,
+                    int32_t filepos,
+                    uintmax_t filelen) {
+    // stem as std::filesystem::path::stem() would give it
+    auto const slash = path.rfind('/');
+    auto const file_start = slash == std::string_view::npos ? 0 : slash + 1;
+    auto const file = path.substr(file_start);
+    auto const dot = file.rfind('.');
+    auto const stem_size =
+        dot == std::string_view::npos || dot == 0 || file == ".."
+            ? file.size()
+            : dot;
+
+    records_.push_back({
+        .path_offset = gsl_lite::narrow<uint32_t>(paths_.size()),
+        .path_size = gsl_lite::narrow<uint32_t>(path.size()),
+        .name_offset = gsl_lite::narrow<uint32_t>(file_start),
+        .name_size = gsl_lite::narrow<uint32_t>(stem_size),
+        .filepos = filepos,
+        .filelen = filelen,
+    });
+    paths_.append(path);
+}
+
+void PAK::build_index() {
+    // a later duplicate of a path is shadowed by the first, as it would be
+    // by a map insert
+    std::ranges::stable_sort(records_, {}, [this](Record const& record) {
+        return path(record);
+    });
+    auto const duplicates =
+        std::ranges::unique(records_, {}, [this](Record const& record) {
+            return path(record);
+        });
+    if (!duplicates.empty()) {
+        spdlog::warn("{} duplicate pak entries ignored", duplicates.size());
+    }
+    records_.erase(duplicates.begin(), duplicates.end());
+    index_extensions();
+    spdlog::info("indexed {} pak entries, {} bytes of paths", records_.size(),
+                 paths_.size());
+}
+
+void PAK::index_extensions() {
+    by_extension_.clear();
+    for (size_t i = 0; i < records_.size(); ++i) {
+        auto const& record = records_[i];
+        auto const file = path(record).substr(record.name_offset);
+        if (record.name_size < file.size()) {
+            by_extension_[std::string{file.substr(record.name_size)}]
+                .push_back(static_cast<uint32_t>(i));
+        }
+    }
+}
+
+bool PAK::contains(std::filesystem::path const& fpath) const {
+    if (find(fpath.generic_string())) {
+        return true;
+    }
+    return is_directory() && std::filesystem::is_regular_file(fpath_ / fpath);
+}
+
+std::optional<PAK::Node> PAK::find(std::string_view fpath) const {
+    auto const iter = std::ranges::lower_bound(
+        records_, fpath, {}, [this](Record const& record) {
+            return path(record);
+        });
+    if (iter == records_.end() || path(*iter) != fpath) {
+        return std::nullopt;
+    }
+    return node(*iter);
+}
+
+std::span<PAK::Record const>
+PAK::prefix_range(std::string_view path_prefix) const {
+    auto const by_path = [this](Record const& record) { return path(record); };
+    auto const first =
+        std::ranges::lower_bound(records_, path_prefix, {}, by_path);
+    // every path with the prefix sorts directly after it
+    auto const last = std::ranges::partition_point(
+        first, records_.end(), [&](Record const& record) {
+            return path(record).starts_with(path_prefix);
+        });
+    return {first, last};
+}
+
+std::span<PAK::Record const>
+PAK::directory_range(std::string_view dir) const {
+    if (dir.empty() || dir.ends_with('/')) {
+        return prefix_range(dir);
+    }
+    auto const with_slash = std::string{dir} + '/';
+    return prefix_range(with_slash);
+}
+
+MappedBytes PAK::view(std::filesystem::path const& fpath) const {
+    auto key = fpath.generic_string();
 
     if (!is_directory()) {
-        auto const& node = entries().at(fpath.string());
-        std::ifstream inf(fpath_, flags);
-        inf.seekg(node.filepos);
-        return inf;
+        auto const node = find(key);
+        gsl_Expects(node.has_value());
+        return MappedBytes{archive_.bytes().subspan(
+            static_cast<size_t>(node->filepos), node->filelen)};
     }
 
+    std::scoped_lock lock{mapped_mutex_};
+    if (auto const iter = mapped_.find(key); iter != mapped_.end()) {
+        if (auto file = iter->second.lock()) {
+            return MappedBytes{std::move(file)};
+        }
+    }
     auto const p = fpath_ / fpath;
-    spdlog::info("open file {}", p.string());
-    return {p, flags};
+    gsl_Expects(std::filesystem::is_regular_file(p));
+    spdlog::debug("map file {}", p.string());
+    auto file = std::make_shared<MappedFile const>(p);
+    // forget files nobody is viewing any more, so the map only holds the
+    // ones still in use
+    std::erase_if(mapped_,
+                  [](auto const& item) { return item.second.expired(); });
+    mapped_.insert_or_assign(std::move(key), file);
+    return MappedBytes{std::move(file)};
+}
+
+SpanStream PAK::open_ifstream(std::filesystem::path const& fpath) const {
+    if (!contains(fpath)) {
+        spdlog::warn("no pak entry {}", fpath.string());
+        return {};
+    }
+    auto const bytes = view(fpath);
+    return SpanStream{bytes.bytes(), bytes.file()};
 }
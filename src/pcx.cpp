@@ -1,101 +1,132 @@
 #include "md2view/pcx.hpp"
+#include "md2view/trace.hpp"
 
 #include <gsl-lite/gsl-lite.hpp>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
 #include <array>
-#include <cassert>
 #include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
 
-PCX::PCX(std::istream& is) {
+PCX::PCX(std::span<std::byte const> data, Pixels pixels) {
+    MD2V_TRACE_SCOPE("PCX::PCX");
     Header header{};
-    is.read(reinterpret_cast<char*>(std::addressof(header)), sizeof(header));
-    gsl_Assert(is.gcount() == sizeof(header));
-
-    auto width = header.xend - header.xstart + 1;
-    auto length = header.yend - header.ystart + 1;
-    auto scan_line_length = header.num_bit_planes * header.bytes_per_line;
-
-    std::vector<ScanLine> scan_lines;
-    scan_lines.reserve(length);
-
-    for (auto i = 0; i < length; ++i) {
-        scan_lines.emplace_back(read_scan_line(is, scan_line_length));
+    gsl_Expects(data.size() >= sizeof(header));
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    auto const width = header.xend - header.xstart + 1;
+    auto const height = header.yend - header.ystart + 1;
+    gsl_Expects(width > 0 && height > 0);
+    auto const w = static_cast<size_t>(width);
+    auto const h = static_cast<size_t>(height);
+    auto const scan_line_length =
+        size_t{header.num_bit_planes} * header.bytes_per_line;
+
+    // RLE: a byte with the top two bits set is a run count for the byte that
+    // follows, anything else is a single literal. Only the first `width`
+    // bytes of each scan line are pixels of the first plane; padding and
+    // further planes are skipped, and a run never continues past its line.
+    auto const* in = reinterpret_cast<uint8_t const*>(data.data());
+    auto const size = data.size();
+    size_t pos = sizeof(header);
+
+    indices_.resize(w * h);
+    auto* out = indices_.data();
+    for (size_t y = 0; y < h && pos < size; ++y, out += w) {
+        size_t x = 0;
+        while (x < scan_line_length && pos < size) {
+            size_t run = 1;
+            auto value = in[pos++];
+            if ((value & 0xC0U) == 0xC0U) {
+                run = value & 0x3FU;
+                value = pos < size ? in[pos++] : 0;
+            }
+            run = std::min(run, scan_line_length - x);
+            if (x < w) {
+                std::fill_n(out + x, std::min(run, w - x), value);
+            }
+            x += run;
+        }
+    }
+    if (pos >= size) {
+        spdlog::warn("pcx data ends before the palette");
     }
-    spdlog::info("done reading scan lines {}", scan_lines.size());
-
-    colors_ = read_palette(is);
-    spdlog::info("num colors in palette: {}", colors_.size());
 
-    width_ = width;
-    height_ = length;
-    image_.resize(width * length * 3);
-
-    for (auto i = 0; i < length; ++i) {
-        for (auto j = 0; j < width; ++j) {
-            auto index = scan_lines[i][j];
-            assert(index < colors_.size());
-            auto loc = (j + (i * width)) * 3;
-            auto& color = colors_[index];
-            image_[loc + 0] = color.r;
-            image_[loc + 1] = color.g;
-            image_[loc + 2] = color.b;
+    // the palette follows the pixels: a marker byte then RGB triples
+    if (pos < size) {
+        ++pos;
+        colors_.reserve((size - pos) / 3);
+        for (; pos + 3 <= size; pos += 3) {
+            colors_.emplace_back(in[pos], in[pos + 1], in[pos + 2]);
         }
     }
-}
-
-PCX::ScanLine PCX::read_scan_line(std::istream& ds, int32_t length) {
-    ScanLine scan_line;
-    scan_line.resize(static_cast<size_t>(length));
-
-    auto index = decltype(length)(0);
-
-    uint8_t runcount{};
-    uint8_t runvalue{};
 
-    while (index < length) {
-        char byte{};
-        ds.read(std::addressof(byte), 1);
-
-        if ((byte & 0xc0) == 0xc0) {
-            runcount = byte & 0x3f;
-            ds.read(std::addressof(byte), 1);
-            runvalue = static_cast<uint8_t>(byte);
-        } else {
-            runcount = 1;
-            runvalue = static_cast<uint8_t>(byte);
-        }
+    width_ = width;
+    height_ = height;
+    spdlog::info("decoded pcx {}x{}, {} colors", width_, height_,
+                 colors_.size());
+    if (pixels == Pixels::indexed) {
+        return;
+    }
 
-        while (runcount > 0 && index < length) {
-            scan_line[static_cast<size_t>(index)] = runvalue;
-            --runcount;
-            ++index;
-        }
+    // expand through a table of 4 byte entries so each pixel is one 32-bit
+    // store; the fourth byte is overwritten by the next pixel, and the last
+    // pixel is copied separately so nothing is written past the image.
+    // Indices with no palette entry decode as black.
+    std::array<std::array<uint8_t, 4>, palette_size> rgb{};
+    for (size_t i = 0; i < std::min(colors_.size(), rgb.size()); ++i) {
+        rgb[i] = {colors_[i].r, colors_[i].g, colors_[i].b, 0};
     }
 
-    return scan_line;
+    image_.resize(w * h * 3);
+    auto* pixel = image_.data();
+    auto const last = indices_.size() - 1;
+    for (size_t i = 0; i < last; ++i, pixel += 3) {
+        std::memcpy(pixel, rgb[indices_[i]].data(), 4);
+    }
+    std::memcpy(pixel, rgb[indices_[last]].data(), 3);
 }
 
-std::vector<PCX::Color> PCX::read_palette(std::istream& is) {
-    std::vector<PCX::Color> colors;
-
-    if (is.eof()) {
-        return colors;
+std::vector<unsigned char> PCX::palette() const {
+    std::vector<unsigned char> rgb(palette_size * 3);
+    auto const n = std::min(colors_.size(), palette_size);
+    for (size_t i = 0; i < n; ++i) {
+        rgb[(i * 3) + 0] = colors_[i].r;
+        rgb[(i * 3) + 1] = colors_[i].g;
+        rgb[(i * 3) + 2] = colors_[i].b;
     }
+    return rgb;
+}
 
-    char byte{}; // marker byte
-    is.read(std::addressof(byte), 1);
-
-    std::array<char, 3> rgb{};
-    while (is.read(rgb.data(), rgb.size())) {
-        colors.emplace_back(static_cast<uint8_t>(rgb[0]),
-                            static_cast<uint8_t>(rgb[1]),
-                            static_cast<uint8_t>(rgb[2]));
+PCX::PCX(std::istream& is)
+    : PCX(read_all(is)) {}
+
+std::vector<std::byte> PCX::read_all(std::istream& is) {
+    gsl_Expects(is.good());
+
+    // size the buffer up front and read it in one call when the stream can
+    // seek; otherwise fall back to draining it through the stream buffer
+    std::vector<std::byte> data;
+    auto const start = is.tellg();
+    if (start != std::istream::pos_type(-1) &&
+        is.seekg(0, std::ios::end)) {
+        auto const end = is.tellg();
+        is.seekg(start);
+        data.resize(static_cast<size_t>(end - start));
+        is.read(reinterpret_cast<char*>(data.data()),
+                static_cast<std::streamsize>(data.size()));
+        data.resize(static_cast<size_t>(is.gcount()));
+    } else {
+        is.clear();
+        std::transform(std::istreambuf_iterator<char>(is),
+                       std::istreambuf_iterator<char>(),
+                       std::back_inserter(data),
+                       [](char c) { return static_cast<std::byte>(c); });
     }
-
-    return colors;
+    return data;
 }
 
 template <size_t N>
@@ -1,16 +1,47 @@
 #include "md2view/resource_manager.hpp"
+#include "md2view/trace.hpp"
 
 #include <gsl-lite/gsl-lite.hpp>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <exception>
 #include <filesystem>
+#include <utility>
 
 ResourceManager::ResourceManager(
     std::filesystem::path const& rootdir,
-    std::optional<std::filesystem::path> const& pak_path)
+    std::vector<std::filesystem::path> const& search_path,
+    std::optional<std::filesystem::path> const& index_cache_dir)
     : root_dir_(rootdir)
     , shaders_dir_(root_dir_ / "shaders")
-    , pak_(std::make_unique<PAK>(pak_path.value_or(rootdir / "models"))) {}
+    , vfs_(search_path.empty()
+               ? std::vector<std::filesystem::path>{rootdir / "models"}
+               : search_path,
+           index_cache_dir)
+    , loader_(std::make_unique<ThreadPool>(loader_workers)) {}
+
+template <typename T>
+void ResourceManager::log_stats(LruCache<T> const& cache) {
+    auto const& stats = cache.stats();
+    MD2V_TRACE_COUNTER(cache.name() + " cache bytes", cache.bytes());
+    spdlog::info("{} cache: {} entries, {}/{} bytes, {} hits, {} misses, "
+                 "{} evictions",
+                 cache.name(), cache.size(), cache.bytes(), cache.budget(),
+                 stats.hits, stats.misses, stats.evictions);
+}
+
+std::shared_ptr<MD2Model const>
+ResourceManager::read_model(VFS const& vfs,
+                            std::string const& path,
+                            MD2Model::Layout layout,
+                            MD2Model::Storage storage,
+                            std::optional<ModelCache> const& baked) {
+    if (baked) {
+        return baked->load(vfs, path, layout, storage);
+    }
+    return std::make_shared<MD2Model const>(path, vfs, layout, storage);
+}
 
 std::shared_ptr<GL::Shader>
 ResourceManager::load_shader(std::string const& name,
@@ -18,6 +49,7 @@ ResourceManager::load_shader(std::string const& name,
                              std::optional<std::string_view> fragment,
                              std::optional<std::string_view> geometry) {
     gsl_Assert(!shaders_.contains(name));
+    MD2V_TRACE_SCOPE_DETAIL("ResourceManager::load_shader", name);
     auto const vfname =
         vertex ? fmt::format("{}.vert", *vertex) : fmt::format("{}.vert", name);
     auto const ffname = fragment ? fmt::format("{}.frag", *fragment)
@@ -43,24 +75,150 @@ ResourceManager::load_shader(std::string const& name,
 std::shared_ptr<GL::Texture2D>
 ResourceManager::load_texture2D(std::string const& path,
                                 std::optional<std::string> const& name) {
+    MD2V_TRACE_SCOPE_DETAIL("ResourceManager::load_texture2D", path);
     auto key = name ? *name : path;
-    auto iter = textures2D_.find(key);
+    if (auto texture = textures2D_.find(key)) {
+        return texture;
+    }
 
-    if (iter != textures2D_.end()) {
+    auto texture = GL::Texture2D::load(vfs_, path, indexed_skins_);
+    texture = textures2D_.insert(key, texture, texture->gpu_bytes());
+    log_stats(textures2D_);
+    return texture;
+}
+
+ResourceManager::Future<GL::Texture2D>
+ResourceManager::load_texture2D_async(std::string const& path) {
+    MD2V_TRACE_SCOPE_DETAIL("ResourceManager::load_texture2D_async", path);
+    if (auto texture = textures2D_.find(path)) {
+        std::promise<std::shared_ptr<GL::Texture2D>> ready;
+        ready.set_value(std::move(texture));
+        return ready.get_future().share();
+    }
+    if (auto const iter = pending_textures_.find(path);
+        iter != pending_textures_.end()) {
         return iter->second;
     }
 
-    auto result = textures2D_.emplace(key, GL::Texture2D::load(pak(), path));
-    return result.first->second;
+    auto promise =
+        std::make_shared<std::promise<std::shared_ptr<GL::Texture2D>>>();
+    auto future = promise->get_future().share();
+    pending_textures_.emplace(path, future);
+    loader_->submit([this, path, promise, indexed = indexed_skins_] {
+        MD2V_TRACE_SCOPE_DETAIL("decode texture", path);
+        try {
+            auto image = GL::Texture2D::decode(vfs_, path, indexed);
+            std::lock_guard lock(uploads_mutex_);
+            uploads_.push_back({path, std::move(image), promise});
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+        }
+    });
+    return future;
+}
+
+std::shared_ptr<MD2Model const>
+ResourceManager::load_model(std::string const& path) {
+    MD2V_TRACE_SCOPE_DETAIL("ResourceManager::load_model", path);
+    if (auto model = models_.find(path)) {
+        return model;
+    }
+
+    // a model already loading would be parsed twice; wait for it instead
+    if (auto const pending = pending_models_.find(path);
+        pending != pending_models_.end()) {
+        return pending->second.get();
+    }
+
+    auto md2 =
+        read_model(vfs_, path, model_layout_, model_storage_, baked_models_);
+    auto model = models_.insert(path, md2, md2->memory_usage());
+    log_stats(models_);
+    return model;
 }
 
-std::shared_ptr<MD2> ResourceManager::load_model(std::string const& path) {
-    auto const iter = models_.find(path);
-    if (iter != models_.end()) {
+ResourceManager::Future<MD2Model const>
+ResourceManager::load_model_async(std::string const& path) {
+    MD2V_TRACE_SCOPE_DETAIL("ResourceManager::load_model_async", path);
+    if (auto model = models_.find(path)) {
+        std::promise<std::shared_ptr<MD2Model const>> ready;
+        ready.set_value(std::move(model));
+        return ready.get_future().share();
+    }
+    if (auto const iter = pending_models_.find(path);
+        iter != pending_models_.end()) {
         return iter->second;
     }
 
-    auto md2 = std::make_shared<MD2>(path, pak());
-    auto result = models_.emplace(path, std::move(md2));
-    return result.first->second;
+    auto promise =
+        std::make_shared<std::promise<std::shared_ptr<MD2Model const>>>();
+    auto future = promise->get_future().share();
+    pending_models_.emplace(path, future);
+    loader_->submit([this, path, promise, layout = model_layout_,
+                     storage = model_storage_, baked = baked_models_] {
+        MD2V_TRACE_SCOPE_DETAIL("read model", path);
+        try {
+            promise->set_value(read_model(vfs_, path, layout, storage, baked));
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+        }
+    });
+    return future;
+}
+
+size_t ResourceManager::process_uploads(std::chrono::microseconds budget) {
+    MD2V_TRACE_SCOPE("ResourceManager::process_uploads");
+    auto const start = std::chrono::steady_clock::now();
+    size_t uploaded = 0;
+    while (uploaded == 0 ||
+           std::chrono::steady_clock::now() - start < budget) {
+        Upload upload;
+        {
+            std::lock_guard lock(uploads_mutex_);
+            if (uploads_.empty()) {
+                break;
+            }
+            upload = std::move(uploads_.front());
+            uploads_.pop_front();
+        }
+
+        // a synchronous load of the same path may have won the race
+        if (!textures2D_.contains(upload.key)) {
+            try {
+                auto texture = GL::Texture2D::upload(upload.image);
+                textures2D_.insert(upload.key, texture, texture->gpu_bytes());
+                log_stats(textures2D_);
+                ++uploaded;
+                upload.promise->set_value(std::move(texture));
+            } catch (...) {
+                upload.promise->set_exception(std::current_exception());
+            }
+            continue;
+        }
+        upload.promise->set_value(textures2D_.find(upload.key));
+    }
+
+    // failed loads are logged here once and dropped; callers see the error
+    // through their own future. Uploaded textures are cached above; parsed
+    // models join the cache here.
+    auto const settle = [](auto& pending, auto const& on_loaded) {
+        std::erase_if(pending, [&](auto& entry) {
+            if (!is_ready(entry.second)) {
+                return false;
+            }
+            try {
+                on_loaded(entry.first, entry.second.get());
+            } catch (std::exception const& e) {
+                spdlog::error("failed to load {}: {}", entry.first, e.what());
+            }
+            return true;
+        });
+    };
+    settle(pending_models_, [this](std::string const& path, auto const& md2) {
+        models_.insert(path, md2, md2->memory_usage());
+        log_stats(models_);
+    });
+    settle(pending_textures_, [](std::string const&, auto const&) {});
+
+    return uploaded;
 }
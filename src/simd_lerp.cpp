@@ -0,0 +1,151 @@
+#include "md2view/simd_lerp.hpp"
+
+#include <gsl-lite/gsl-lite.hpp>
+#include <spdlog/spdlog.h>
+
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define MD2VIEW_SIMD_SSE 1
+#include <immintrin.h>
+#endif
+
+// the avx kernel is compiled with a per-function target attribute so the rest
+// of the library does not require avx; that needs gcc or clang
+#if defined(MD2VIEW_SIMD_SSE) && (defined(__GNUC__) || defined(__clang__))
+#define MD2VIEW_SIMD_AVX 1
+#endif
+
+namespace SIMD {
+
+namespace {
+
+void lerp_scalar(float const* a,
+                 float const* b,
+                 float t,
+                 float* out,
+                 std::size_t n) {
+    float const s = 1.0f - t;
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = (a[i] * s) + (b[i] * t);
+    }
+}
+
+#ifdef MD2VIEW_SIMD_SSE
+void lerp_sse(float const* a,
+              float const* b,
+              float t,
+              float* out,
+              std::size_t n) {
+    __m128 const s4 = _mm_set1_ps(1.0f - t);
+    __m128 const t4 = _mm_set1_ps(t);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 const x = _mm_mul_ps(_mm_loadu_ps(a + i), s4);
+        __m128 const y = _mm_mul_ps(_mm_loadu_ps(b + i), t4);
+        _mm_storeu_ps(out + i, _mm_add_ps(x, y));
+    }
+    lerp_scalar(a + i, b + i, t, out + i, n - i);
+}
+#endif
+
+#ifdef MD2VIEW_SIMD_AVX
+__attribute__((target("avx"))) void
+lerp_avx(float const* a, float const* b, float t, float* out, std::size_t n) {
+    __m256 const s8 = _mm256_set1_ps(1.0f - t);
+    __m256 const t8 = _mm256_set1_ps(t);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 const x = _mm256_mul_ps(_mm256_loadu_ps(a + i), s8);
+        __m256 const y = _mm256_mul_ps(_mm256_loadu_ps(b + i), t8);
+        _mm256_storeu_ps(out + i, _mm256_add_ps(x, y));
+    }
+    lerp_sse(a + i, b + i, t, out + i, n - i);
+}
+#endif
+
+using KernelFn =
+    void (*)(float const*, float const*, float, float*, std::size_t);
+
+KernelFn kernel_function(Kernel kernel) {
+    switch (kernel) {
+#ifdef MD2VIEW_SIMD_SSE
+    case Kernel::sse:
+        return lerp_sse;
+#endif
+#ifdef MD2VIEW_SIMD_AVX
+    case Kernel::avx:
+        return lerp_avx;
+#endif
+    default:
+        return lerp_scalar;
+    }
+}
+
+Kernel detect_kernel() {
+    auto const kernel = supported(Kernel::avx)   ? Kernel::avx
+                        : supported(Kernel::sse) ? Kernel::sse
+                                                 : Kernel::scalar;
+    spdlog::info("keyframe lerp kernel: {}", name(kernel));
+    return kernel;
+}
+
+} // namespace
+
+bool supported(Kernel kernel) {
+    switch (kernel) {
+    case Kernel::scalar:
+        return true;
+    case Kernel::sse:
+#ifdef MD2VIEW_SIMD_SSE
+        return true;
+#else
+        return false;
+#endif
+    case Kernel::avx:
+#ifdef MD2VIEW_SIMD_AVX
+        return __builtin_cpu_supports("avx") != 0;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+Kernel best_kernel() {
+    static Kernel const kernel = detect_kernel();
+    return kernel;
+}
+
+char const* name(Kernel kernel) {
+    switch (kernel) {
+    case Kernel::scalar:
+        return "scalar";
+    case Kernel::sse:
+        return "sse";
+    case Kernel::avx:
+        return "avx";
+    }
+    return "unknown";
+}
+
+void lerp(std::span<float const> a,
+          std::span<float const> b,
+          float t,
+          std::span<float> out) {
+    static KernelFn const fn = kernel_function(best_kernel());
+    gsl_Expects(a.size() == out.size() && b.size() == out.size());
+    fn(a.data(), b.data(), t, out.data(), out.size());
+}
+
+void lerp(Kernel kernel,
+          std::span<float const> a,
+          std::span<float const> b,
+          float t,
+          std::span<float> out) {
+    gsl_Expects(supported(kernel));
+    gsl_Expects(a.size() == out.size() && b.size() == out.size());
+    kernel_function(kernel)(a.data(), b.data(), t, out.data(), out.size());
+}
+
+} // namespace SIMD
@@ -0,0 +1,175 @@
+#include "md2view/thread_pool.hpp"
+#include "md2view/trace.hpp"
+
+#include <gsl-lite/gsl-lite.hpp>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <exception>
+#include <string>
+#include <utility>
+
+ThreadPool::ThreadPool(size_t workers) {
+    // a pool without workers still needs a queue for parallel_for() to
+    // push chunks onto and drain from the calling thread
+    queues_.reserve(std::max<size_t>(workers, 1));
+    for (size_t i = 0; i < std::max<size_t>(workers, 1); ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    workers_.reserve(workers);
+    for (size_t i = 0; i < workers; ++i) {
+        workers_.emplace_back([this, i] { worker_loop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(sleep_mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::default_worker_count() {
+    auto const threads = std::thread::hardware_concurrency();
+    return threads > 1 ? threads - 1 : 0;
+}
+
+void ThreadPool::submit(Task task) {
+    gsl_Expects(task);
+    if (workers_.empty()) {
+        task();
+        return;
+    }
+
+    {
+        // counted before the push so pop() never takes queued_ below zero,
+        // and under sleep_mutex_ so a worker about to wait cannot miss it
+        std::lock_guard lock(sleep_mutex_);
+        ++queued_;
+    }
+    auto const index = next_queue_.fetch_add(1) % queues_.size();
+    {
+        auto& queue = *queues_[index];
+        std::lock_guard lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    wake_.notify_one();
+}
+
+void ThreadPool::parallel_for(size_t count,
+                              size_t grain,
+                              std::function<void(size_t, size_t)> const& fn) {
+    if (count == 0) {
+        return;
+    }
+    if (grain == 0) {
+        constexpr size_t chunks_per_thread = 4;
+        grain = std::max<size_t>(
+            1, count / ((workers_.size() + 1) * chunks_per_thread));
+    }
+    auto const chunks = (count + grain - 1) / grain;
+    if (chunks == 1 || workers_.empty()) {
+        fn(0, count);
+        return;
+    }
+
+    // shared with the chunk tasks, which may still be unwinding after the
+    // last one has signalled completion
+    struct Batch {
+        std::mutex mutex;
+        std::condition_variable done;
+        size_t remaining{};
+        std::exception_ptr error;
+    };
+    auto batch = std::make_shared<Batch>();
+    batch->remaining = chunks;
+
+    for (size_t begin = 0; begin < count; begin += grain) {
+        auto const end = std::min(begin + grain, count);
+        submit([batch, &fn, begin, end] {
+            std::exception_ptr error;
+            try {
+                fn(begin, end);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            std::lock_guard lock(batch->mutex);
+            if (error && !batch->error) {
+                batch->error = error;
+            }
+            if (--batch->remaining == 0) {
+                batch->done.notify_all();
+            }
+        });
+    }
+
+    // help out until nothing is left to take, then wait for the chunks still
+    // running on workers
+    auto const home = next_queue_.load() % queues_.size();
+    while (run_one(home)) {
+    }
+    std::unique_lock lock(batch->mutex);
+    batch->done.wait(lock, [&] { return batch->remaining == 0; });
+    if (batch->error) {
+        std::rethrow_exception(batch->error);
+    }
+}
+
+void ThreadPool::worker_loop(size_t index) {
+    Trace::set_thread_name("pool worker " + std::to_string(index));
+    for (;;) {
+        if (run_one(index)) {
+            continue;
+        }
+        std::unique_lock lock(sleep_mutex_);
+        wake_.wait(lock, [this] { return stopping_ || queued_ > 0; });
+        if (stopping_ && queued_ == 0) {
+            return;
+        }
+    }
+}
+
+bool ThreadPool::run_one(size_t home) {
+    Task task;
+    if (!pop(home, task) && !steal(home, task)) {
+        return false;
+    }
+    try {
+        task();
+    } catch (std::exception const& e) {
+        spdlog::error("thread pool task failed: {}", e.what());
+    } catch (...) {
+        spdlog::error("thread pool task failed with an unknown exception");
+    }
+    return true;
+}
+
+bool ThreadPool::pop(size_t index, Task& task) {
+    auto& queue = *queues_[index];
+    std::lock_guard lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    --queued_;
+    return true;
+}
+
+bool ThreadPool::steal(size_t thief, Task& task) {
+    for (size_t i = 1; i < queues_.size(); ++i) {
+        auto& queue = *queues_[(thief + i) % queues_.size()];
+        std::lock_guard lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            --queued_;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,260 @@
+#include "md2view/trace.hpp"
+
+#include <fmt/format.h>
+#include <gsl-lite/gsl-lite.hpp>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+enum class Phase : std::uint8_t { complete, counter };
+
+struct Event {
+    std::int64_t begin_ns;
+    std::int64_t duration_ns;
+    double value;
+    Phase phase;
+    std::array<char, Trace::max_name + 1> name;
+    std::array<char, Trace::max_detail + 1> detail;
+};
+
+/// One thread's ring of events. It grows as events are recorded until it
+/// holds `capacity`, then wraps. The mutex is only contended while events
+/// are being written out.
+struct Buffer {
+    std::mutex mutex;
+    std::vector<Event> events;
+    size_t capacity{};
+    size_t next{}; ///< Oldest event, once the ring has wrapped.
+    size_t dropped{};
+    std::uint32_t tid{};
+    std::string thread_name;
+};
+
+/// Every thread's buffer, kept after the thread exits so a short lived
+/// pool's events still get written.
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<Buffer>> buffers;
+    size_t capacity{Trace::default_buffer_events};
+    std::uint32_t next_tid{1};
+    Trace::TimePoint epoch{};
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+thread_local std::shared_ptr<Buffer> t_buffer;
+thread_local std::string t_thread_name;
+
+Buffer& thread_buffer() {
+    if (!t_buffer) {
+        auto buffer = std::make_shared<Buffer>();
+        auto& reg = registry();
+        std::lock_guard lock(reg.mutex);
+        buffer->capacity = reg.capacity;
+        buffer->tid = reg.next_tid++;
+        buffer->thread_name = t_thread_name;
+        reg.buffers.push_back(buffer);
+        t_buffer = std::move(buffer);
+    }
+    return *t_buffer;
+}
+
+template <size_t N>
+void copy_truncated(std::string_view from, std::array<char, N>& to) {
+    auto const n = std::min(from.size(), N - 1);
+    std::ranges::copy(from.substr(0, n), to.begin());
+    to[n] = '\0';
+}
+
+void record(Event const& event) {
+    auto& buffer = thread_buffer();
+    std::lock_guard lock(buffer.mutex);
+    if (buffer.events.size() < buffer.capacity) {
+        buffer.events.push_back(event);
+        return;
+    }
+    buffer.events[buffer.next] = event;
+    buffer.next = (buffer.next + 1) % buffer.capacity;
+    ++buffer.dropped;
+}
+
+std::int64_t to_ns(Trace::TimePoint t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               t.time_since_epoch())
+        .count();
+}
+
+/// @p str as the body of a JSON string.
+std::string escape(std::string_view str) {
+    std::string out;
+    out.reserve(str.size());
+    for (auto const c : str) {
+        switch (c) {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                out += fmt::format("\\u{:04x}", static_cast<unsigned>(c));
+            } else {
+                out += c;
+            }
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+void Trace::start(size_t events_per_thread) {
+    gsl_Expects(events_per_thread > 0);
+    auto& reg = registry();
+    {
+        std::lock_guard lock(reg.mutex);
+        reg.capacity = events_per_thread;
+        reg.epoch = std::chrono::steady_clock::now();
+        for (auto const& buffer : reg.buffers) {
+            std::lock_guard buffer_lock(buffer->mutex);
+            buffer->events.clear();
+            buffer->capacity = events_per_thread;
+            buffer->next = 0;
+            buffer->dropped = 0;
+        }
+    }
+    detail::enabled.store(true, std::memory_order_relaxed);
+}
+
+void Trace::stop() { detail::enabled.store(false, std::memory_order_relaxed); }
+
+void Trace::set_thread_name(std::string_view name) {
+    t_thread_name = name;
+    if (t_buffer) {
+        std::lock_guard lock(t_buffer->mutex);
+        t_buffer->thread_name = name;
+    }
+}
+
+void Trace::complete(std::string_view name,
+                     TimePoint begin,
+                     TimePoint end,
+                     std::string_view detail) {
+    if (!enabled()) {
+        return;
+    }
+    Event event{.begin_ns = to_ns(begin),
+                .duration_ns = to_ns(end) - to_ns(begin),
+                .value = 0.0,
+                .phase = Phase::complete,
+                .name = {},
+                .detail = {}};
+    copy_truncated(name, event.name);
+    copy_truncated(detail, event.detail);
+    record(event);
+}
+
+void Trace::counter(std::string_view name, double value) {
+    if (!enabled()) {
+        return;
+    }
+    Event event{.begin_ns = to_ns(std::chrono::steady_clock::now()),
+                .duration_ns = 0,
+                .value = value,
+                .phase = Phase::counter,
+                .name = {},
+                .detail = {}};
+    copy_truncated(name, event.name);
+    record(event);
+}
+
+size_t Trace::write_json(std::ostream& os) {
+    auto& reg = registry();
+    std::lock_guard lock(reg.mutex);
+    auto const epoch_ns = to_ns(reg.epoch);
+    // trace event times are in microseconds
+    auto const us = [](std::int64_t ns) {
+        return static_cast<double>(ns) / 1000.0;
+    };
+
+    os << R"({"displayTimeUnit":"ms","traceEvents":[)" << '\n';
+    os << R"({"name":"process_name","ph":"M","pid":1,)"
+       << R"("args":{"name":"md2view"}})";
+    size_t written = 0;
+    size_t dropped = 0;
+    for (auto const& buffer : reg.buffers) {
+        std::lock_guard buffer_lock(buffer->mutex);
+        dropped += buffer->dropped;
+        if (!buffer->thread_name.empty()) {
+            os << fmt::format(",\n{{\"name\":\"thread_name\",\"ph\":\"M\","
+                              "\"pid\":1,\"tid\":{},\"args\":{{\"name\":"
+                              "\"{}\"}}}}",
+                              buffer->tid, escape(buffer->thread_name));
+        }
+
+        auto const& events = buffer->events;
+        for (size_t i = 0; i < events.size(); ++i) {
+            auto const& event = events[(buffer->next + i) % events.size()];
+            auto const name = escape(event.name.data());
+            auto const ts = us(event.begin_ns - epoch_ns);
+            if (event.phase == Phase::counter) {
+                if (!std::isfinite(event.value)) {
+                    // a bare nan or inf would make the whole file invalid
+                    continue;
+                }
+                os << fmt::format(",\n{{\"name\":\"{}\",\"ph\":\"C\","
+                                  "\"ts\":{:.3f},\"pid\":1,\"tid\":{},"
+                                  "\"args\":{{\"value\":{}}}}}",
+                                  name, ts, buffer->tid, event.value);
+            } else {
+                os << fmt::format(",\n{{\"name\":\"{}\",\"ph\":\"X\","
+                                  "\"ts\":{:.3f},\"dur\":{:.3f},\"pid\":1,"
+                                  "\"tid\":{}",
+                                  name, ts, us(event.duration_ns),
+                                  buffer->tid);
+                if (event.detail[0] != '\0') {
+                    os << fmt::format(R"(,"args":{{"detail":"{}"}})",
+                                      escape(event.detail.data()));
+                }
+                os << '}';
+            }
+            ++written;
+        }
+    }
+    os << "\n]}\n";
+
+    if (dropped > 0) {
+        spdlog::warn("trace ring buffers overflowed; {} oldest events lost",
+                     dropped);
+    }
+    return written;
+}
+
+void Trace::save(std::filesystem::path const& path) {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("failed to open trace file " + path.string());
+    }
+    auto const events = write_json(out);
+    out.close();
+    if (!out) {
+        throw std::runtime_error("failed to write trace file " +
+                                 path.string());
+    }
+    spdlog::info("wrote {} trace events to {}", events, path.string());
+}
@@ -1,11 +1,16 @@
 #include "md2view/ui.hpp"
 #include "md2view/camera.hpp"
-#include "md2view/md2.hpp"
+#include "md2view/frame_profiler.hpp"
+#include "md2view/md2_instance.hpp"
 
 #include <glm/gtc/type_ptr.hpp>
 #include <gsl-lite/gsl-lite.hpp>
 #include <imgui.h>
 
+#include <array>
+#include <cfloat>
+#include <cstdio>
+
 namespace UI {
 
 void draw(Camera& camera) {
@@ -33,18 +38,19 @@ void draw(Camera& camera) {
                       ImGuiInputTextFlags_ReadOnly);
 }
 
-bool draw(MD2& md2) {
+bool draw(MD2Instance& md2) {
+    auto const& model = md2.model();
     int index = gsl_lite::narrow_cast<int>(md2.animation_index());
     constexpr int anim_max_height_in_items = 15;
 
     ImGui::Combo(
         "Animation", &index,
         [](void* data, int idx) -> char const* {
-            auto const* m = static_cast<MD2 const*>(data);
-            gsl_Assert(static_cast<size_t>(idx) < m->animations().size());
-            return m->animations()[idx].name.c_str();
+            auto const& m = static_cast<MD2Instance const*>(data)->model();
+            gsl_Assert(static_cast<size_t>(idx) < m.animations().size());
+            return m.animations()[idx].name.c_str();
         },
-        &md2, gsl_lite::narrow_cast<int>(md2.animations().size()),
+        &md2, gsl_lite::narrow_cast<int>(model.animations().size()),
         anim_max_height_in_items);
 
     md2.set_animation(static_cast<size_t>(index));
@@ -54,16 +60,22 @@ bool draw(MD2& md2) {
     ImGui::Combo(
         "Skin", &sindex,
         [](void* data, int idx) -> char const* {
-            auto const* m = static_cast<MD2 const*>(data);
-            gsl_Assert(static_cast<size_t>(idx) < m->skins().size());
-            return m->skins()[idx].name.c_str();
+            auto const& m = static_cast<MD2Instance const*>(data)->model();
+            gsl_Assert(static_cast<size_t>(idx) < m.skins().size());
+            return m.skins()[idx].name.c_str();
         },
-        &md2, gsl_lite::narrow_cast<int>(md2.skins().size()));
+        &md2, gsl_lite::narrow_cast<int>(model.skins().size()));
 
     float fps = md2.frames_per_second();
     ImGui::InputFloat("Animation FPS", &fps, 1.0f, 5.0f, "%.3f");
     md2.set_frames_per_second(fps);
 
+    constexpr float bytes_per_kib = 1024.0f;
+    ImGui::Text("Model memory: %.1f KiB (%s keyframes)",
+                static_cast<float>(model.memory_usage()) / bytes_per_kib,
+                model.storage() == MD2Model::Storage::compact ? "compact"
+                                                              : "unpacked");
+
     if (static_cast<size_t>(sindex) == md2.skin_index()) {
         return false;
     }
@@ -72,4 +84,61 @@ bool draw(MD2& md2) {
     return true;
 }
 
+void draw(FrameProfiler const& profiler) {
+    using Clock = FrameProfiler::Clock;
+    constexpr auto flags = ImGuiTableFlags_RowBg |
+                           ImGuiTableFlags_BordersOuter |
+                           ImGuiTableFlags_SizingFixedFit;
+    constexpr std::array headings = {"Stage",   "CPU p50", "p95",
+                                     "p99",     "GPU p50", "p95",
+                                     "p99"};
+
+    ImGui::TextDisabled("ms over the last %zu frames",
+                        FrameProfiler::history_size);
+    if (ImGui::BeginTable("stages", headings.size(), flags)) {
+        for (auto const* heading : headings) {
+            ImGui::TableSetupColumn(heading);
+        }
+        ImGui::TableHeadersRow();
+        for (size_t stage = 0; stage < profiler.stage_count(); ++stage) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(profiler.stage_name(stage).c_str());
+            for (auto const clock : {Clock::cpu, Clock::gpu}) {
+                auto const p = profiler.percentiles(stage, clock);
+                for (auto const value : {p.p50, p.p95, p.p99}) {
+                    ImGui::TableNextColumn();
+                    if (p.samples == 0) {
+                        ImGui::TextDisabled("-");
+                    } else {
+                        ImGui::Text("%.3f", value);
+                    }
+                }
+            }
+        }
+        ImGui::EndTable();
+    }
+
+    static int clock = 0;
+    ImGui::RadioButton("CPU", &clock, static_cast<int>(Clock::cpu));
+    ImGui::SameLine();
+    ImGui::RadioButton("GPU", &clock, static_cast<int>(Clock::gpu));
+
+    for (size_t stage = 0; stage < profiler.stage_count(); ++stage) {
+        auto const selected = static_cast<Clock>(clock);
+        auto const history = profiler.history(stage, selected);
+        auto const& name = profiler.stage_name(stage);
+        // the newest samples are still coming in, GPU ones by several
+        // frames, so label the graph with the median rather than the last
+        std::array<char, 64> overlay{};
+        std::snprintf(overlay.data(), overlay.size(), "%s p50 %.3f ms",
+                      name.c_str(), profiler.percentiles(stage, selected).p50);
+        ImGui::PushID(name.c_str());
+        ImGui::PlotLines("", history.data(),
+                         gsl_lite::narrow_cast<int>(history.size()), 0,
+                         overlay.data(), 0.0f, FLT_MAX, ImVec2(0, 40));
+        ImGui::PopID();
+    }
+}
+
 } // namespace UI
@@ -0,0 +1,214 @@
+#include "md2view/vertex_cache.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+/// @name Forsyth's scoring constants
+/// @{
+constexpr float cache_decay_power = 1.5f;
+constexpr float last_triangle_score = 0.75f;
+constexpr float valence_boost_scale = 2.0f;
+constexpr float valence_boost_power = 0.5f;
+/// @}
+
+void expect_triangles(std::span<uint16_t const> indices, size_t vertex_count) {
+    gsl_Expects(indices.size() % 3 == 0);
+    gsl_Expects(std::ranges::all_of(
+        indices, [vertex_count](uint16_t i) { return i < vertex_count; }));
+}
+
+/// Score of a vertex at @p cache_position (npos if not cached) with
+/// @p remaining triangles still to emit.
+float vertex_score(size_t cache_position, uint32_t remaining) {
+    if (remaining == 0) {
+        return -1.0f;
+    }
+
+    float score = 0.0f;
+    if (cache_position < 3) {
+        // the last triangle's vertices score a fixed amount so the next
+        // triangle does not just reuse its edge and strip along
+        score = last_triangle_score;
+    } else if (cache_position < VertexCache::optimize_cache_size) {
+        auto const scale =
+            1.0f / static_cast<float>(VertexCache::optimize_cache_size - 3);
+        score = std::pow(
+            1.0f - (static_cast<float>(cache_position - 3) * scale),
+            cache_decay_power);
+    }
+
+    // finishing off vertices with few triangles left avoids leaving them
+    // stranded for a later, expensive cache miss
+    return score + (valence_boost_scale *
+                    std::pow(static_cast<float>(remaining),
+                             -valence_boost_power));
+}
+
+} // namespace
+
+VertexCache::Stats VertexCache::analyze(std::span<uint16_t const> indices,
+                                        size_t vertex_count,
+                                        size_t cache_size) {
+    expect_triangles(indices, vertex_count);
+    gsl_Expects(cache_size > 0);
+
+    // a vertex is cached while fewer than cache_size misses have happened
+    // since its own, which is a FIFO without moving anything
+    std::vector<size_t> loaded(vertex_count, 0);
+    size_t misses = 0;
+    for (auto const index : indices) {
+        if (loaded[index] == 0 || misses + 1 - loaded[index] > cache_size) {
+            ++misses;
+            loaded[index] = misses;
+        }
+    }
+
+    auto const triangles = indices.size() / 3;
+    return {.acmr = triangles == 0 ? 0.0
+                                   : static_cast<double>(misses) /
+                                         static_cast<double>(triangles),
+            .atvr = vertex_count == 0 ? 0.0
+                                      : static_cast<double>(misses) /
+                                            static_cast<double>(vertex_count)};
+}
+
+void VertexCache::optimize_triangles(std::span<uint16_t> indices,
+                                     size_t vertex_count) {
+    expect_triangles(indices, vertex_count);
+    auto const triangle_count = indices.size() / 3;
+    if (triangle_count < 2) {
+        return;
+    }
+
+    // triangles of each vertex, packed; the first remaining[v] of vertex v's
+    // range are the ones not yet emitted
+    std::vector<uint32_t> first(vertex_count + 1, 0);
+    for (auto const index : indices) {
+        ++first[index + 1];
+    }
+    std::partial_sum(first.begin(), first.end(), first.begin());
+    std::vector<uint32_t> remaining(vertex_count, 0);
+    std::vector<uint32_t> adjacent(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i) {
+        auto const v = indices[i];
+        adjacent[first[v] + remaining[v]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    std::vector<size_t> position(vertex_count, npos);
+    std::vector<float> score(vertex_count);
+    for (size_t v = 0; v < vertex_count; ++v) {
+        score[v] = vertex_score(npos, remaining[v]);
+    }
+    auto const corners = [&](size_t tri) {
+        return indices.subspan(tri * 3, 3);
+    };
+    auto const triangle_score = [&](size_t tri) {
+        auto const c = corners(tri);
+        return score[c[0]] + score[c[1]] + score[c[2]];
+    };
+    std::vector<float> tri_score(triangle_count);
+    std::vector<bool> emitted(triangle_count, false);
+    size_t best = 0;
+    for (size_t tri = 0; tri < triangle_count; ++tri) {
+        tri_score[tri] = triangle_score(tri);
+        if (tri_score[tri] > tri_score[best]) {
+            best = tri;
+        }
+    }
+
+    std::vector<uint16_t> out;
+    out.reserve(indices.size());
+    std::vector<uint16_t> cache;
+    std::vector<uint16_t> next_cache;
+    size_t restart = 0;
+    while (out.size() < indices.size()) {
+        if (best == npos) {
+            // nothing in the cache has triangles left; start afresh from
+            // the first triangle not yet emitted
+            while (emitted[restart]) {
+                ++restart;
+            }
+            best = restart;
+        }
+
+        emitted[best] = true;
+        auto const tri = corners(best);
+        out.insert(out.end(), tri.begin(), tri.end());
+        for (auto const v : tri) {
+            auto const begin = adjacent.begin() + first[v];
+            auto const end = begin + remaining[v];
+            auto const iter = std::find(begin, end, best);
+            gsl_Assert(iter != end);
+            std::iter_swap(iter, end - 1);
+            --remaining[v];
+        }
+
+        // the triangle's vertices move to the front; anything pushed past
+        // the end is evicted but still rescored
+        next_cache.clear();
+        for (auto const v : tri) {
+            if (std::ranges::find(next_cache, v) == next_cache.end()) {
+                next_cache.push_back(v);
+            }
+        }
+        for (auto const v : cache) {
+            if (std::ranges::find(tri, v) == tri.end()) {
+                next_cache.push_back(v);
+            }
+        }
+        for (size_t i = 0; i < next_cache.size(); ++i) {
+            auto const v = next_cache[i];
+            position[v] = i < optimize_cache_size ? i : npos;
+            score[v] = vertex_score(position[v], remaining[v]);
+        }
+
+        best = npos;
+        float best_score = 0.0f;
+        for (auto const v : next_cache) {
+            auto const cached = position[v] != npos;
+            for (uint32_t i = 0; i < remaining[v]; ++i) {
+                auto const other = adjacent[first[v] + i];
+                tri_score[other] = triangle_score(other);
+                if (cached && tri_score[other] > best_score) {
+                    best = other;
+                    best_score = tri_score[other];
+                }
+            }
+        }
+
+        next_cache.resize(std::min(next_cache.size(), optimize_cache_size));
+        std::swap(cache, next_cache);
+    }
+
+    std::ranges::copy(out, indices.begin());
+}
+
+std::vector<uint16_t> VertexCache::optimize_fetch(std::span<uint16_t> indices,
+                                                  size_t vertex_count) {
+    expect_triangles(indices, vertex_count);
+    constexpr auto unused = std::numeric_limits<uint16_t>::max();
+    gsl_Expects(vertex_count <= unused);
+
+    std::vector<uint16_t> new_index(vertex_count, unused);
+    std::vector<uint16_t> order;
+    order.reserve(vertex_count);
+    for (auto& index : indices) {
+        if (new_index[index] == unused) {
+            new_index[index] = static_cast<uint16_t>(order.size());
+            order.push_back(index);
+        }
+        index = new_index[index];
+    }
+    for (size_t v = 0; v < vertex_count; ++v) {
+        if (new_index[v] == unused) {
+            order.push_back(static_cast<uint16_t>(v));
+        }
+    }
+    return order;
+}
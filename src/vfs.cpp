@@ -0,0 +1,131 @@
+#include "md2view/vfs.hpp"
+
+#include <fmt/format.h>
+#include <gsl-lite/gsl-lite.hpp>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <ranges>
+#include <string>
+#include <utility>
+
+VFS::VFS(std::vector<std::filesystem::path> const& search_path,
+         std::optional<std::filesystem::path> index_cache_dir)
+    : index_cache_dir_{std::move(index_cache_dir)} {
+    for (auto const& fpath : search_path) {
+        if (std::filesystem::is_directory(fpath)) {
+            mount_game_dir(fpath);
+        } else {
+            mount(fpath);
+        }
+    }
+}
+
+void VFS::mount(std::filesystem::path const& fpath) {
+    spdlog::info("mounting {}", fpath.string());
+    mounts_.push_back(std::make_unique<PAK>(fpath, index_cache_dir_));
+    build_index();
+}
+
+void VFS::mount_game_dir(std::filesystem::path const& dir) {
+    mount(dir);
+    for (int i = 0;; ++i) {
+        auto const pak = dir / fmt::format("pak{}.pak", i);
+        if (!std::filesystem::is_regular_file(pak)) {
+            break;
+        }
+        mount(pak);
+    }
+}
+
+void VFS::build_index() {
+    // later mounts overwrite earlier ones; the PAK indexes are already
+    // sorted and unique so only the merge needs doing here
+    std::unordered_map<std::string_view, Entry> merged;
+    for (auto const& pak : mounts_) {
+        merged.reserve(merged.size() + pak->size());
+        for (auto const& node : pak->entries()) {
+            merged.insert_or_assign(node.path, Entry{pak.get(), node});
+        }
+    }
+
+    entries_.clear();
+    entries_.reserve(merged.size());
+    for (auto const& entry : merged | std::views::values) {
+        entries_.push_back(entry);
+    }
+    std::ranges::sort(entries_, {},
+                      [](Entry const& entry) { return entry.node.path; });
+
+    index_.clear();
+    index_.reserve(entries_.size());
+    models_.clear();
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        auto const path = entries_[i].node.path;
+        index_.emplace(path, gsl_lite::narrow<uint32_t>(i));
+        if (path.ends_with(".md2")) {
+            models_.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    spdlog::info("{} mounts, {} visible entries, {} models", mounts_.size(),
+                 entries_.size(), models_.size());
+}
+
+VFS::Entry const* VFS::resolve(std::string_view fpath) const {
+    auto const iter = index_.find(fpath);
+    return iter == index_.end() ? nullptr : &entries_[iter->second];
+}
+
+std::optional<PAK::Node> VFS::find(std::string_view fpath) const {
+    if (auto const* entry = resolve(fpath)) {
+        return entry->node;
+    }
+    return std::nullopt;
+}
+
+bool VFS::contains(std::filesystem::path const& fpath) const {
+    if (resolve(fpath.generic_string()) != nullptr) {
+        return true;
+    }
+    return std::ranges::any_of(mounts_, [&](auto const& pak) {
+        return pak->is_directory() && pak->contains(fpath);
+    });
+}
+
+MappedBytes VFS::view(std::filesystem::path const& fpath) const {
+    if (auto const* entry = resolve(fpath.generic_string())) {
+        return entry->pak->view(fpath);
+    }
+    // a file added to a directory mount since it was indexed
+    for (auto const& pak : mounts_ | std::views::reverse) {
+        if (pak->is_directory() && pak->contains(fpath)) {
+            return pak->view(fpath);
+        }
+    }
+    gsl_FailFast();
+}
+
+SpanStream VFS::open_ifstream(std::filesystem::path const& fpath) const {
+    if (!contains(fpath)) {
+        spdlog::warn("no file {} in search path", fpath.string());
+        return {};
+    }
+    auto const bytes = view(fpath);
+    return SpanStream{bytes.bytes(), bytes.file()};
+}
+
+std::span<VFS::Entry const>
+VFS::directory_range(std::string_view dir) const {
+    std::string prefix{dir};
+    if (!prefix.empty() && !prefix.ends_with('/')) {
+        prefix += '/';
+    }
+    auto const by_path = [](Entry const& entry) { return entry.node.path; };
+    auto const first = std::ranges::lower_bound(
+        entries_, std::string_view{prefix}, {}, by_path);
+    auto const last = std::ranges::partition_point(
+        first, entries_.end(), [&](Entry const& entry) {
+            return entry.node.path.starts_with(prefix);
+        });
+    return {first, last};
+}
@@ -1,10 +1,13 @@
 // Generates minimal valid test fixture files.
 // Usage: gen_fixtures <output_dir>
 #include <array>
+#include <cmath>
 #include <cstdint>
+#include <cstdio>
 #include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <vector>
 
 static void write_u8(std::ofstream& f, uint8_t v) {
     f.put(static_cast<char>(v));
@@ -128,46 +131,60 @@ static void write_pak(std::filesystem::path const& path) {
     write_i32le(f, content_len);
 }
 
-// Writes an MD2 header and shared geometry (texcoords + triangle) for 3
-// vertices / 1 triangle.  Returns the file offset just after the triangle so
-// the caller can write frames immediately.
-static int32_t write_md2_header_and_geometry(std::ofstream& f,
-                                             int32_t num_frames) {
+// Section counts for an MD2 file written by write_md2_header().
+struct MD2Counts {
+    int32_t num_xyz;
+    int32_t num_st;
+    int32_t num_tris;
+    int32_t num_frames;
+    int32_t num_glcmds = 0;
+    int32_t skinwidth = 2;
+    int32_t skinheight = 2;
+};
+
+// Writes a 68-byte MD2 header. Sections follow the header in the order
+// texcoords, triangles, frames, glcmds (no skins).
+static void write_md2_header(std::ofstream& f, MD2Counts const& c) {
     int32_t const ident = 844121161; // "IDP2"
     int32_t const version = 8;
-    int32_t const skinwidth = 2;
-    int32_t const skinheight = 2;
     int32_t const num_skins = 0;
-    int32_t const num_xyz = 3;
-    int32_t const num_st = 3;
-    int32_t const num_tris = 1;
-    int32_t const num_glcmds = 0;
-    int32_t const framesize = 12 + 12 + 16 + num_xyz * 4; // 52
+    int32_t const framesize = 12 + 12 + 16 + c.num_xyz * 4;
 
     int32_t const offset_skins = 68;
     int32_t const offset_st = offset_skins;
-    int32_t const offset_tris = offset_st + num_st * 4;
-    int32_t const offset_frames = offset_tris + num_tris * 12;
-    int32_t const offset_glcmds = offset_frames + num_frames * framesize;
-    int32_t const offset_end = offset_glcmds;
+    int32_t const offset_tris = offset_st + c.num_st * 4;
+    int32_t const offset_frames = offset_tris + c.num_tris * 12;
+    int32_t const offset_glcmds = offset_frames + c.num_frames * framesize;
+    int32_t const offset_end = offset_glcmds + c.num_glcmds * 4;
 
     write_i32le(f, ident);
     write_i32le(f, version);
-    write_i32le(f, skinwidth);
-    write_i32le(f, skinheight);
+    write_i32le(f, c.skinwidth);
+    write_i32le(f, c.skinheight);
     write_i32le(f, framesize);
     write_i32le(f, num_skins);
-    write_i32le(f, num_xyz);
-    write_i32le(f, num_st);
-    write_i32le(f, num_tris);
-    write_i32le(f, num_glcmds);
-    write_i32le(f, num_frames);
+    write_i32le(f, c.num_xyz);
+    write_i32le(f, c.num_st);
+    write_i32le(f, c.num_tris);
+    write_i32le(f, c.num_glcmds);
+    write_i32le(f, c.num_frames);
     write_i32le(f, offset_skins);
     write_i32le(f, offset_st);
     write_i32le(f, offset_tris);
     write_i32le(f, offset_frames);
     write_i32le(f, offset_glcmds);
     write_i32le(f, offset_end);
+}
+
+// Writes an MD2 header and shared geometry (texcoords + triangle) for 3
+// vertices / 1 triangle.  Returns the file offset just after the triangle so
+// the caller can write frames immediately.
+static int32_t write_md2_header_and_geometry(std::ofstream& f,
+                                             int32_t num_frames) {
+    write_md2_header(f, {.num_xyz = 3,
+                         .num_st = 3,
+                         .num_tris = 1,
+                         .num_frames = num_frames});
 
     // Texcoords: (0,0),(1,0),(0,1) → scaled (0,0),(0.5,0),(0,0.5)
     int16_t texcoords[3][2] = {{0, 0}, {1, 0}, {0, 1}};
@@ -177,24 +194,27 @@ static int32_t write_md2_header_and_geometry(std::ofstream& f,
     uint16_t tri[6] = {0, 1, 2, 0, 1, 2};
     f.write(reinterpret_cast<char*>(tri), sizeof(tri));
 
-    return offset_frames;
+    return 68 + 3 * 4 + 12;
 }
 
 // Write one MD2 keyframe. Each vertex is {v[0], v[1], v[2], normal}.
-// Loader remaps: v[0]→x, v[1]→z, v[2]→y with scale=(1,1,1) translate=(0,0,0).
-static void
-write_md2_frame(std::ofstream& f, char const* name, uint8_t verts[3][4]) {
-    // scale = (1,1,1), translate = (0,0,0)
-    write_f32le(f, 1.0f);
-    write_f32le(f, 1.0f);
-    write_f32le(f, 1.0f);
-    write_f32le(f, 0.0f);
-    write_f32le(f, 0.0f);
-    write_f32le(f, 0.0f);
+// Loader remaps: v[0]→x, v[1]→z, v[2]→y after applying scale and translate
+// (default scale=(1,1,1) translate=(0,0,0)).
+static void write_md2_frame(std::ofstream& f,
+                            char const* name,
+                            uint8_t const (*verts)[4],
+                            int32_t num_xyz = 3,
+                            std::array<float, 3> scale = {1.0f, 1.0f, 1.0f},
+                            std::array<float, 3> translate = {}) {
+    for (float v : scale)
+        write_f32le(f, v);
+    for (float v : translate)
+        write_f32le(f, v);
     std::array<char, 16> fname{};
     std::strncpy(fname.data(), name, 15);
     f.write(fname.data(), 16);
-    f.write(reinterpret_cast<char*>(verts[0]), 12); // 3 vertices × 4 bytes
+    f.write(reinterpret_cast<char const*>(verts[0]),
+            num_xyz * 4); // num_xyz vertices × 4 bytes
 }
 
 // Two-frame MD2: animation "stand" with frames 0..1.
@@ -235,6 +255,137 @@ static void write_md2(std::filesystem::path const& path) {
     write_md2_frame(f, "stand0", verts);
 }
 
+// Write one GL command: a strip of @p vertices, or a fan if @p fan. Each
+// vertex is {s, t, xyz index}.
+static void write_md2_glcmd(std::ofstream& f,
+                            bool fan,
+                            std::vector<std::array<float, 3>> const& vertices) {
+    auto const count = static_cast<int32_t>(vertices.size());
+    write_i32le(f, fan ? -count : count);
+    for (auto const& [s, t, index] : vertices) {
+        write_f32le(f, s);
+        write_f32le(f, t);
+        write_i32le(f, static_cast<int32_t>(index));
+    }
+}
+
+// Quad MD2: 4 vertices, 2 triangles sharing an edge, 1 frame "stand0".
+//
+//   tri 0: xyz [0,1,2] st [0,1,2]
+//   tri 1: xyz [0,2,3] st [4,2,3]
+//
+// xyz 0 is used with two different texcoords (0 and 4) so an indexed layout
+// welds the 6 corners into 5 unique vertices: (0,0) (1,1) (2,2) (0,4) (3,3).
+//
+// GL commands: one fan over xyz [0,1,2,3] with st (0,0) (.5,0) (.5,.5)
+// (0,.5), then the terminating 0.
+static void write_quad_md2(std::filesystem::path const& path) {
+    std::ofstream f(path, std::ios::binary);
+    write_md2_header(f, {.num_xyz = 4,
+                         .num_st = 5,
+                         .num_tris = 2,
+                         .num_frames = 1,
+                         .num_glcmds = 1 + (4 * 3) + 1,
+                         .skinwidth = 4,
+                         .skinheight = 4});
+
+    int16_t texcoords[5][2] = {{0, 0}, {2, 0}, {2, 2}, {0, 2}, {1, 1}};
+    f.write(reinterpret_cast<char*>(texcoords), sizeof(texcoords));
+
+    uint16_t tris[2][6] = {{0, 1, 2, 0, 1, 2}, {0, 2, 3, 4, 2, 3}};
+    f.write(reinterpret_cast<char*>(tris), sizeof(tris));
+
+    uint8_t const verts[4][4] = {
+        {0, 0, 0, 0}, {1, 0, 0, 0}, {1, 0, 1, 0}, {0, 0, 1, 0}};
+    write_md2_frame(f, "stand0", verts, 4);
+
+    write_md2_glcmd(f, true,
+                    {{0.0f, 0.0f, 0}, {0.5f, 0.0f, 1}, {0.5f, 0.5f, 2},
+                     {0.0f, 0.5f, 3}});
+    write_i32le(f, 0);
+}
+
+// Grid MD2: an n x n vertex height field, 2 * (n-1)^2 triangles, with
+// `num_frames` frames "wave0".."wave<num_frames-1>" of a travelling sine wave.
+// Each frame uses a different scale and translate so dequantization is
+// exercised.
+//
+// GL commands: one strip of 2n vertices per row of quads, covering the same
+// triangles with the same winding and texcoords as the triangle list.
+static void write_grid_md2(std::filesystem::path const& path,
+                           int n,
+                           int num_frames) {
+    int const num_xyz = n * n;
+    int const num_tris = (n - 1) * (n - 1) * 2;
+    int const step = 255 / (n - 1);
+    int const skin_size = (n - 1) * 4;
+
+    std::ofstream f(path, std::ios::binary);
+    write_md2_header(f, {.num_xyz = num_xyz,
+                         .num_st = num_xyz,
+                         .num_tris = num_tris,
+                         .num_frames = num_frames,
+                         .num_glcmds = ((n - 1) * (1 + (2 * n * 3))) + 1,
+                         .skinwidth = skin_size,
+                         .skinheight = skin_size});
+
+    for (int y = 0; y < n; ++y) {
+        for (int x = 0; x < n; ++x) {
+            write_u16le(f, static_cast<uint16_t>(x * 4));
+            write_u16le(f, static_cast<uint16_t>(y * 4));
+        }
+    }
+
+    for (int y = 0; y + 1 < n; ++y) {
+        for (int x = 0; x + 1 < n; ++x) {
+            auto const i = static_cast<uint16_t>((y * n) + x);
+            auto const right = static_cast<uint16_t>(i + 1);
+            auto const down = static_cast<uint16_t>(i + n);
+            auto const diag = static_cast<uint16_t>(i + n + 1);
+            for (uint16_t v : {i, right, diag, i, right, diag})
+                write_u16le(f, v);
+            for (uint16_t v : {i, diag, down, i, diag, down})
+                write_u16le(f, v);
+        }
+    }
+
+    std::vector<std::array<uint8_t, 4>> verts(static_cast<size_t>(num_xyz));
+    for (int frame = 0; frame < num_frames; ++frame) {
+        for (int y = 0; y < n; ++y) {
+            for (int x = 0; x < n; ++x) {
+                auto const phase = static_cast<float>(x + frame) * 0.75f;
+                auto& v = verts[static_cast<size_t>((y * n) + x)];
+                v[0] = static_cast<uint8_t>(x * step);
+                v[1] = static_cast<uint8_t>(y * step);
+                v[2] = static_cast<uint8_t>(127.5f + 127.0f * std::sin(phase));
+            }
+        }
+        std::array<char, 16> name{};
+        std::snprintf(name.data(), name.size(), "wave%d", frame);
+        auto const k = static_cast<float>(frame);
+        write_md2_frame(f, name.data(),
+                        reinterpret_cast<uint8_t const(*)[4]>(verts.data()),
+                        num_xyz, {0.1f + (0.01f * k), 0.1f, 0.02f},
+                        {-8.0f, -8.0f + k, 0.5f * k});
+    }
+
+    // alternating the row below and the row above gives the triangles
+    // (down, i, diag) and (i, right, diag) of each quad
+    auto const st = [&](int coord) {
+        return static_cast<float>(coord * 4) / static_cast<float>(skin_size);
+    };
+    for (int y = 0; y + 1 < n; ++y) {
+        std::vector<std::array<float, 3>> strip;
+        for (int x = 0; x < n; ++x) {
+            strip.push_back(
+                {st(x), st(y + 1), static_cast<float>(((y + 1) * n) + x)});
+            strip.push_back({st(x), st(y), static_cast<float>((y * n) + x)});
+        }
+        write_md2_glcmd(f, false, strip);
+    }
+    write_i32le(f, 0);
+}
+
 int main(int argc, char* argv[]) {
     if (argc != 2) {
         return 1;
@@ -246,5 +397,8 @@ int main(int argc, char* argv[]) {
     write_md2(dir / "minimal.md2");
     write_two_frame_md2(dir / "two_frame.md2");
     write_two_anim_md2(dir / "two_anim.md2");
+    write_quad_md2(dir / "quad.md2");
+    write_grid_md2(dir / "grid.md2", 17, 4);
+    write_grid_md2(dir / "bench.md2", 33, 40);
     return 0;
 }
@@ -0,0 +1,126 @@
+#include "md2view/frame_pacer.hpp"
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <gsl-lite/gsl-lite.hpp>
+
+#include <chrono>
+
+using Catch::Approx;
+
+TEST_CASE("frame pacer variable step follows frame time", "[frame_pacer]") {
+    FramePacer pacer;
+    auto const first = pacer.begin_frame(10.0);
+    REQUIRE(first.dt == 0.0);
+    REQUIRE(first.steps == 1);
+
+    auto const frame = pacer.begin_frame(10.02);
+    REQUIRE(frame.dt == Approx(0.02));
+    REQUIRE(frame.steps == 1);
+    REQUIRE(frame.step_dt == Approx(0.02));
+}
+
+TEST_CASE("frame pacer clamps long frames", "[frame_pacer]") {
+    FramePacer pacer;
+    (void)pacer.begin_frame(0.0);
+    REQUIRE(pacer.begin_frame(5.0).dt == Approx(FramePacer::max_frame_time));
+    // time going backwards is not a negative step
+    REQUIRE(pacer.begin_frame(4.0).dt == 0.0);
+}
+
+TEST_CASE("frame pacer fixed step decouples updates from frames",
+          "[frame_pacer]") {
+    FramePacer pacer{{.update_hz = 60.0}};
+    (void)pacer.begin_frame(0.0);
+
+    // a 30 Hz frame owes two 60 Hz updates
+    auto const slow = pacer.begin_frame(1.0 / 30.0);
+    REQUIRE(slow.steps == 2);
+    REQUIRE(slow.step_dt == Approx(1.0 / 60.0));
+
+    // 144 Hz frames run an update only once enough time has built up
+    int steps = 0;
+    auto now = 1.0 / 30.0;
+    for (int i = 0; i < 144; ++i) {
+        now += 1.0 / 144.0;
+        auto const frame = pacer.begin_frame(now);
+        REQUIRE(frame.steps <= 1);
+        steps += frame.steps;
+    }
+    REQUIRE(steps >= 59);
+    REQUIRE(steps <= 60);
+}
+
+TEST_CASE("frame pacer caps the fixed step backlog", "[frame_pacer]") {
+    FramePacer pacer{{.update_hz = 1000.0}};
+    (void)pacer.begin_frame(0.0);
+    REQUIRE(pacer.begin_frame(0.2).steps == FramePacer::max_steps);
+    // the dropped backlog is not run on later frames
+    REQUIRE(pacer.begin_frame(0.2).steps == 0);
+}
+
+TEST_CASE("frame pacer run updates once per frame", "[frame_pacer]") {
+    int steps = 0;
+    int updates = 0;
+    auto const advance = [&](double step_dt) {
+        REQUIRE(step_dt == Approx(0.01));
+        ++steps;
+    };
+    auto const update = [&] { ++updates; };
+
+    FramePacer::run({.dt = 0.03, .steps = 3, .step_dt = 0.01}, advance,
+                    update);
+    REQUIRE(steps == 3);
+    REQUIRE(updates == 1);
+
+    // a frame that owes no step still finishes loads and redraws
+    FramePacer::run({.dt = 0.005, .steps = 0, .step_dt = 0.01}, advance,
+                    update);
+    REQUIRE(steps == 3);
+    REQUIRE(updates == 2);
+}
+
+TEST_CASE("frame pacer reset forgets idle time", "[frame_pacer]") {
+    FramePacer pacer{{.update_hz = 60.0}};
+    (void)pacer.begin_frame(0.0);
+    (void)pacer.begin_frame(0.01);
+    pacer.reset(3.0);
+    auto const frame = pacer.begin_frame(3.0);
+    REQUIRE(frame.dt == 0.0);
+    REQUIRE(frame.steps == 0);
+}
+
+TEST_CASE("frame pacer frame cap schedules from deadlines",
+          "[frame_pacer]") {
+    FramePacer uncapped;
+    REQUIRE(uncapped.end_frame(1.0) == 0.0);
+
+    FramePacer pacer{{.max_fps = 100.0}};
+    pacer.reset(0.0);
+    REQUIRE(pacer.end_frame(0.004) == Approx(0.006));
+    // oversleeping by 2 ms shortens the next wait instead of lowering the
+    // frame rate
+    REQUIRE(pacer.end_frame(0.012) == Approx(0.008));
+    // a frame that overran starts a new schedule with no wait
+    REQUIRE(pacer.end_frame(0.05) == 0.0);
+    REQUIRE(pacer.end_frame(0.051) == Approx(0.009));
+}
+
+TEST_CASE("frame pacer sleep waits at least as long as asked",
+          "[frame_pacer]") {
+    using clock = std::chrono::steady_clock;
+    auto const start = clock::now();
+    FramePacer::sleep_for(0.005);
+    auto const slept =
+        std::chrono::duration<double>(clock::now() - start).count();
+    REQUIRE(slept >= 0.005);
+    // loose: a loaded machine may deschedule the spin
+    REQUIRE(slept < 0.1);
+
+    FramePacer::sleep_for(-1.0);
+}
+
+TEST_CASE("frame pacer negative rates throw", "[frame_pacer]") {
+    REQUIRE_THROWS_AS(FramePacer{{.update_hz = -1.0}}, gsl_lite::fail_fast);
+    REQUIRE_THROWS_AS(FramePacer{{.max_fps = -1.0}}, gsl_lite::fail_fast);
+}
@@ -0,0 +1,110 @@
+#include "md2view/frame_profiler.hpp"
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <gsl-lite/gsl-lite.hpp>
+
+#include <thread>
+
+using Catch::Approx;
+using Clock = FrameProfiler::Clock;
+
+TEST_CASE("frame profiler stages are found by name", "[frame_profiler]") {
+    FrameProfiler profiler;
+    auto const animate = profiler.stage("animate");
+    auto const sync = profiler.stage("sync");
+    REQUIRE(animate != sync);
+    REQUIRE(profiler.stage("animate") == animate);
+    REQUIRE(profiler.stage_count() == 2);
+    REQUIRE(profiler.stage_name(sync) == "sync");
+    REQUIRE_THROWS_AS((void)profiler.stage_name(2), gsl_lite::fail_fast);
+}
+
+TEST_CASE("frame profiler adds up samples within a frame",
+          "[frame_profiler]") {
+    FrameProfiler profiler;
+    auto const stage = profiler.stage("animate");
+    profiler.record(stage, Clock::cpu, 1.0f);
+    profiler.record(stage, Clock::cpu, 0.5f);
+    profiler.begin_frame();
+    profiler.record(stage, Clock::cpu, 2.0f);
+
+    REQUIRE(profiler.history(stage, Clock::cpu) ==
+            std::vector<float>{1.5f, 2.0f});
+    // the clocks are kept apart
+    REQUIRE(profiler.history(stage, Clock::gpu) ==
+            std::vector<float>{0.0f, 0.0f});
+    REQUIRE(profiler.percentiles(stage, Clock::gpu).samples == 0);
+}
+
+TEST_CASE("frame profiler records late samples against their frame",
+          "[frame_profiler]") {
+    FrameProfiler profiler;
+    auto const stage = profiler.stage("main pass");
+    profiler.begin_frame();
+    profiler.begin_frame();
+    profiler.begin_frame();
+    profiler.record(stage, Clock::gpu, 1, 4.0f);
+
+    REQUIRE(profiler.history(stage, Clock::gpu) ==
+            std::vector<float>{0.0f, 4.0f, 0.0f, 0.0f});
+    REQUIRE_THROWS_AS(profiler.record(stage, Clock::gpu, 4, 1.0f),
+                      gsl_lite::fail_fast);
+
+    // a sample from before the window is dropped
+    for (size_t i = 0; i < FrameProfiler::history_size; ++i) {
+        profiler.begin_frame();
+    }
+    profiler.record(stage, Clock::gpu, 2, 8.0f);
+    REQUIRE(profiler.percentiles(stage, Clock::gpu).samples == 0);
+}
+
+TEST_CASE("frame profiler history rolls over", "[frame_profiler]") {
+    FrameProfiler profiler;
+    auto const stage = profiler.stage("ui");
+    auto const frames = FrameProfiler::history_size + 10;
+    for (size_t frame = 0; frame < frames; ++frame) {
+        if (frame > 0) {
+            profiler.begin_frame();
+        }
+        profiler.record(stage, Clock::cpu, static_cast<float>(frame));
+    }
+
+    auto const history = profiler.history(stage, Clock::cpu);
+    REQUIRE(history.size() == FrameProfiler::history_size);
+    REQUIRE(history.front() == Approx(10.0f));
+    REQUIRE(history.back() == Approx(static_cast<float>(frames - 1)));
+}
+
+TEST_CASE("frame profiler percentiles use nearest rank", "[frame_profiler]") {
+    FrameProfiler profiler;
+    auto const stage = profiler.stage("post");
+    // 1..100 ms, one per frame, out of order
+    for (int i = 0; i < 100; ++i) {
+        if (i > 0) {
+            profiler.begin_frame();
+        }
+        profiler.record(stage, Clock::gpu,
+                        static_cast<float>(((i * 37) % 100) + 1));
+    }
+
+    auto const p = profiler.percentiles(stage, Clock::gpu);
+    REQUIRE(p.samples == 100);
+    REQUIRE(p.p50 == Approx(50.0f));
+    REQUIRE(p.p95 == Approx(95.0f));
+    REQUIRE(p.p99 == Approx(99.0f));
+    REQUIRE(p.max == Approx(100.0f));
+}
+
+TEST_CASE("frame profiler scope records elapsed cpu time",
+          "[frame_profiler]") {
+    FrameProfiler profiler;
+    auto const stage = profiler.stage("sleep");
+    {
+        FrameProfiler::Scope const scope{profiler, stage};
+        std::this_thread::sleep_for(std::chrono::milliseconds{2});
+    }
+    auto const p = profiler.percentiles(stage, Clock::cpu);
+    REQUIRE(p.samples == 1);
+    REQUIRE(p.max >= 2.0f);
+}
@@ -0,0 +1,76 @@
+#include "md2view/lru_cache.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <memory>
+#include <stdexcept>
+
+TEST_CASE("lru cache counts hits and misses", "[lru]") {
+    LruCache<int> cache{"test"};
+    REQUIRE(cache.find("a") == nullptr);
+    cache.insert("a", std::make_shared<int>(1), 10);
+    REQUIRE(*cache.find("a") == 1);
+    REQUIRE(cache.contains("a"));
+    REQUIRE_FALSE(cache.contains("b"));
+
+    REQUIRE(cache.stats().hits == 1);
+    REQUIRE(cache.stats().misses == 1);
+    REQUIRE(cache.size() == 1);
+    REQUIRE(cache.bytes() == 10);
+    REQUIRE_THROWS_AS(cache.at("b"), std::out_of_range);
+}
+
+TEST_CASE("lru cache insert keeps an existing entry", "[lru]") {
+    LruCache<int> cache{"test"};
+    cache.insert("a", std::make_shared<int>(1), 10);
+    auto const kept = cache.insert("a", std::make_shared<int>(2), 20);
+    REQUIRE(*kept == 1);
+    REQUIRE(cache.bytes() == 10);
+}
+
+TEST_CASE("lru cache evicts least recently used first", "[lru]") {
+    LruCache<int> cache{"test", 30};
+    cache.insert("a", std::make_shared<int>(1), 10);
+    cache.insert("b", std::make_shared<int>(2), 10);
+    cache.insert("c", std::make_shared<int>(3), 10);
+    // touch a so b is now the oldest
+    REQUIRE(cache.find("a"));
+    cache.insert("d", std::make_shared<int>(4), 10);
+
+    REQUIRE_FALSE(cache.contains("b"));
+    REQUIRE(cache.contains("a"));
+    REQUIRE(cache.contains("c"));
+    REQUIRE(cache.contains("d"));
+    REQUIRE(cache.bytes() == 30);
+    REQUIRE(cache.stats().evictions == 1);
+}
+
+TEST_CASE("lru cache keeps entries referenced elsewhere", "[lru]") {
+    LruCache<int> cache{"test", 15};
+    auto const held = cache.insert("a", std::make_shared<int>(1), 10);
+    cache.insert("b", std::make_shared<int>(2), 10);
+
+    // a is the oldest but still in use, and b is the newest
+    REQUIRE(cache.contains("a"));
+    REQUIRE(cache.contains("b"));
+    REQUIRE(cache.bytes() == 20);
+
+    cache.insert("c", std::make_shared<int>(3), 1);
+    REQUIRE(cache.contains("a"));
+    REQUIRE_FALSE(cache.contains("b"));
+    REQUIRE(cache.bytes() == 11);
+}
+
+TEST_CASE("lru cache set_budget evicts at once", "[lru]") {
+    LruCache<int> cache{"test"};
+    cache.insert("a", std::make_shared<int>(1), 10);
+    cache.insert("b", std::make_shared<int>(2), 10);
+    cache.insert("c", std::make_shared<int>(3), 10);
+    REQUIRE(cache.stats().evictions == 0);
+
+    cache.set_budget(10);
+    REQUIRE(cache.size() == 1);
+    REQUIRE(cache.contains("c"));
+    REQUIRE(cache.budget() == 10);
+    REQUIRE(cache.stats().evictions == 2);
+}
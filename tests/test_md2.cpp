@@ -1,15 +1,28 @@
 #include "fixtures.hpp"
+#include "md2view/frame_pacer.hpp"
+#include "md2view/mapped_file.hpp"
 #include "md2view/md2.hpp"
 #include "md2view/pak.hpp"
+#include "md2view/simd_lerp.hpp"
+#include "md2view/thread_pool.hpp"
 #include "tmpdir.hpp"
 
 #include <catch2/catch_approx.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <gsl-lite/gsl-lite.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <memory>
+#include <sstream>
 #include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 
 // Load an md2 fixture by filename via a directory-mode PAK.
 // The file is copied into a per-fixture static TmpDir as "tris.md2".
@@ -25,6 +38,18 @@ static MD2 load_md2_fixture(char const* fixture_name,
     return MD2{"models/player/tris.md2", pak};
 }
 
+static MD2 load_quad(MD2Model::Layout layout) {
+    static TmpDir tmp;
+    auto model_dir = tmp.path() / "models" / "player";
+    std::filesystem::create_directories(model_dir);
+    auto dest = model_dir / "tris.md2";
+    if (!std::filesystem::exists(dest)) {
+        std::filesystem::copy_file(test_fixtures_dir() / "quad.md2", dest);
+    }
+    PAK pak{tmp.path()};
+    return MD2{"models/player/tris.md2", pak, layout};
+}
+
 static MD2 load_fixture() {
     static TmpDir tmp;
     return load_md2_fixture("minimal.md2", tmp.path());
@@ -49,7 +74,7 @@ TEST_CASE("md2 non-existent", "[md2]") {
 
 TEST_CASE("md2 valid header fields", "[md2]") {
     auto md2 = load_fixture();
-    auto const& hdr = md2.header();
+    auto const& hdr = md2.model().header();
 
     REQUIRE(hdr.ident == 844121161);
     REQUIRE(hdr.version == 8);
@@ -63,10 +88,10 @@ TEST_CASE("md2 valid header fields", "[md2]") {
 TEST_CASE("md2 animation parsed from frame name", "[md2]") {
     auto md2 = load_fixture();
 
-    REQUIRE(md2.animations().size() == 1);
-    REQUIRE(md2.animations()[0].name == "stand");
-    REQUIRE(md2.animations()[0].start_frame == 0);
-    REQUIRE(md2.animations()[0].end_frame == 0);
+    REQUIRE(md2.model().animations().size() == 1);
+    REQUIRE(md2.model().animations()[0].name == "stand");
+    REQUIRE(md2.model().animations()[0].start_frame == 0);
+    REQUIRE(md2.model().animations()[0].end_frame == 0);
 }
 
 TEST_CASE("md2 interpolated vertex count", "[md2]") {
@@ -97,13 +122,13 @@ TEST_CASE("md2 interpolated vertex positions", "[md2]") {
 
 TEST_CASE("md2 scaled texcoord count", "[md2]") {
     auto md2 = load_fixture();
-    REQUIRE(md2.scaled_texcoords().size() == 3);
+    REQUIRE(md2.model().scaled_texcoords().size() == 3);
 }
 
 TEST_CASE("md2 scaled texcoord values", "[md2]") {
     using Catch::Approx;
     auto md2 = load_fixture();
-    auto const& tc = md2.scaled_texcoords();
+    auto const& tc = md2.model().scaled_texcoords();
 
     // skinwidth=2, skinheight=2; raw texcoords: (0,0),(1,0),(0,1)
     REQUIRE(tc[0].x == Approx(0.0f));
@@ -179,9 +204,9 @@ TEST_CASE("md2 set skin index out of range throws", "[md2]") {
 
 TEST_CASE("md2 two-frame animation end frame", "[md2]") {
     auto md2 = load_two_frame();
-    REQUIRE(md2.animations().size() == 1);
-    REQUIRE(md2.animations()[0].start_frame == 0);
-    REQUIRE(md2.animations()[0].end_frame == 1);
+    REQUIRE(md2.model().animations().size() == 1);
+    REQUIRE(md2.model().animations()[0].start_frame == 0);
+    REQUIRE(md2.model().animations()[0].end_frame == 1);
 }
 
 TEST_CASE("md2 update paused does not advance vertices", "[md2]") {
@@ -216,17 +241,17 @@ TEST_CASE("md2 update advances to next frame", "[md2]") {
 
 TEST_CASE("md2 multiple animations count", "[md2]") {
     auto md2 = load_two_anim();
-    REQUIRE(md2.animations().size() == 2);
+    REQUIRE(md2.model().animations().size() == 2);
 }
 
 TEST_CASE("md2 multiple animations frame ranges", "[md2]") {
     auto md2 = load_two_anim();
-    REQUIRE(md2.animations()[0].name == "stand");
-    REQUIRE(md2.animations()[0].start_frame == 0);
-    REQUIRE(md2.animations()[0].end_frame == 1);
-    REQUIRE(md2.animations()[1].name == "run");
-    REQUIRE(md2.animations()[1].start_frame == 2);
-    REQUIRE(md2.animations()[1].end_frame == 3);
+    REQUIRE(md2.model().animations()[0].name == "stand");
+    REQUIRE(md2.model().animations()[0].start_frame == 0);
+    REQUIRE(md2.model().animations()[0].end_frame == 1);
+    REQUIRE(md2.model().animations()[1].name == "run");
+    REQUIRE(md2.model().animations()[1].start_frame == 2);
+    REQUIRE(md2.model().animations()[1].end_frame == 3);
 }
 
 TEST_CASE("md2 set animation by name", "[md2]") {
@@ -242,3 +267,538 @@ TEST_CASE("md2 set animation by index", "[md2]") {
     md2.set_animation(size_t{0});
     REQUIRE(md2.animation_index() == 0);
 }
+
+// --- parsing from a byte span ---
+
+TEST_CASE("md2 from byte span matches pak load", "[md2]") {
+    auto const bytes = read_fixture_bytes("two_frame.md2");
+    MD2 md2{std::span<std::byte const>{bytes}};
+    auto expected = load_two_frame();
+
+    REQUIRE(md2.model().header().num_frames ==
+            expected.model().header().num_frames);
+    REQUIRE(md2.model().animations().size() ==
+            expected.model().animations().size());
+    REQUIRE(md2.interpolated_vertices() == expected.interpolated_vertices());
+    REQUIRE(md2.model().scaled_texcoords() ==
+            expected.model().scaled_texcoords());
+}
+
+TEST_CASE("md2 model from stream matches byte span", "[md2]") {
+    auto const bytes = read_fixture_bytes("two_frame.md2");
+    MD2Model const expected{std::span<std::byte const>{bytes}};
+
+    std::ifstream f(test_fixtures_dir() / "two_frame.md2", std::ios::binary);
+    MD2Model const model{f};
+    REQUIRE(model.header().num_frames == expected.header().num_frames);
+    REQUIRE(std::ranges::equal(model.key_frames(), expected.key_frames()));
+    REQUIRE(model.scaled_texcoords() == expected.scaled_texcoords());
+
+    std::istringstream truncated{
+        std::string(reinterpret_cast<char const*>(bytes.data()),
+                    bytes.size() - 1)};
+    REQUIRE_THROWS_AS(MD2Model{truncated}, std::runtime_error);
+}
+
+TEST_CASE("md2 from mapped file", "[md2]") {
+    MappedFile mapped{test_fixtures_dir() / "minimal.md2"};
+    REQUIRE_FALSE(mapped.empty());
+    MD2 md2{mapped.bytes()};
+    REQUIRE(md2.interpolated_vertices().size() == 3);
+}
+
+TEST_CASE("md2 from truncated span throws", "[md2]") {
+    auto const bytes = read_fixture_bytes("minimal.md2");
+    // cut the file off part way through the frame section
+    auto const truncated =
+        std::span<std::byte const>{bytes}.first(bytes.size() - 4);
+    auto construct = [&]() { MD2{truncated}; };
+    REQUIRE_THROWS_AS(construct(), std::runtime_error);
+}
+
+TEST_CASE("md2 from span with bad magic throws", "[md2]") {
+    auto bytes = read_fixture_bytes("minimal.md2");
+    bytes[0] = std::byte{'X'};
+    auto construct = [&]() { MD2{std::span<std::byte const>{bytes}}; };
+    REQUIRE_THROWS_AS(construct(), std::runtime_error);
+}
+
+// --- indexed layout (quad.md2) ---
+// tri 0: xyz [0,1,2] st [0,1,2]; tri 1: xyz [0,2,3] st [4,2,3]
+
+TEST_CASE("md2 triangle list layout has no indices", "[md2]") {
+    auto md2 = load_quad(MD2Model::Layout::triangle_list);
+    REQUIRE(md2.model().layout() == MD2Model::Layout::triangle_list);
+    REQUIRE(md2.model().indices().empty());
+    REQUIRE(md2.interpolated_vertices().size() == 6);
+    REQUIRE(md2.model().scaled_texcoords().size() == 6);
+}
+
+TEST_CASE("md2 indexed layout welds shared vertices", "[md2]") {
+    auto md2 = load_quad(MD2Model::Layout::indexed);
+    REQUIRE(md2.model().layout() == MD2Model::Layout::indexed);
+    // xyz 2 and 0 are shared by both triangles but xyz 0 has a different
+    // texcoord in each, so only xyz 2 is welded
+    REQUIRE(md2.interpolated_vertices().size() == 5);
+    REQUIRE(md2.model().scaled_texcoords().size() == 5);
+    REQUIRE(md2.model().indices() == std::vector<uint16_t>{0, 1, 2, 3, 2, 4});
+}
+
+TEST_CASE("md2 indexed layout matches triangle list per corner", "[md2]") {
+    auto list = load_quad(MD2Model::Layout::triangle_list);
+    auto indexed = load_quad(MD2Model::Layout::indexed);
+
+    auto const& indices = indexed.model().indices();
+    REQUIRE(indices.size() == list.interpolated_vertices().size());
+    for (size_t i = 0; i < indices.size(); ++i) {
+        REQUIRE(indexed.interpolated_vertices()[indices[i]] ==
+                list.interpolated_vertices()[i]);
+        REQUIRE(indexed.model().scaled_texcoords()[indices[i]] ==
+                list.model().scaled_texcoords()[i]);
+    }
+}
+
+// --- gl command layout ---
+// quad.md2: one fan over xyz [0,1,2,3]; grid.md2: one strip per row
+
+// Triangles drawn by the batches of @p model, as (output vertex) triples in
+// the order and winding GL rasterizes them.
+static std::vector<std::array<size_t, 3>>
+batch_triangles(MD2Model const& model) {
+    std::vector<std::array<size_t, 3>> tris;
+    for (auto const& batch : model.batches()) {
+        for (size_t i = 0; i + 2 < batch.count; ++i) {
+            size_t const v = batch.first + i;
+            if (batch.primitive == MD2Model::Primitive::triangle_fan) {
+                tris.push_back({batch.first, v + 1, v + 2});
+            } else if (i % 2 == 0) {
+                tris.push_back({v, v + 1, v + 2});
+            } else {
+                tris.push_back({v + 1, v, v + 2});
+            }
+        }
+    }
+    return tris;
+}
+
+TEST_CASE("md2 gl command layout reads a fan", "[md2]") {
+    auto md2 = load_quad(MD2Model::Layout::gl_commands);
+    auto const& model = md2.model();
+    REQUIRE(model.layout() == MD2Model::Layout::gl_commands);
+    REQUIRE(model.indices().empty());
+    REQUIRE(model.batches() ==
+            std::vector<MD2Model::Batch>{
+                {0, 4, MD2Model::Primitive::triangle_fan}});
+    REQUIRE(md2.interpolated_vertices().size() == 4);
+    REQUIRE(model.scaled_texcoords() ==
+            std::vector<glm::vec2>{
+                {0.0f, 0.0f}, {0.5f, 0.0f}, {0.5f, 0.5f}, {0.0f, 0.5f}});
+    REQUIRE(md2.interpolated_vertices()[2] == glm::vec3(1.0f, 1.0f, 0.0f));
+}
+
+TEST_CASE("md2 gl command strips match the triangle list", "[md2]") {
+    auto const bytes = read_fixture_bytes("grid.md2");
+    std::span<std::byte const> const data{bytes};
+    MD2Model const list{data, MD2Model::Layout::triangle_list};
+    MD2Model const strips{data, MD2Model::Layout::gl_commands};
+
+    // 16 strips of 34 vertices draw the 512 triangles of 1536 corners
+    REQUIRE(strips.batches().size() == 16);
+    REQUIRE(strips.vertex_count() == 16 * 34);
+    auto const tris = batch_triangles(strips);
+    REQUIRE(tris.size() * 3 == list.vertex_count());
+
+    // same corners in the same winding, though a triangle may start from
+    // another corner and come in another order
+    auto const corner = [](MD2Model const& model, size_t frame, size_t v) {
+        auto const offset = frame * model.vertex_count();
+        return std::pair{model.key_frames()[offset + v],
+                         model.scaled_texcoords()[v]};
+    };
+    auto const same_triangle = [&](size_t frame, std::array<size_t, 3> tri,
+                                   size_t first) {
+        return std::ranges::any_of(std::array{0U, 1U, 2U}, [&](size_t r) {
+            return std::ranges::all_of(std::array{0U, 1U, 2U}, [&](size_t k) {
+                return corner(strips, frame, tri[(k + r) % 3]) ==
+                       corner(list, frame, first + k);
+            });
+        });
+    };
+    for (size_t frame = 0; frame < 4; ++frame) {
+        for (auto const& tri : tris) {
+            bool found = false;
+            for (size_t i = 0; i < list.vertex_count() && !found; i += 3) {
+                found = same_triangle(frame, tri, i);
+            }
+            REQUIRE(found);
+        }
+    }
+}
+
+TEST_CASE("md2 gl command layout falls back to a triangle list", "[md2]") {
+    // minimal.md2 has no gl commands
+    auto const bytes = read_fixture_bytes("minimal.md2");
+    MD2 md2{std::span<std::byte const>{bytes}, MD2Model::Layout::gl_commands};
+    REQUIRE(md2.model().layout() == MD2Model::Layout::triangle_list);
+    REQUIRE(md2.model().batches().empty());
+    REQUIRE(md2.interpolated_vertices().size() == 3);
+}
+
+TEST_CASE("md2 gl command with a bad vertex index throws", "[md2]") {
+    auto bytes = read_fixture_bytes("quad.md2");
+    MD2Model::Header hdr{};
+    std::memcpy(&hdr, bytes.data(), sizeof(hdr));
+    // the xyz index of the fan's last vertex
+    auto const offset =
+        static_cast<size_t>(hdr.offset_glcmds) + (12 * sizeof(int32_t));
+    int32_t const index = 4;
+    std::memcpy(bytes.data() + offset, &index, sizeof(index));
+    auto construct = [&]() {
+        MD2{std::span<std::byte const>{bytes}, MD2Model::Layout::gl_commands};
+    };
+    REQUIRE_THROWS_AS(construct(), std::runtime_error);
+}
+
+// --- keyframe storage (grid.md2) ---
+
+TEST_CASE("md2 compact storage matches unpacked while animating", "[md2]") {
+    using Catch::Approx;
+    auto const bytes = read_fixture_bytes("grid.md2");
+    std::span<std::byte const> const data{bytes};
+    MD2 unpacked{data, MD2Model::Layout::indexed, MD2Model::Storage::unpacked};
+    MD2 compact{data, MD2Model::Layout::indexed, MD2Model::Storage::compact};
+    REQUIRE(compact.model().storage() == MD2Model::Storage::compact);
+    REQUIRE(unpacked.model().storage() == MD2Model::Storage::unpacked);
+
+    // step through every frame pair including the wrap back to frame 0
+    for (int step = 0; step < 12; ++step) {
+        unpacked.update(0.05f);
+        compact.update(0.05f);
+
+        auto const& expected = unpacked.interpolated_vertices();
+        auto const& actual = compact.interpolated_vertices();
+        REQUIRE(actual.size() == expected.size());
+        for (size_t i = 0; i < actual.size(); ++i) {
+            REQUIRE(actual[i].x == Approx(expected[i].x).margin(1e-5f));
+            REQUIRE(actual[i].y == Approx(expected[i].y).margin(1e-5f));
+            REQUIRE(actual[i].z == Approx(expected[i].z).margin(1e-5f));
+        }
+    }
+}
+
+TEST_CASE("md2 compact storage uses less memory", "[md2]") {
+    auto const bytes = read_fixture_bytes("grid.md2");
+    std::span<std::byte const> const data{bytes};
+    MD2 unpacked{data, MD2Model::Layout::triangle_list,
+                 MD2Model::Storage::unpacked};
+    MD2 compact{data, MD2Model::Layout::triangle_list,
+                MD2Model::Storage::compact};
+
+    // 4 frames × 1536 corners × 12 bytes of floats vs 4 × 289 × 4 bytes
+    REQUIRE(unpacked.model().memory_usage() > 4 * 1536 * sizeof(glm::vec3));
+    REQUIRE(compact.model().memory_usage() <
+            unpacked.model().memory_usage() / 2);
+}
+
+TEST_CASE("md2 compact storage single frame model", "[md2]") {
+    auto const bytes = read_fixture_bytes("minimal.md2");
+    MD2 md2{std::span<std::byte const>{bytes}, MD2Model::Layout::triangle_list,
+            MD2Model::Storage::compact};
+    auto const& verts = md2.interpolated_vertices();
+    REQUIRE(verts.size() == 3);
+    REQUIRE(verts[1] == glm::vec3(1.0f, 0.0f, 0.0f));
+    REQUIRE(verts[2] == glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+// --- lerp kernels ---
+
+TEST_CASE("simd lerp kernels match scalar reference", "[md2][simd]") {
+    // 37 floats exercises the vector body and the scalar tail of each kernel
+    std::vector<float> a(37);
+    std::vector<float> b(37);
+    for (size_t i = 0; i < a.size(); ++i) {
+        a[i] = (static_cast<float>(i) * 0.37f) - 5.0f;
+        b[i] = 100.0f - (static_cast<float>(i) * 1.91f);
+    }
+
+    for (float const t : {0.0f, 0.25f, 0.5f, 0.8125f, 1.0f}) {
+        std::vector<float> expected(a.size());
+        SIMD::lerp(SIMD::Kernel::scalar, a, b, t, expected);
+
+        for (auto const kernel :
+             {SIMD::Kernel::sse, SIMD::Kernel::avx, SIMD::best_kernel()}) {
+            if (!SIMD::supported(kernel)) {
+                continue;
+            }
+            INFO("kernel " << SIMD::name(kernel) << " t " << t);
+            std::vector<float> actual(a.size());
+            SIMD::lerp(kernel, a, b, t, actual);
+            REQUIRE(actual == expected);
+        }
+    }
+}
+
+TEST_CASE("simd lerp endpoints are exact", "[md2][simd]") {
+    std::vector<float> const a{1.5f, -2.0f, 3.25f, 0.0f, 7.0f};
+    std::vector<float> const b{-4.0f, 8.5f, 0.125f, 9.0f, -1.0f};
+    std::vector<float> out(a.size());
+    SIMD::lerp(a, b, 0.0f, out);
+    REQUIRE(out == a);
+    SIMD::lerp(a, b, 1.0f, out);
+    REQUIRE(out == b);
+}
+
+TEST_CASE("simd lerp size mismatch throws", "[md2][simd]") {
+    std::vector<float> const a(4);
+    std::vector<float> const b(3);
+    std::vector<float> out(4);
+    REQUIRE_THROWS_AS(SIMD::lerp(a, b, 0.5f, out), gsl_lite::fail_fast);
+}
+
+TEST_CASE("md2 update matches glm lerp of frame endpoints", "[md2][simd]") {
+    using Catch::Approx;
+    auto const bytes = read_fixture_bytes("grid.md2");
+    std::span<std::byte const> const data{bytes};
+    MD2 md2{data};
+
+    // frame 0 and frame 1 positions, captured at t=0 before and after
+    // advancing a whole frame
+    auto const frame0 = md2.interpolated_vertices();
+    MD2 next{data};
+    next.update(1.0f / 8.0f);
+    auto const frame1 = next.interpolated_vertices();
+
+    md2.update(1.0f / 16.0f); // t = 0.5 between frame 0 and 1
+    auto const& actual = md2.interpolated_vertices();
+    REQUIRE(actual.size() == frame0.size());
+    for (size_t i = 0; i < actual.size(); ++i) {
+        auto const expected = glm::mix(frame0[i], frame1[i], 0.5f);
+        REQUIRE(actual[i].x == Approx(expected.x).margin(1e-5f));
+        REQUIRE(actual[i].y == Approx(expected.y).margin(1e-5f));
+        REQUIRE(actual[i].z == Approx(expected.z).margin(1e-5f));
+    }
+}
+
+// --- gpu morph state ---
+
+TEST_CASE("md2 key frames are stored frame after frame", "[md2]") {
+    auto md2 = load_two_frame();
+    auto const& model = md2.model();
+    auto const key_frames = model.key_frames();
+    REQUIRE(model.vertex_count() == 3);
+    REQUIRE(key_frames.size() == 2 * model.vertex_count());
+    // frame 1 vertex 2 is (10,10,0)
+    REQUIRE(key_frames[model.vertex_count() + 2] == glm::vec3(10, 10, 0));
+}
+
+TEST_CASE("md2 compact storage has no key frames", "[md2]") {
+    auto const bytes = read_fixture_bytes("two_frame.md2");
+    MD2 md2{std::span<std::byte const>{bytes}, MD2Model::Layout::triangle_list,
+            MD2Model::Storage::compact};
+    REQUIRE(md2.model().key_frames().empty());
+    REQUIRE(md2.model().vertex_count() == 3);
+}
+
+TEST_CASE("md2 advance updates frame blend only", "[md2]") {
+    using Catch::Approx;
+    auto md2 = load_two_frame();
+    auto const before = md2.interpolated_vertices();
+
+    md2.advance(1.0f / 16.0f);
+    auto const blend = md2.frame_blend();
+    REQUIRE(blend.current == 0);
+    REQUIRE(blend.next == 1);
+    REQUIRE(blend.t == Approx(0.5f));
+    REQUIRE(md2.interpolated_vertices() == before);
+
+    md2.advance(1.0f / 16.0f);
+    REQUIRE(md2.frame_blend().current == 1);
+    REQUIRE(md2.frame_blend().next == 0);
+    REQUIRE(md2.frame_blend().t == 0.0f);
+}
+
+TEST_CASE("md2 update matches blend of key frames", "[md2]") {
+    using Catch::Approx;
+    auto md2 = load_two_frame();
+    md2.update(1.0f / 32.0f);
+
+    auto const blend = md2.frame_blend();
+    auto const& model = md2.model();
+    auto const n = model.vertex_count();
+    auto const current = model.key_frames().subspan(blend.current * n, n);
+    auto const next = model.key_frames().subspan(blend.next * n, n);
+    for (size_t i = 0; i < n; ++i) {
+        auto const expected = glm::mix(current[i], next[i], blend.t);
+        REQUIRE(md2.interpolated_vertices()[i].x == Approx(expected.x));
+        REQUIRE(md2.interpolated_vertices()[i].y == Approx(expected.y));
+    }
+}
+
+// --- shared model, independent instances ---
+
+TEST_CASE("md2 instances share one model", "[md2]") {
+    auto const bytes = read_fixture_bytes("two_anim.md2");
+    auto const model =
+        std::make_shared<MD2Model const>(std::span<std::byte const>{bytes});
+    MD2Instance a{model};
+    MD2Instance b{model};
+    REQUIRE(&a.model() == &b.model());
+    REQUIRE(model.use_count() == 3);
+    REQUIRE(a.interpolated_vertices().size() == model->vertex_count());
+}
+
+TEST_CASE("md2 instances animate independently", "[md2]") {
+    auto const bytes = read_fixture_bytes("two_frame.md2");
+    auto const model =
+        std::make_shared<MD2Model const>(std::span<std::byte const>{bytes});
+    MD2Instance a{model};
+    MD2Instance b{model};
+
+    b.set_frames_per_second(4.0f);
+    a.update(1.0f / 16.0f); // t = 0.5 at 8 fps
+    b.update(1.0f / 16.0f); // t = 0.25 at 4 fps
+
+    REQUIRE(a.frame_blend().t == Catch::Approx(0.5f));
+    REQUIRE(b.frame_blend().t == Catch::Approx(0.25f));
+    REQUIRE(a.interpolated_vertices()[0].x == Catch::Approx(5.0f));
+    REQUIRE(b.interpolated_vertices()[0].x == Catch::Approx(2.5f));
+}
+
+TEST_CASE("md2 instance animation selection is per instance", "[md2]") {
+    auto const bytes = read_fixture_bytes("two_anim.md2");
+    auto const model =
+        std::make_shared<MD2Model const>(std::span<std::byte const>{bytes});
+    MD2Instance a{model};
+    MD2Instance b{a};
+
+    b.set_animation("run");
+    REQUIRE(a.animation_index() == 0);
+    REQUIRE(b.animation_index() == 1);
+    REQUIRE(model->find_animation("run") == 1);
+    REQUIRE_FALSE(model->find_animation("jump").has_value());
+}
+
+TEST_CASE("md2 instance update can blend into a caller buffer", "[md2]") {
+    auto const bytes = read_fixture_bytes("two_frame.md2");
+    auto const model =
+        std::make_shared<MD2Model const>(std::span<std::byte const>{bytes});
+    MD2Instance a{model};
+    MD2Instance b{model};
+
+    std::vector<glm::vec3> out(model->vertex_count());
+    a.update(1.0f / 16.0f);
+    b.update(1.0f / 16.0f, out);
+
+    REQUIRE(out == a.interpolated_vertices());
+    REQUIRE(b.frame_blend().t == Catch::Approx(0.5f));
+    // the instance's own buffer still holds the initial frame
+    REQUIRE(b.interpolated_vertices()[0].x == Catch::Approx(0.0f));
+
+    std::vector<glm::vec3> wrong(model->vertex_count() + 1);
+    REQUIRE_THROWS_AS(b.update(0.0f, wrong), gsl_lite::fail_fast);
+}
+
+TEST_CASE("md2 instance fixed steps blend once per frame", "[md2]") {
+    auto const bytes = read_fixture_bytes("two_frame.md2");
+    auto const model =
+        std::make_shared<MD2Model const>(std::span<std::byte const>{bytes});
+    MD2Instance stepped{model};
+    MD2Instance expected{model};
+
+    // stands in for GL::Mesh::next_vertices(), which fences and advances
+    // the persistent ring on every call
+    struct Ring {
+        std::array<std::vector<glm::vec3>, 3> regions;
+        size_t advances{};
+        std::span<glm::vec3> next() {
+            return regions[advances++ % regions.size()];
+        }
+    } ring;
+    for (auto& region : ring.regions) {
+        region.resize(model->vertex_count());
+    }
+
+    // a 30 Hz frame owes two 60 Hz steps
+    FramePacer pacer{{.update_hz = 60.0}};
+    (void)pacer.begin_frame(0.0);
+    auto const frame = pacer.begin_frame(1.0 / 30.0);
+    REQUIRE(frame.steps == 2);
+
+    int steps = 0;
+    int blends = 0;
+    FramePacer::run(
+        frame,
+        [&](double step_dt) {
+            ++steps;
+            stepped.advance(static_cast<float>(step_dt));
+        },
+        [&] {
+            ++blends;
+            stepped.blend(ring.next());
+        });
+    REQUIRE(steps == 2);
+    REQUIRE(blends == 1);
+    REQUIRE(ring.advances == 1);
+
+    expected.update(1.0f / 60.0f);
+    expected.update(1.0f / 60.0f);
+    REQUIRE(stepped.frame_blend().t ==
+            Catch::Approx(expected.frame_blend().t));
+    REQUIRE(ring.regions[0] == expected.interpolated_vertices());
+}
+
+TEST_CASE("md2 instance reports whether it is animating", "[md2]") {
+    auto const bytes = read_fixture_bytes("two_frame.md2");
+    auto const model =
+        std::make_shared<MD2Model const>(std::span<std::byte const>{bytes});
+    MD2Instance a{model};
+    REQUIRE(a.animating());
+
+    a.set_frames_per_second(0.0f);
+    REQUIRE_FALSE(a.animating());
+
+    // minimal.md2 is a single frame, so there is nothing to animate
+    auto const single_bytes = read_fixture_bytes("minimal.md2");
+    MD2Instance single{std::make_shared<MD2Model const>(
+        std::span<std::byte const>{single_bytes})};
+    REQUIRE_FALSE(single.animating());
+}
+
+TEST_CASE("md2 instance requires a model", "[md2]") {
+    auto construct = []() { MD2Instance{nullptr}; };
+    REQUIRE_THROWS_AS(construct(), gsl_lite::fail_fast);
+}
+
+TEST_CASE("md2 update_all matches updating each instance", "[md2][pool]") {
+    auto const bytes = read_fixture_bytes("bench.md2");
+    auto const model =
+        std::make_shared<MD2Model const>(std::span<std::byte const>{bytes});
+
+    std::vector<MD2Instance> expected;
+    for (int i = 0; i < 37; ++i) {
+        auto& instance = expected.emplace_back(model);
+        instance.set_frames_per_second(static_cast<float>(1 + (i % 30)));
+    }
+    auto serial = expected;
+    auto parallel = expected;
+
+    ThreadPool pool(3);
+    for (int step = 0; step < 20; ++step) {
+        for (auto& instance : expected) {
+            instance.update(0.05f);
+        }
+        update_all(serial, 0.05f);
+        update_all(parallel, 0.05f, pool);
+    }
+
+    for (size_t i = 0; i < expected.size(); ++i) {
+        REQUIRE(serial[i].frame_blend().current ==
+                expected[i].frame_blend().current);
+        REQUIRE(parallel[i].frame_blend().current ==
+                expected[i].frame_blend().current);
+        REQUIRE(serial[i].interpolated_vertices() ==
+                expected[i].interpolated_vertices());
+        REQUIRE(parallel[i].interpolated_vertices() ==
+                expected[i].interpolated_vertices());
+    }
+}
@@ -0,0 +1,257 @@
+#include "fixtures.hpp"
+#include "md2view/mapped_file.hpp"
+#include "md2view/md2_model.hpp"
+#include "md2view/model_cache.hpp"
+#include "md2view/vfs.hpp"
+#include "tmpdir.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static std::string bake(MD2Model const& model, uint64_t source_key = 0) {
+    std::ostringstream os;
+    model.write_baked(os, source_key);
+    return os.str();
+}
+
+static std::span<std::byte const> as_bytes(std::string const& str) {
+    return std::as_bytes(std::span{str});
+}
+
+// Every frame blended from the model, so models can be compared whatever
+// their keyframe storage.
+static std::vector<glm::vec3> all_frames(MD2Model const& model) {
+    auto const count = model.vertex_count();
+    auto const frames = model.header().num_frames;
+    std::vector<glm::vec3> out(count * static_cast<size_t>(frames));
+    for (int i = 0; i < frames; ++i) {
+        model.blend({i, i, 0.0f},
+                    std::span{out}.subspan(static_cast<size_t>(i) * count,
+                                           count));
+    }
+    return out;
+}
+
+static void require_same(MD2Model const& baked, MD2Model const& parsed) {
+    REQUIRE(baked.layout() == parsed.layout());
+    REQUIRE(baked.storage() == parsed.storage());
+    REQUIRE(baked.header().num_frames == parsed.header().num_frames);
+    REQUIRE(baked.vertex_count() == parsed.vertex_count());
+    REQUIRE(baked.indices() == parsed.indices());
+    REQUIRE(baked.batches() == parsed.batches());
+    REQUIRE(baked.scaled_texcoords() == parsed.scaled_texcoords());
+    REQUIRE(all_frames(baked) == all_frames(parsed));
+    REQUIRE(baked.skins().size() == parsed.skins().size());
+    REQUIRE(baked.animations().size() == parsed.animations().size());
+    for (size_t i = 0; i < baked.animations().size(); ++i) {
+        auto const& a = baked.animations()[i];
+        auto const& b = parsed.animations()[i];
+        REQUIRE(a.name == b.name);
+        REQUIRE(a.start_frame == b.start_frame);
+        REQUIRE(a.end_frame == b.end_frame);
+        REQUIRE(baked.find_animation(a.name) == i);
+    }
+}
+
+// Game directory holding @p fixture_name as models/player/tris.md2.
+static void install_fixture(std::filesystem::path const& root,
+                            char const* fixture_name) {
+    auto const model_dir = root / "models" / "player";
+    std::filesystem::create_directories(model_dir);
+    std::filesystem::copy_file(
+        test_fixtures_dir() / fixture_name, model_dir / "tris.md2",
+        std::filesystem::copy_options::overwrite_existing);
+}
+
+TEST_CASE("md2 baked round trip matches parsed model", "[md2][baked]") {
+    auto const bytes = read_fixture_bytes("grid.md2");
+    std::span<std::byte const> const data{bytes};
+    for (auto const layout :
+         {MD2Model::Layout::triangle_list, MD2Model::Layout::indexed,
+          MD2Model::Layout::gl_commands}) {
+        for (auto const storage :
+             {MD2Model::Storage::unpacked, MD2Model::Storage::compact}) {
+            MD2Model const parsed{data, layout, storage};
+            auto const image = bake(parsed);
+            MD2Model const baked{MD2Model::Baked{}, as_bytes(image)};
+            require_same(baked, parsed);
+        }
+    }
+}
+
+TEST_CASE("md2 baked header records source key", "[md2][baked]") {
+    auto const bytes = read_fixture_bytes("two_anim.md2");
+    MD2Model const parsed{std::span<std::byte const>{bytes}};
+    auto const image = bake(parsed, 0x1234);
+
+    MD2Model::BakedHeader header{};
+    REQUIRE(image.size() > sizeof(header));
+    std::memcpy(&header, image.data(), sizeof(header));
+    REQUIRE(header.magic == MD2Model::baked_magic);
+    REQUIRE(header.version == MD2Model::baked_version);
+    REQUIRE(header.source_key == 0x1234);
+    REQUIRE(header.animation_count == 2);
+    REQUIRE(image.size() % 4 == 0);
+}
+
+TEST_CASE("md2 baked truncated image throws", "[md2][baked]") {
+    auto const bytes = read_fixture_bytes("grid.md2");
+    auto const image = bake(MD2Model{std::span<std::byte const>{bytes}});
+    for (auto const size : {size_t{0}, sizeof(MD2Model::BakedHeader),
+                            image.size() / 2, image.size() - 1}) {
+        auto construct = [&]() {
+            MD2Model{MD2Model::Baked{}, as_bytes(image).first(size)};
+        };
+        REQUIRE_THROWS_AS(construct(), std::runtime_error);
+    }
+}
+
+TEST_CASE("md2 baked image of another version throws", "[md2][baked]") {
+    auto const bytes = read_fixture_bytes("minimal.md2");
+    auto image = bake(MD2Model{std::span<std::byte const>{bytes}});
+    auto const version = MD2Model::baked_version + 1;
+    std::memcpy(image.data() + offsetof(MD2Model::BakedHeader, version),
+                &version, sizeof(version));
+    auto construct = [&]() { MD2Model{MD2Model::Baked{}, as_bytes(image)}; };
+    REQUIRE_THROWS_AS(construct(), std::runtime_error);
+}
+
+TEST_CASE("model cache writes then reads baked model", "[md2][baked]") {
+    TmpDir const tmp;
+    install_fixture(tmp.path() / "pak", "grid.md2");
+    VFS const vfs{{tmp.path() / "pak"}};
+    ModelCache const cache{tmp.path() / "cache"};
+    auto const entry = std::string{"models/player/tris.md2"};
+    auto const path = cache.path(vfs, entry, MD2Model::Layout::indexed,
+                                 MD2Model::Storage::unpacked);
+    REQUIRE(path.parent_path() == cache.dir());
+    REQUIRE(path.extension() == ModelCache::extension);
+    REQUIRE_FALSE(std::filesystem::exists(path));
+
+    auto const first = cache.load(vfs, entry, MD2Model::Layout::indexed,
+                                  MD2Model::Storage::unpacked);
+    REQUIRE(std::filesystem::exists(path));
+    auto const second = cache.load(vfs, entry, MD2Model::Layout::indexed,
+                                   MD2Model::Storage::unpacked);
+    require_same(*second, *first);
+    // directory mode skins are resolved once and kept in the baked file
+    REQUIRE(second->skins().size() == first->skins().size());
+
+    REQUIRE_FALSE(cache.bake(vfs, entry, MD2Model::Layout::indexed,
+                             MD2Model::Storage::unpacked));
+    // each layout and storage gets its own file
+    REQUIRE(cache.bake(vfs, entry, MD2Model::Layout::indexed,
+                       MD2Model::Storage::compact));
+}
+
+TEST_CASE("model cache rebuilds stale baked model", "[md2][baked]") {
+    TmpDir const tmp;
+    auto const entry = std::string{"models/player/tris.md2"};
+    ModelCache const cache{tmp.path() / "cache"};
+    auto const layout = MD2Model::Layout::indexed;
+    auto const storage = MD2Model::Storage::unpacked;
+
+    install_fixture(tmp.path() / "pak", "grid.md2");
+    {
+        VFS const vfs{{tmp.path() / "pak"}};
+        REQUIRE(cache.bake(vfs, entry, layout, storage));
+    }
+
+    install_fixture(tmp.path() / "pak", "two_anim.md2");
+    VFS const vfs{{tmp.path() / "pak"}};
+    auto const path = cache.path(vfs, entry, layout, storage);
+    auto const model = cache.load(vfs, entry, layout, storage);
+    REQUIRE(model->animations().size() == 2);
+
+    MappedFile const file{path};
+    MD2Model::BakedHeader header{};
+    std::memcpy(&header, file.bytes().data(), sizeof(header));
+    REQUIRE(header.source_key == ModelCache::source_key(vfs, entry));
+}
+
+TEST_CASE("model cache key follows loose file metadata", "[md2][baked]") {
+    TmpDir const tmp;
+    auto const root = tmp.path() / "pak";
+    auto const entry = std::string{"models/player/tris.md2"};
+    ModelCache const cache{tmp.path() / "cache"};
+    auto const layout = MD2Model::Layout::indexed;
+    auto const storage = MD2Model::Storage::unpacked;
+
+    install_fixture(root, "grid.md2");
+    VFS const vfs{{root}};
+    auto const key = ModelCache::source_key(vfs, entry);
+    REQUIRE(ModelCache::source_key(vfs, entry) == key);
+    REQUIRE(cache.bake(vfs, entry, layout, storage));
+    REQUIRE_FALSE(cache.bake(vfs, entry, layout, storage));
+
+    // rewriting the file in place moves its modification time
+    auto const file = root / entry;
+    std::filesystem::last_write_time(
+        file, std::filesystem::last_write_time(file) + std::chrono::seconds{1});
+    REQUIRE(ModelCache::source_key(vfs, entry) != key);
+    REQUIRE(cache.bake(vfs, entry, layout, storage));
+}
+
+TEST_CASE("model cache rebuilds when loose skins change", "[md2][baked]") {
+    TmpDir const tmp;
+    auto const root = tmp.path() / "pak";
+    auto const entry = std::string{"models/player/tris.md2"};
+    ModelCache const cache{tmp.path() / "cache"};
+    auto const layout = MD2Model::Layout::indexed;
+    auto const storage = MD2Model::Storage::unpacked;
+
+    // grid.md2 names no skins, so any .png next to it is used
+    install_fixture(root, "grid.md2");
+    {
+        VFS const vfs{{root}};
+        REQUIRE(cache.load(vfs, entry, layout, storage)->skins().empty());
+    }
+
+    std::ofstream(root / "models" / "player" / "skin.png") << "png";
+    {
+        VFS const vfs{{root}};
+        REQUIRE(cache.bake(vfs, entry, layout, storage));
+        auto const model = cache.load(vfs, entry, layout, storage);
+        REQUIRE(model->skins().size() == 1);
+        REQUIRE(model->skins()[0].fpath == "models/player/skin.png");
+    }
+
+    std::filesystem::rename(root / "models" / "player" / "skin.png",
+                            root / "models" / "player" / "other.png");
+    VFS const vfs{{root}};
+    auto const model = cache.load(vfs, entry, layout, storage);
+    REQUIRE(model->skins().size() == 1);
+    REQUIRE(model->skins()[0].fpath == "models/player/other.png");
+}
+
+TEST_CASE("model cache ignores corrupt baked model", "[md2][baked]") {
+    TmpDir const tmp;
+    install_fixture(tmp.path() / "pak", "grid.md2");
+    VFS const vfs{{tmp.path() / "pak"}};
+    ModelCache const cache{tmp.path() / "cache"};
+    auto const entry = std::string{"models/player/tris.md2"};
+    auto const layout = MD2Model::Layout::indexed;
+    auto const storage = MD2Model::Storage::unpacked;
+    REQUIRE(cache.bake(vfs, entry, layout, storage));
+
+    // keep the header so it still looks current, but cut off the rest
+    auto const path = cache.path(vfs, entry, layout, storage);
+    std::filesystem::resize_file(path, sizeof(MD2Model::BakedHeader) + 8);
+
+    auto const model = cache.load(vfs, entry, layout, storage);
+    MD2Model const parsed{entry, vfs, layout, storage};
+    require_same(*model, parsed);
+    // and the broken file has been replaced
+    REQUIRE(std::filesystem::file_size(path) >
+            sizeof(MD2Model::BakedHeader) + 8);
+}
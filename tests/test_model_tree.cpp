@@ -0,0 +1,110 @@
+#include "md2view/model_tree.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+static std::vector<std::string> row_names(ModelTree& tree) {
+    std::vector<std::string> out;
+    for (auto const index : tree.rows()) {
+        out.push_back(tree.node(index).name);
+    }
+    return out;
+}
+
+static ModelTree make_tree() {
+    ModelTree tree{"baseq2"};
+    for (auto const* path :
+         {"models/monster/tris.md2", "models/player/tris.md2",
+          "models/player/weapon/tris.md2", "players/male/tris.md2"}) {
+        tree.add(path);
+    }
+    return tree;
+}
+
+TEST_CASE("model tree shares directories between paths", "[model_tree]") {
+    auto tree = make_tree();
+
+    // root, models, monster, tris, player, tris, weapon, tris, players,
+    // male, tris
+    REQUIRE(tree.size() == 11);
+    REQUIRE(tree.leaves().size() == 4);
+
+    auto const player = tree.find("models/player");
+    REQUIRE(player != ModelTree::npos);
+    REQUIRE(tree.node(player).name == "player");
+    REQUIRE(tree.node(player).depth == 2);
+    REQUIRE(tree.node(player).children.size() == 2);
+    REQUIRE_FALSE(tree.is_leaf(player));
+
+    auto const model = tree.find("models/player/weapon/tris.md2");
+    REQUIRE(model != ModelTree::npos);
+    REQUIRE(tree.is_leaf(model));
+    REQUIRE(tree.node(model).path == "models/player/weapon/tris.md2");
+    REQUIRE(tree.node(tree.node(model).parent).path == "models/player/weapon");
+
+    REQUIRE(tree.add("models/player/tris.md2") ==
+            tree.find("models/player/tris.md2"));
+    REQUIRE(tree.leaves().size() == 4);
+    REQUIRE(tree.find("models/nobody") == ModelTree::npos);
+}
+
+TEST_CASE("model tree rows follow expansion", "[model_tree]") {
+    auto tree = make_tree();
+    REQUIRE(row_names(tree) ==
+            std::vector<std::string>{"baseq2", "models", "players"});
+
+    tree.set_expanded(tree.find("models"), true);
+    REQUIRE(row_names(tree) == std::vector<std::string>{"baseq2", "models",
+                                                        "monster", "player",
+                                                        "players"});
+
+    tree.set_expanded(tree.find("models/player"), true);
+    REQUIRE(row_names(tree) ==
+            std::vector<std::string>{"baseq2", "models", "monster", "player",
+                                     "tris.md2", "weapon", "players"});
+
+    // collapsing hides the subtree but remembers what was open inside it
+    tree.set_expanded(tree.find("models"), false);
+    REQUIRE(row_names(tree) ==
+            std::vector<std::string>{"baseq2", "models", "players"});
+    tree.set_expanded(tree.find("models"), true);
+    REQUIRE(tree.rows().size() == 7);
+}
+
+TEST_CASE("model tree filter lists matching models", "[model_tree]") {
+    auto tree = make_tree();
+
+    tree.set_filter("PLAYER");
+    REQUIRE(tree.filter() == "player");
+    std::vector<std::string> paths;
+    for (auto const index : tree.rows()) {
+        paths.push_back(tree.node(index).path);
+    }
+    REQUIRE(paths == std::vector<std::string>{"models/player/tris.md2",
+                                              "models/player/weapon/tris.md2",
+                                              "players/male/tris.md2"});
+
+    tree.set_filter("weapon/");
+    REQUIRE(tree.rows().size() == 1);
+    tree.set_filter("nothing");
+    REQUIRE(tree.rows().empty());
+
+    tree.set_filter("");
+    REQUIRE(row_names(tree) ==
+            std::vector<std::string>{"baseq2", "models", "players"});
+}
+
+TEST_CASE("model tree reveal expands ancestors", "[model_tree]") {
+    auto tree = make_tree();
+    auto const model = tree.find("players/male/tris.md2");
+    tree.reveal(model);
+
+    auto const rows = tree.rows();
+    REQUIRE(std::ranges::find(rows, model) != rows.end());
+    REQUIRE(row_names(tree) == std::vector<std::string>{
+                                   "baseq2", "models", "players", "male",
+                                   "tris.md2"});
+}
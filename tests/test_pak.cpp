@@ -3,10 +3,17 @@
 #include "tmpdir.hpp"
 
 #include <catch2/catch_test_macros.hpp>
+#include <gsl-lite/gsl-lite.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
 #include <fstream>
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <vector>
 
 TEST_CASE("pak non-existent", "[pak]") {
     auto construct = [&]() { PAK pak{"nosuchfile.pak"}; };
@@ -59,3 +66,261 @@ TEST_CASE("pak open_ifstream returns correct content", "[pak]") {
     inf.read(content.data(), 5);
     REQUIRE(content == "HELLO");
 }
+
+TEST_CASE("pak view returns entry bytes", "[pak]") {
+    auto path = test_fixtures_dir() / "minimal.pak";
+    PAK pak{path};
+
+    auto const bytes = pak.view("models/player/tris.md2");
+    REQUIRE(bytes.size() == 5);
+    REQUIRE(std::string(reinterpret_cast<char const*>(bytes.data()),
+                        bytes.size()) == "HELLO");
+}
+
+TEST_CASE("pak view missing entry throws", "[pak]") {
+    auto path = test_fixtures_dir() / "minimal.pak";
+    PAK pak{path};
+
+    REQUIRE_FALSE(pak.contains("models/nope/tris.md2"));
+    REQUIRE_THROWS_AS(pak.view("models/nope/tris.md2"), gsl_lite::fail_fast);
+}
+
+TEST_CASE("pak open_ifstream is bounded to the entry", "[pak]") {
+    auto path = test_fixtures_dir() / "minimal.pak";
+    PAK pak{path};
+
+    auto inf = pak.open_ifstream("models/player/tris.md2");
+    std::string content(64, '\0');
+    inf.read(content.data(), 64);
+    REQUIRE(inf.gcount() == 5);
+    REQUIRE(inf.eof());
+}
+
+TEST_CASE("pak open_ifstream seeks within the entry", "[pak]") {
+    auto path = test_fixtures_dir() / "minimal.pak";
+    PAK pak{path};
+
+    auto inf = pak.open_ifstream("models/player/tris.md2");
+    inf.seekg(2);
+    REQUIRE(inf.tellg() == 2);
+    std::string content(3, '\0');
+    inf.read(content.data(), 3);
+    REQUIRE(content == "LLO");
+}
+
+TEST_CASE("pak open_ifstream missing entry is not open", "[pak]") {
+    TmpDir tmp_dir;
+    PAK pak{tmp_dir.path()};
+
+    auto inf = pak.open_ifstream("missing.pcx");
+    REQUIRE_FALSE(inf.is_open());
+    REQUIRE_FALSE(inf);
+}
+
+TEST_CASE("pak view from directory", "[pak]") {
+    TmpDir tmp_dir;
+    {
+        std::ofstream f(tmp_dir.path() / "skin.pcx", std::ios::binary);
+        f << "PIXELS";
+    }
+    PAK pak{tmp_dir.path()};
+
+    std::weak_ptr<MappedFile const> mapping;
+    {
+        auto const bytes = pak.view("skin.pcx");
+        REQUIRE(bytes.size() == 6);
+        // overlapping views share the same mapping
+        REQUIRE(pak.view("skin.pcx").data() == bytes.data());
+        mapping = bytes.file();
+    }
+    // the PAK does not keep a file mapped once its views are gone
+    REQUIRE(mapping.expired());
+
+    // a stream keeps its own view
+    auto stream = pak.open_ifstream("skin.pcx");
+    std::string contents;
+    stream >> contents;
+    REQUIRE(contents == "PIXELS");
+}
+
+// Directory-mode PAK with a few models, skins and nested directories.
+static void write_tree(std::filesystem::path const& root) {
+    for (auto const* path :
+         {"models/player/tris.md2", "models/player/skin.pcx",
+          "models/player/weapon/tris.md2", "models/playerx/tris.md2",
+          "models/monster/tris.md2", "pics/colormap.pcx", "readme.txt"}) {
+        auto const full = root / path;
+        std::filesystem::create_directories(full.parent_path());
+        std::ofstream f(full, std::ios::binary);
+        f << path;
+    }
+}
+
+static std::vector<std::string> paths(auto&& nodes) {
+    std::vector<std::string> out;
+    for (auto const& node : nodes) {
+        out.emplace_back(node.path);
+    }
+    return out;
+}
+
+TEST_CASE("pak entries are sorted by path", "[pak]") {
+    TmpDir tmp_dir;
+    write_tree(tmp_dir.path());
+    PAK pak{tmp_dir.path()};
+
+    REQUIRE(pak.size() == 7);
+    auto const all = paths(pak.entries());
+    REQUIRE(std::ranges::is_sorted(all));
+    REQUIRE(all.front() == "models/monster/tris.md2");
+    REQUIRE(all.back() == "readme.txt");
+}
+
+TEST_CASE("pak find by path", "[pak]") {
+    TmpDir tmp_dir;
+    write_tree(tmp_dir.path());
+    PAK pak{tmp_dir.path()};
+
+    auto const node = pak.find("models/player/skin.pcx");
+    REQUIRE(node.has_value());
+    REQUIRE(node->name == "skin");
+    REQUIRE(node->path == "models/player/skin.pcx");
+    REQUIRE(node->filelen == std::string_view{"models/player/skin.pcx"}.size());
+    REQUIRE_FALSE(pak.find("models/player").has_value());
+    REQUIRE_FALSE(pak.find("models/player/skin.pc").has_value());
+}
+
+TEST_CASE("pak find in pak file", "[pak]") {
+    PAK pak{test_fixtures_dir() / "minimal.pak"};
+
+    auto const node = pak.find("models/player/tris.md2");
+    REQUIRE(node.has_value());
+    REQUIRE(node->name == "tris");
+    REQUIRE(node->filelen == 5);
+}
+
+TEST_CASE("pak prefix query", "[pak]") {
+    TmpDir tmp_dir;
+    write_tree(tmp_dir.path());
+    PAK pak{tmp_dir.path()};
+
+    REQUIRE(paths(pak.prefix("models/player")) ==
+            std::vector<std::string>{"models/player/skin.pcx",
+                                     "models/player/tris.md2",
+                                     "models/player/weapon/tris.md2",
+                                     "models/playerx/tris.md2"});
+    REQUIRE(paths(pak.prefix("pics/")) ==
+            std::vector<std::string>{"pics/colormap.pcx"});
+    REQUIRE(pak.prefix("sound/").empty());
+    REQUIRE(paths(pak.prefix("")).size() == pak.size());
+}
+
+TEST_CASE("pak directory query excludes subdirectories", "[pak]") {
+    TmpDir tmp_dir;
+    write_tree(tmp_dir.path());
+    PAK pak{tmp_dir.path()};
+
+    auto const expected = std::vector<std::string>{"models/player/skin.pcx",
+                                                   "models/player/tris.md2"};
+    REQUIRE(paths(pak.directory("models/player")) == expected);
+    REQUIRE(paths(pak.directory("models/player/")) == expected);
+    REQUIRE(paths(pak.directory("")) == std::vector<std::string>{"readme.txt"});
+    REQUIRE(pak.directory("models").empty());
+}
+
+TEST_CASE("pak entries by extension", "[pak]") {
+    TmpDir tmp_dir;
+    write_tree(tmp_dir.path());
+    PAK pak{tmp_dir.path()};
+
+    REQUIRE(paths(pak.models()) ==
+            std::vector<std::string>{"models/monster/tris.md2",
+                                     "models/player/tris.md2",
+                                     "models/player/weapon/tris.md2",
+                                     "models/playerx/tris.md2"});
+    REQUIRE(paths(pak.with_extension(".pcx")) ==
+            std::vector<std::string>{"models/player/skin.pcx",
+                                     "pics/colormap.pcx"});
+    REQUIRE(pak.with_extension(".wav").empty());
+    REQUIRE(pak.has_models());
+}
+
+TEST_CASE("pak directory walk does not follow directory links", "[pak]") {
+    TmpDir tmp_dir;
+    write_tree(tmp_dir.path());
+    // a link back up the tree would otherwise be walked forever
+    std::filesystem::create_directory_symlink(
+        "..", tmp_dir.path() / "models" / "player" / "self");
+
+    PAK const pak{tmp_dir.path()};
+    REQUIRE(pak.size() == 7);
+    REQUIRE_FALSE(pak.find("models/player/self/player/tris.md2").has_value());
+}
+
+// The one index file in @p dir.
+static std::filesystem::path index_file(std::filesystem::path const& dir) {
+    std::vector<std::filesystem::path> files;
+    for (auto const& entry : std::filesystem::directory_iterator(dir)) {
+        files.push_back(entry.path());
+    }
+    REQUIRE(files.size() == 1);
+    REQUIRE(files.front().extension() == PAK::index_extension);
+    return files.front();
+}
+
+TEST_CASE("pak directory index is saved and reused", "[pak]") {
+    TmpDir tmp_dir;
+    auto const root = tmp_dir.path() / "baseq2";
+    auto const cache = tmp_dir.path() / "cache";
+    write_tree(root);
+
+    PAK const walked{root, cache};
+    REQUIRE_FALSE(walked.index_cached());
+    REQUIRE(std::filesystem::exists(index_file(cache)));
+
+    PAK const cached{root, cache};
+    REQUIRE(cached.index_cached());
+    REQUIRE(paths(cached.entries()) == paths(walked.entries()));
+    REQUIRE(paths(cached.models()) == paths(walked.models()));
+    REQUIRE(cached.find("models/player/skin.pcx")->name == "skin");
+    REQUIRE(cached.find("models/player/skin.pcx")->filelen ==
+            walked.find("models/player/skin.pcx")->filelen);
+    REQUIRE(paths(cached.directory("models/player")) ==
+            paths(walked.directory("models/player")));
+}
+
+TEST_CASE("pak directory index is rebuilt when a directory changes", "[pak]") {
+    TmpDir tmp_dir;
+    auto const root = tmp_dir.path() / "baseq2";
+    auto const cache = tmp_dir.path() / "cache";
+    write_tree(root);
+    REQUIRE_FALSE(PAK{root, cache}.index_cached());
+
+    auto const dir = root / "models" / "player" / "weapon";
+    std::ofstream(dir / "skin.pcx") << "skin";
+    // the file system clock can be coarser than the time between writes
+    std::filesystem::last_write_time(
+        dir, std::filesystem::last_write_time(dir) + std::chrono::seconds{1});
+
+    PAK const pak{root, cache};
+    REQUIRE_FALSE(pak.index_cached());
+    REQUIRE(pak.size() == 8);
+    REQUIRE(pak.find("models/player/weapon/skin.pcx").has_value());
+    REQUIRE(PAK{root, cache}.index_cached());
+}
+
+TEST_CASE("pak corrupt directory index is ignored", "[pak]") {
+    TmpDir tmp_dir;
+    auto const root = tmp_dir.path() / "baseq2";
+    auto const cache = tmp_dir.path() / "cache";
+    write_tree(root);
+    REQUIRE_FALSE(PAK{root, cache}.index_cached());
+
+    auto const file = index_file(cache);
+    std::filesystem::resize_file(file, std::filesystem::file_size(file) / 2);
+
+    PAK const pak{root, cache};
+    REQUIRE_FALSE(pak.index_cached());
+    REQUIRE(pak.size() == 7);
+    REQUIRE(PAK{root, cache}.index_cached());
+}
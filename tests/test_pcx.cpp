@@ -4,8 +4,40 @@
 #include <catch2/catch_test_macros.hpp>
 #include <gsl-lite/gsl-lite.hpp>
 
+#include <cstddef>
+#include <cstdint>
 #include <fstream>
+#include <initializer_list>
+#include <iterator>
+#include <span>
 #include <sstream>
+#include <string>
+#include <vector>
+
+// A PCX file image: 128 byte header for a @p width x @p height 8-bit image
+// with @p bytes_per_line, then @p body (scan lines, palette marker and
+// palette) verbatim.
+static std::vector<std::byte> make_pcx(int width,
+                                       int height,
+                                       int bytes_per_line,
+                                       std::initializer_list<int> body) {
+    std::vector<std::byte> data(128);
+    auto put16 = [&](size_t offset, int v) {
+        data[offset] = static_cast<std::byte>(v & 0xFF);
+        data[offset + 1] = static_cast<std::byte>((v >> 8) & 0xFF);
+    };
+    data[0] = std::byte{0x0A};
+    data[2] = std::byte{1};
+    data[3] = std::byte{8};
+    put16(8, width - 1);
+    put16(10, height - 1);
+    data[65] = std::byte{1};
+    put16(66, bytes_per_line);
+    for (int b : body) {
+        data.push_back(static_cast<std::byte>(b));
+    }
+    return data;
+}
 
 TEST_CASE("pcx default ctor", "[pcx]") {
     PCX pcx;
@@ -80,3 +112,85 @@ TEST_CASE("pcx valid 2x2 pixels", "[pcx]") {
     REQUIRE(img[10] == 0);
     REQUIRE(img[11] == 0);
 }
+
+TEST_CASE("pcx span matches stream decode", "[pcx]") {
+    auto path = test_fixtures_dir() / "minimal.pcx";
+    std::ifstream f(path, std::ios::binary);
+    REQUIRE(f.is_open());
+    std::vector<char> const bytes{std::istreambuf_iterator<char>(f), {}};
+
+    std::stringstream ss{std::string(bytes.begin(), bytes.end())};
+    PCX const streamed{ss};
+    PCX const spanned{std::as_bytes(std::span{bytes})};
+
+    REQUIRE(spanned.width() == 2);
+    REQUIRE(spanned.height() == 2);
+    REQUIRE(spanned.image() == streamed.image());
+    REQUIRE(spanned.indices() == std::vector<uint8_t>{0, 1, 1, 0});
+    REQUIRE(spanned.colors().size() == 256);
+}
+
+TEST_CASE("pcx runs, escaped literals and scan line padding", "[pcx]") {
+    // 3x2 image with 4 bytes per line (one padding byte per line)
+    //   row 0: run of 3 x index 1, then padding 9
+    //   row 1: literal 2, escaped literal 0xC5, literal 3, padding 9
+    auto const data = make_pcx(3, 2, 4,
+                               {0xC3, 1, 9,                   // row 0
+                                2, 0xC1, 0xC5, 3, 9,          // row 1
+                                0x0C, 10, 11, 12, 20, 21, 22, // palette
+                                30, 31, 32, 40, 41, 42});
+    PCX const pcx{data};
+
+    REQUIRE(pcx.indices() == std::vector<uint8_t>{1, 1, 1, 2, 0xC5, 3});
+    REQUIRE(pcx.colors().size() == 4);
+    auto const& img = pcx.image();
+    REQUIRE(img.size() == 18);
+    REQUIRE(img[0] == 20);  // index 1
+    REQUIRE(img[8] == 22);
+    REQUIRE(img[9] == 30);  // index 2
+    // index 0xC5 has no palette entry and decodes as black
+    REQUIRE(img[12] == 0);
+    REQUIRE(img[13] == 0);
+    REQUIRE(img[14] == 0);
+    REQUIRE(img[15] == 40); // index 3, last pixel
+    REQUIRE(img[17] == 42);
+}
+
+TEST_CASE("pcx run is clipped to its scan line", "[pcx]") {
+    // a run of 5 on a 2 pixel line does not spill into the next line
+    auto const data = make_pcx(2, 2, 2, {0xC5, 1, 2, 3, 0x0C});
+    PCX const pcx{data};
+    REQUIRE(pcx.indices() == std::vector<uint8_t>{1, 1, 2, 3});
+}
+
+TEST_CASE("pcx truncated data decodes what is present", "[pcx]") {
+    auto const data = make_pcx(2, 2, 2, {0xC2, 4});
+    PCX const pcx{data};
+    REQUIRE(pcx.indices() == std::vector<uint8_t>{4, 4, 0, 0});
+    REQUIRE(pcx.colors().empty());
+    REQUIRE(pcx.image() == std::vector<unsigned char>(12, 0));
+}
+
+TEST_CASE("pcx span shorter than a header throws", "[pcx]") {
+    std::vector<std::byte> const data(127);
+    auto construct = [&]() { PCX{data}; };
+    REQUIRE_THROWS_AS(construct(), gsl_lite::fail_fast);
+}
+
+TEST_CASE("pcx indexed decode keeps indices and palette only", "[pcx]") {
+    auto const data = make_pcx(2, 1, 2, {1, 0, 0x0C, 10, 11, 12, 20, 21, 22});
+    PCX const pcx{data, PCX::Pixels::indexed};
+
+    REQUIRE(pcx.width() == 2);
+    REQUIRE(pcx.height() == 1);
+    REQUIRE(pcx.indices() == std::vector<uint8_t>{1, 0});
+    REQUIRE(pcx.image().empty());
+
+    auto const palette = pcx.palette();
+    REQUIRE(palette.size() == PCX::palette_size * 3);
+    REQUIRE(palette[0] == 10);
+    REQUIRE(palette[5] == 22);
+    // entries missing from the file are black
+    REQUIRE(palette[6] == 0);
+    REQUIRE(palette.back() == 0);
+}
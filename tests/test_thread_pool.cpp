@@ -0,0 +1,88 @@
+#include "md2view/thread_pool.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE("thread pool parallel_for covers every index once", "[pool]") {
+    ThreadPool pool(3);
+    REQUIRE(pool.size() == 3);
+
+    for (size_t grain : {0U, 1U, 7U, 1000U, 5000U}) {
+        std::vector<int> hits(1000);
+        pool.parallel_for(hits.size(), grain, [&](size_t begin, size_t end) {
+            for (auto i = begin; i < end; ++i) {
+                ++hits[i];
+            }
+        });
+        REQUIRE(std::accumulate(hits.begin(), hits.end(), 0) == 1000);
+        REQUIRE(std::all_of(hits.begin(), hits.end(),
+                            [](int h) { return h == 1; }));
+    }
+}
+
+TEST_CASE("thread pool without workers runs on the caller", "[pool]") {
+    ThreadPool pool(0);
+    REQUIRE(pool.size() == 0);
+
+    size_t sum = 0;
+    pool.parallel_for(10, 1, [&](size_t begin, size_t end) {
+        for (auto i = begin; i < end; ++i) {
+            sum += i;
+        }
+    });
+    REQUIRE(sum == 45);
+
+    bool ran = false;
+    pool.submit([&] { ran = true; });
+    REQUIRE(ran);
+}
+
+TEST_CASE("thread pool parallel_for of nothing calls nothing", "[pool]") {
+    ThreadPool pool(2);
+    bool called = false;
+    pool.parallel_for(0, 0, [&](size_t, size_t) { called = true; });
+    REQUIRE_FALSE(called);
+}
+
+TEST_CASE("thread pool parallel_for rethrows after all chunks", "[pool]") {
+    ThreadPool pool(2);
+    std::atomic<size_t> done{0};
+    auto run = [&] {
+        pool.parallel_for(64, 1, [&](size_t begin, size_t) {
+            if (begin == 13) {
+                throw std::runtime_error("chunk failed");
+            }
+            ++done;
+        });
+    };
+    REQUIRE_THROWS_AS(run(), std::runtime_error);
+    REQUIRE(done == 63);
+}
+
+TEST_CASE("thread pool runs submitted tasks before shutdown", "[pool]") {
+    std::atomic<int> count{0};
+    {
+        ThreadPool pool(2);
+        for (int i = 0; i < 100; ++i) {
+            pool.submit([&] { ++count; });
+        }
+    }
+    REQUIRE(count == 100);
+}
+
+TEST_CASE("thread pool parallel_for nests inside a task", "[pool]") {
+    ThreadPool pool(2);
+    std::atomic<size_t> total{0};
+    pool.parallel_for(4, 1, [&](size_t, size_t) {
+        pool.parallel_for(8, 1, [&](size_t begin, size_t end) {
+            total += end - begin;
+        });
+    });
+    REQUIRE(total == 32);
+}
@@ -0,0 +1,138 @@
+#include "md2view/trace.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <gsl-lite/gsl-lite.hpp>
+
+#include <chrono>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <thread>
+
+// Trace state is global, so each test starts its own recording and stops it
+// before checking the output.
+static std::string traced_json() {
+    Trace::stop();
+    std::ostringstream out;
+    Trace::write_json(out);
+    return out.str();
+}
+
+static size_t count(std::string const& haystack, std::string const& needle) {
+    size_t n = 0;
+    for (auto pos = haystack.find(needle); pos != std::string::npos;
+         pos = haystack.find(needle, pos + needle.size())) {
+        ++n;
+    }
+    return n;
+}
+
+TEST_CASE("trace records nothing until started", "[trace]") {
+    Trace::start();
+    Trace::stop();
+    REQUIRE_FALSE(Trace::enabled());
+    { MD2V_TRACE_SCOPE("not recorded"); }
+    Trace::complete("not recorded either", {}, {});
+    Trace::counter("not a counter", 1.0);
+
+    auto const json = traced_json();
+    REQUIRE(json.starts_with(R"({"displayTimeUnit":"ms","traceEvents":[)"));
+    REQUIRE(json.find("not") == std::string::npos);
+}
+
+TEST_CASE("trace scopes become complete events", "[trace]") {
+    if (!Trace::compiled_in) {
+        return; // the macros expand to nothing
+    }
+    Trace::start();
+    REQUIRE(Trace::enabled());
+    {
+        MD2V_TRACE_SCOPE_DETAIL("outer", std::string{"models/\"q\"\\x"});
+        MD2V_TRACE_SCOPE("inner");
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    MD2V_TRACE_COUNTER("cache bytes", 1024);
+
+    auto const json = traced_json();
+    REQUIRE(count(json, R"("name":"outer","ph":"X")") == 1);
+    REQUIRE(count(json, R"("name":"inner","ph":"X")") == 1);
+    // the detail is escaped for JSON
+    REQUIRE(count(json, R"("args":{"detail":"models/\"q\"\\x"})") == 1);
+    REQUIRE(count(json, R"("name":"cache bytes","ph":"C")") == 1);
+    REQUIRE(count(json, R"("args":{"value":1024})") == 1);
+    REQUIRE(json.ends_with("\n]}\n"));
+}
+
+TEST_CASE("trace detail is only evaluated while tracing", "[trace]") {
+    int calls = 0;
+    [[maybe_unused]] auto const detail = [&calls] {
+        ++calls;
+        return std::string{"x"};
+    };
+    Trace::stop();
+    { MD2V_TRACE_SCOPE_DETAIL("off", detail()); }
+    REQUIRE(calls == 0);
+
+    Trace::start();
+    { MD2V_TRACE_SCOPE_DETAIL("on", detail()); }
+    Trace::stop();
+    REQUIRE(calls == (Trace::compiled_in ? 1 : 0));
+}
+
+TEST_CASE("trace keeps events of threads that have exited", "[trace]") {
+    Trace::start();
+    Trace::set_thread_name("test main");
+    std::thread worker{[] {
+        Trace::set_thread_name("test \"worker\"");
+        Trace::complete("worker task", std::chrono::steady_clock::now(),
+                        std::chrono::steady_clock::now());
+    }};
+    worker.join();
+
+    auto const json = traced_json();
+    REQUIRE(count(json, R"("name":"worker task")") == 1);
+    REQUIRE(count(json, R"("args":{"name":"test \"worker\""})") == 1);
+}
+
+TEST_CASE("trace ring keeps the newest events", "[trace]") {
+    Trace::start(4);
+    for (int i = 0; i < 10; ++i) {
+        Trace::counter("count " + std::to_string(i), i);
+    }
+
+    auto const json = traced_json();
+    REQUIRE(json.find(R"("count 5")") == std::string::npos);
+    for (int i = 6; i < 10; ++i) {
+        REQUIRE(count(json, "\"count " + std::to_string(i) + "\"") == 1);
+    }
+    // the oldest of those kept comes first
+    REQUIRE(json.find("count 6") < json.find("count 9"));
+
+    // starting again discards them and restores the default ring size
+    Trace::start();
+    REQUIRE(traced_json().find("count") == std::string::npos);
+}
+
+TEST_CASE("trace names are truncated", "[trace]") {
+    Trace::start();
+    Trace::counter(std::string(100, 'n'), 1.0);
+    auto const json = traced_json();
+    REQUIRE(count(json, std::string(Trace::max_name, 'n')) == 1);
+    REQUIRE(count(json, std::string(Trace::max_name + 1, 'n')) == 0);
+    REQUIRE_THROWS_AS(Trace::start(0), gsl_lite::fail_fast);
+}
+
+TEST_CASE("trace leaves out non-finite counter values", "[trace]") {
+    Trace::start();
+    Trace::counter("nan", std::numeric_limits<double>::quiet_NaN());
+    Trace::counter("inf", std::numeric_limits<double>::infinity());
+    Trace::counter("finite", 2.5);
+
+    std::ostringstream out;
+    Trace::stop();
+    REQUIRE(Trace::write_json(out) == 1);
+    auto const json = out.str();
+    REQUIRE(json.find("nan") == std::string::npos);
+    REQUIRE(json.find("inf") == std::string::npos);
+    REQUIRE(count(json, R"("args":{"value":2.5})") == 1);
+}
@@ -0,0 +1,160 @@
+#include "fixtures.hpp"
+#include "md2view/md2_model.hpp"
+#include "md2view/vertex_cache.hpp"
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <gsl-lite/gsl-lite.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <numeric>
+#include <random>
+#include <span>
+#include <utility>
+#include <vector>
+
+using Triangle = std::array<uint16_t, 3>;
+
+// Triangle list of an n x n vertex grid, two triangles per quad, with the
+// triangles shuffled so the order says nothing about locality.
+static std::vector<uint16_t> shuffled_grid(int n) {
+    std::vector<Triangle> tris;
+    for (int y = 0; y + 1 < n; ++y) {
+        for (int x = 0; x + 1 < n; ++x) {
+            auto const i = static_cast<uint16_t>((y * n) + x);
+            auto const right = static_cast<uint16_t>(i + 1);
+            auto const down = static_cast<uint16_t>(i + n);
+            auto const diag = static_cast<uint16_t>(i + n + 1);
+            tris.push_back({i, right, diag});
+            tris.push_back({i, diag, down});
+        }
+    }
+    std::mt19937 rng{1234};
+    std::ranges::shuffle(tris, rng);
+
+    std::vector<uint16_t> indices;
+    for (auto const& tri : tris) {
+        indices.insert(indices.end(), tri.begin(), tri.end());
+    }
+    return indices;
+}
+
+// Triangles of @p indices, each rotated to start at its smallest index so
+// the same winding compares equal, in sorted order.
+static std::vector<Triangle>
+triangle_set(std::vector<uint16_t> const& indices) {
+    std::vector<Triangle> tris;
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        Triangle tri{indices[i], indices[i + 1], indices[i + 2]};
+        std::ranges::rotate(tri, std::ranges::min_element(tri));
+        tris.push_back(tri);
+    }
+    std::ranges::sort(tris);
+    return tris;
+}
+
+TEST_CASE("vertex cache analyze counts fifo misses", "[vertex_cache]") {
+    using Catch::Approx;
+    // two triangles sharing an edge: 4 misses
+    std::vector<uint16_t> const quad{0, 1, 2, 2, 1, 3};
+    auto const stats = VertexCache::analyze(quad, 4);
+    REQUIRE(stats.acmr == Approx(2.0));
+    REQUIRE(stats.atvr == Approx(1.0));
+
+    // with a cache of 3 vertex 0 is evicted by 3 before it is used again
+    std::vector<uint16_t> const fan{0, 1, 2, 0, 2, 3, 0, 3, 1};
+    REQUIRE(VertexCache::analyze(fan, 4, 16).acmr == Approx(4.0 / 3.0));
+    REQUIRE(VertexCache::analyze(fan, 4, 3).acmr == Approx(6.0 / 3.0));
+}
+
+TEST_CASE("vertex cache optimize keeps every triangle and its winding",
+          "[vertex_cache]") {
+    auto indices = shuffled_grid(17);
+    auto const original = indices;
+    VertexCache::optimize_triangles(indices, 17 * 17);
+    REQUIRE(indices != original);
+    REQUIRE(triangle_set(indices) == triangle_set(original));
+}
+
+TEST_CASE("vertex cache optimize lowers the miss ratio", "[vertex_cache]") {
+    auto indices = shuffled_grid(33);
+    auto const vertex_count = size_t{33 * 33};
+    auto const before = VertexCache::analyze(indices, vertex_count);
+    VertexCache::optimize_triangles(indices, vertex_count);
+    auto const after = VertexCache::analyze(indices, vertex_count);
+
+    // a shuffled grid misses on nearly every corner; an optimized one comes
+    // close to one miss per vertex
+    REQUIRE(before.acmr > 2.0);
+    REQUIRE(after.acmr < 0.8);
+    REQUIRE(after.atvr < 1.5);
+}
+
+TEST_CASE("vertex cache fetch order follows first use", "[vertex_cache]") {
+    std::vector<uint16_t> indices{4, 2, 0, 0, 2, 3};
+    auto const original = indices;
+    auto const order = VertexCache::optimize_fetch(indices, 6);
+
+    REQUIRE(indices == std::vector<uint16_t>{0, 1, 2, 2, 1, 3});
+    // 1 and 5 are unused and go last, in their old order
+    REQUIRE(order == std::vector<uint16_t>{4, 2, 0, 3, 1, 5});
+    for (size_t i = 0; i < indices.size(); ++i) {
+        REQUIRE(order[indices[i]] == original[i]);
+    }
+
+    std::vector<char> names{'a', 'b', 'c', 'd', 'e', 'f'};
+    VertexCache::remap(names, order);
+    REQUIRE(names == std::vector<char>{'e', 'c', 'a', 'd', 'b', 'f'});
+}
+
+TEST_CASE("vertex cache out of range index throws", "[vertex_cache]") {
+    std::vector<uint16_t> indices{0, 1, 3};
+    REQUIRE_THROWS_AS(VertexCache::optimize_triangles(indices, 3),
+                      gsl_lite::fail_fast);
+    REQUIRE_THROWS_AS(VertexCache::analyze(std::vector<uint16_t>{0, 1}, 3),
+                      gsl_lite::fail_fast);
+}
+
+TEST_CASE("md2 indexed layout is optimized for the vertex cache",
+          "[vertex_cache][md2]") {
+    auto const bytes = read_fixture_bytes("grid.md2");
+    std::span<std::byte const> const data{bytes};
+
+    MD2Model const list{data, MD2Model::Layout::triangle_list};
+    MD2Model const indexed{data, MD2Model::Layout::indexed};
+
+    // vertices are numbered in first use order
+    auto const& indices = indexed.indices();
+    uint16_t next = 0;
+    for (auto const index : indices) {
+        REQUIRE(index <= next);
+        next = std::max(next, static_cast<uint16_t>(index + 1));
+    }
+    REQUIRE(next == indexed.vertex_count());
+
+    auto const stats = VertexCache::analyze(indices, indexed.vertex_count());
+    REQUIRE(stats.acmr < 0.8);
+
+    // and the reordered mesh still draws the triangle list's corners
+    auto const corner = [](MD2Model const& model, size_t v) {
+        return std::pair{model.key_frames()[v], model.scaled_texcoords()[v]};
+    };
+    std::vector<std::pair<glm::vec3, glm::vec2>> from_list;
+    std::vector<std::pair<glm::vec3, glm::vec2>> from_indexed;
+    for (size_t i = 0; i < indices.size(); ++i) {
+        from_list.push_back(corner(list, i));
+        from_indexed.push_back(corner(indexed, indices[i]));
+    }
+    auto const less = [](auto const& a, auto const& b) {
+        auto const key = [](auto const& c) {
+            return std::array{c.first.x, c.first.y, c.first.z, c.second.x,
+                              c.second.y};
+        };
+        return key(a) < key(b);
+    };
+    std::ranges::sort(from_list, less);
+    std::ranges::sort(from_indexed, less);
+    REQUIRE(from_list == from_indexed);
+}
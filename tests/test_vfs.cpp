@@ -0,0 +1,177 @@
+#include "fixtures.hpp"
+#include "md2view/md2_model.hpp"
+#include "md2view/vfs.hpp"
+#include "tmpdir.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <gsl-lite/gsl-lite.hpp>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using Files = std::vector<std::pair<std::string, std::string>>;
+
+static void write_files(std::filesystem::path const& root, Files const& files) {
+    for (auto const& [path, content] : files) {
+        auto const full = root / path;
+        std::filesystem::create_directories(full.parent_path());
+        std::ofstream f(full, std::ios::binary);
+        f << content;
+    }
+}
+
+// Write a .pak archive holding @p files.
+static void write_pak(std::filesystem::path const& path, Files const& files) {
+    auto const write_i32 = [](std::ofstream& f, int32_t value) {
+        f.write(reinterpret_cast<char const*>(&value), sizeof(value));
+    };
+
+    int32_t data_size = 0;
+    for (auto const& file : files) {
+        data_size += static_cast<int32_t>(file.second.size());
+    }
+    std::ofstream f(path, std::ios::binary);
+    f.write("PACK", 4);
+    write_i32(f, 12 + data_size);
+    write_i32(f, static_cast<int32_t>(files.size() * 64));
+    for (auto const& file : files) {
+        f << file.second;
+    }
+    int32_t offset = 12;
+    for (auto const& [name, content] : files) {
+        std::array<char, 56> entry{};
+        std::strncpy(entry.data(), name.c_str(), entry.size() - 1);
+        f.write(entry.data(), entry.size());
+        write_i32(f, offset);
+        write_i32(f, static_cast<int32_t>(content.size()));
+        offset += static_cast<int32_t>(content.size());
+    }
+}
+
+static std::string read(VFS const& vfs, std::string const& path) {
+    auto const bytes = vfs.view(path);
+    return {reinterpret_cast<char const*>(bytes.data()), bytes.size()};
+}
+
+TEST_CASE("vfs later mount shadows earlier", "[vfs]") {
+    TmpDir tmp;
+    write_files(tmp.path() / "base", {{"pics/a.pcx", "base a"},
+                                      {"pics/b.pcx", "base b"}});
+    write_files(tmp.path() / "mod", {{"pics/b.pcx", "mod b"}});
+
+    VFS vfs;
+    vfs.mount(tmp.path() / "base");
+    vfs.mount(tmp.path() / "mod");
+
+    REQUIRE(vfs.mounts().size() == 2);
+    REQUIRE(vfs.size() == 2);
+    REQUIRE(read(vfs, "pics/a.pcx") == "base a");
+    REQUIRE(read(vfs, "pics/b.pcx") == "mod b");
+    REQUIRE(vfs.resolve("pics/b.pcx")->pak == vfs.mounts().back().get());
+    REQUIRE(vfs.find("pics/b.pcx")->filelen == 5);
+}
+
+TEST_CASE("vfs game dir mounts numbered paks over loose files", "[vfs]") {
+    TmpDir tmp;
+    auto const game = tmp.path() / "baseq2";
+    write_files(game, {{"models/a/tris.md2", "loose"},
+                       {"models/b/tris.md2", "loose"},
+                       {"models/c/tris.md2", "loose"}});
+    write_pak(game / "pak0.pak", {{"models/a/tris.md2", "pak0"},
+                                  {"models/b/tris.md2", "pak0"}});
+    write_pak(game / "pak1.pak", {{"models/b/tris.md2", "pak1"}});
+    // not contiguous with pak1, so never mounted
+    write_pak(game / "pak3.pak", {{"models/c/tris.md2", "pak3"}});
+
+    VFS vfs;
+    vfs.mount_game_dir(game);
+
+    REQUIRE(vfs.mounts().size() == 3);
+    REQUIRE(read(vfs, "models/a/tris.md2") == "pak0");
+    REQUIRE(read(vfs, "models/b/tris.md2") == "pak1");
+    REQUIRE(read(vfs, "models/c/tris.md2") == "loose");
+}
+
+TEST_CASE("vfs search path constructor mounts game dirs and paks", "[vfs]") {
+    TmpDir tmp;
+    write_files(tmp.path() / "baseq2", {{"models/a/tris.md2", "base"}});
+    write_pak(tmp.path() / "baseq2" / "pak0.pak",
+              {{"models/b/tris.md2", "base pak"}});
+    write_pak(tmp.path() / "mod.pak", {{"models/a/tris.md2", "mod"}});
+
+    VFS const vfs{{tmp.path() / "baseq2", tmp.path() / "mod.pak"}};
+
+    REQUIRE(vfs.mounts().size() == 3);
+    REQUIRE(read(vfs, "models/a/tris.md2") == "mod");
+    REQUIRE(read(vfs, "models/b/tris.md2") == "base pak");
+}
+
+TEST_CASE("vfs models and directories are merged and sorted", "[vfs]") {
+    TmpDir tmp;
+    write_files(tmp.path() / "base", {{"models/b/tris.md2", "1"},
+                                      {"models/b/skin.pcx", "1"},
+                                      {"models/b/w/tris.md2", "1"}});
+    write_pak(tmp.path() / "mod.pak", {{"models/b/tris.md2", "2"},
+                                       {"models/b/alt.pcx", "2"},
+                                       {"models/a/tris.md2", "2"}});
+    VFS vfs;
+    vfs.mount(tmp.path() / "base");
+    vfs.mount(tmp.path() / "mod.pak");
+
+    std::vector<std::string> models;
+    for (auto const& node : vfs.models()) {
+        models.emplace_back(node.path);
+    }
+    REQUIRE(models == std::vector<std::string>{"models/a/tris.md2",
+                                               "models/b/tris.md2",
+                                               "models/b/w/tris.md2"});
+    REQUIRE(vfs.has_models());
+
+    std::vector<std::string> dir;
+    for (auto const& node : vfs.directory("models/b")) {
+        dir.emplace_back(node.path);
+    }
+    REQUIRE(dir == std::vector<std::string>{"models/b/alt.pcx",
+                                            "models/b/skin.pcx",
+                                            "models/b/tris.md2"});
+}
+
+TEST_CASE("vfs missing entry", "[vfs]") {
+    TmpDir tmp;
+    VFS vfs;
+    vfs.mount(tmp.path());
+
+    REQUIRE_FALSE(vfs.has_models());
+    REQUIRE(vfs.resolve("missing.pcx") == nullptr);
+    REQUIRE_FALSE(vfs.contains("missing.pcx"));
+    REQUIRE_FALSE(vfs.open_ifstream("missing.pcx").is_open());
+    REQUIRE_THROWS_AS(vfs.view("missing.pcx"), gsl_lite::fail_fast);
+
+    // files added to a directory mount later are still found
+    write_files(tmp.path(), {{"late.pcx", "late"}});
+    REQUIRE(vfs.contains("late.pcx"));
+    REQUIRE(read(vfs, "late.pcx") == "late");
+}
+
+TEST_CASE("vfs loads md2 from the mount it resolves to", "[vfs][md2]") {
+    TmpDir tmp;
+    write_pak(tmp.path() / "pak0.pak", {{"models/player/tris.md2", "junk"}});
+    auto const model_dir = tmp.path() / "mod" / "models" / "player";
+    std::filesystem::create_directories(model_dir);
+    std::filesystem::copy_file(test_fixtures_dir() / "two_anim.md2",
+                               model_dir / "tris.md2");
+
+    VFS vfs;
+    vfs.mount(tmp.path() / "pak0.pak");
+    vfs.mount(tmp.path() / "mod");
+
+    MD2Model const model{"models/player/tris.md2", vfs};
+    REQUIRE(model.animations().size() == 2);
+}